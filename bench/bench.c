@@ -0,0 +1,476 @@
+#include "../lookup_table/hamming.h"
+#include "block_io.h"
+#include "mm_hamming.h"
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+
+#define BENCH_HAS_TSC // Whether cycles can be counted with rdtsc.
+#endif
+
+#define OPTIONS "hs:e:t:" // Valid options for the program.
+#define MAX_RUNS 16 // Maximum number of sizes or error rates that can be given.
+
+// Description:
+// An encoder and decoder to benchmark.
+//
+// Members:
+// const char *implementation - The folder the codec comes from.
+// const char *name - The name of the kernel within the implementation.
+// HAM_BACKEND backend - The lookup table backend to select first. The kernel is skipped if the CPU doesn't support it.
+// void ( *encode )( const uint8_t *in, uint8_t *out, size_t n ) - Encodes n bytes into at most 2 * n code bytes. NULL for
+// kernels that only decode, whose codes are made by the block encoder and not timed.
+// void ( *decode )( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) - Decodes the codes of n bytes.
+typedef struct BenchKernel {
+	const char *implementation;
+	const char *name;
+	HAM_BACKEND backend;
+	void ( *encode )( const uint8_t *in, uint8_t *out, size_t n );
+	void ( *decode )( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+} BenchKernel;
+
+static HammingCode *mm_code = NULL; // The matrix multiplication Hamming(8, 4) code and its tables.
+static volatile uint64_t sink = 0; // Keeps results alive so the compiler can't drop the work.
+
+// Description:
+// Prints the help message to stderr.
+//
+// Parameters:
+// char *program_path - The path to the program.
+//
+// Returns:
+// Nothing.
+static void print_help( char *program_path ) {
+	fprintf( stderr,
+	    "SYNOPSIS\n   Benchmarks the Hamming(8, 4) and Hamming(72, 64) encoders and decoders, printing CSV to stdout.\n\nUSAGE\n   %s [-h] [-s size]... [-e rate]... [-t seconds]\n\nOPTIONS\n   "
+	    "-h             Program usage and help.\n   -s size        Plaintext size in bytes, optionally suffixed with K, M, or G. May be repeated (default 16K, 256K, 8M).\n   -e rate        Fraction "
+	    "of codes with a flipped bit when decoding. May be repeated (default 0).\n   -t seconds     Minimum time to spend on each measurement (default 0.25).\n",
+	    program_path );
+}
+
+// Description:
+// Decodes code pairs one at a time the way the original streaming decoder did.
+//
+// Parameters:
+// HAM_STATUS ( *decode )( uint8_t code, uint8_t *msg ) - Decodes one code.
+// Others - Same as BenchKernel's decode.
+//
+// Returns:
+// Nothing.
+static inline void decode_pairs( HAM_STATUS ( *decode )( uint8_t code, uint8_t *msg ), const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	for ( size_t i = 0; i < n; i++ ) {
+		uint8_t lower_nibble = 0;
+		uint8_t upper_nibble = 0;
+		HAM_STATUS lower_nibble_status = decode( in[ 2 * i ], &lower_nibble );
+		HAM_STATUS upper_nibble_status = decode( in[ 2 * i + 1 ], &upper_nibble );
+		*uncorrectable_errors += ( lower_nibble_status == HAM_ERR ) + ( upper_nibble_status == HAM_ERR );
+		*corrected_errors += ( lower_nibble_status == HAM_CORRECT ) + ( upper_nibble_status == HAM_CORRECT );
+		out[ i ] = lower_nibble_status == HAM_ERR || upper_nibble_status == HAM_ERR ? 0 : ( upper_nibble << 4 ) | lower_nibble;
+	}
+}
+
+// Description:
+// Encodes bytes one at a time with the lookup table codec.
+//
+// Parameters:
+// Same as BenchKernel's encode.
+//
+// Returns:
+// Nothing.
+static void lt_bytewise_encode( const uint8_t *in, uint8_t *out, size_t n ) {
+	for ( size_t i = 0; i < n; i++ ) {
+		out[ 2 * i ] = ham_encode( in[ i ] & 0xF );
+		out[ 2 * i + 1 ] = ham_encode( in[ i ] >> 4 );
+	}
+}
+
+// Description:
+// Decodes code pairs one at a time with the lookup table codec.
+//
+// Parameters:
+// Same as BenchKernel's decode.
+//
+// Returns:
+// Nothing.
+static void lt_bytewise_decode( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	decode_pairs( ham_decode, in, out, n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Encodes a whole block with the lookup table codec's selected backend.
+//
+// Parameters:
+// Same as BenchKernel's encode.
+//
+// Returns:
+// Nothing.
+static void lt_block_encode( const uint8_t *in, uint8_t *out, size_t n ) {
+	ham_encode_block( in, out, n );
+}
+
+// Description:
+// Decodes a whole block with the lookup table codec's selected backend.
+//
+// Parameters:
+// Same as BenchKernel's decode.
+//
+// Returns:
+// Nothing.
+static void lt_block_decode( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	ham_decode_block( in, out, n, NULL, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Checks a whole block with the lookup table codec's selected backend without decoding it.
+//
+// Parameters:
+// Same as BenchKernel's decode. Nothing is written to out.
+//
+// Returns:
+// Nothing.
+static void lt_block_verify( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	( void ) out;
+	ham_verify_block( in, 2 * n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Encodes whole 8-byte words into Hamming(72, 64) codes with the lookup table codec's selected backend.
+//
+// Parameters:
+// Same as BenchKernel's encode.
+//
+// Returns:
+// Nothing.
+static void lt_72_64_encode( const uint8_t *in, uint8_t *out, size_t n ) {
+	ham_encode_72_64_block( in, out, n / HAM_72_64_DATA_SIZE );
+}
+
+// Description:
+// Decodes Hamming(72, 64) codes into whole 8-byte words with the lookup table codec's selected backend.
+//
+// Parameters:
+// Same as BenchKernel's decode.
+//
+// Returns:
+// Nothing.
+static void lt_72_64_decode( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	ham_decode_72_64_block( in, out, n / HAM_72_64_DATA_SIZE, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Encodes bytes one at a time with the matrix multiplication codec's tables.
+//
+// Parameters:
+// Same as BenchKernel's encode.
+//
+// Returns:
+// Nothing.
+static void mm_encode( const uint8_t *in, uint8_t *out, size_t n ) {
+	for ( size_t i = 0; i < n; i++ ) {
+		out[ 2 * i ] = ham_code_lookup_encode( mm_code, in[ i ] & 0xF );
+		out[ 2 * i + 1 ] = ham_code_lookup_encode( mm_code, in[ i ] >> 4 );
+	}
+}
+
+// Description:
+// Decodes one code with the matrix multiplication codec's tables.
+//
+// Parameters:
+// uint8_t code - The code.
+// uint8_t *msg - Where to put the decoded message.
+//
+// Returns:
+// HAM_STATUS - Whether the code could be decoded.
+static HAM_STATUS mm_decode_code( uint8_t code, uint8_t *msg ) {
+	return ham_code_lookup_decode( mm_code, code, msg );
+}
+
+// Description:
+// Decodes code pairs one at a time with the matrix multiplication codec.
+//
+// Parameters:
+// Same as BenchKernel's decode.
+//
+// Returns:
+// Nothing.
+static void mm_decode( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	decode_pairs( mm_decode_code, in, out, n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Encodes whole blocks with the matrix multiplication codec.
+//
+// Parameters:
+// Same as BenchKernel's encode.
+//
+// Returns:
+// Nothing.
+static void mm_block_encode( const uint8_t *in, uint8_t *out, size_t n ) {
+	ham_code_encode_bytes( mm_code, in, out, n );
+}
+
+// Description:
+// Decodes whole blocks with the matrix multiplication codec.
+//
+// Parameters:
+// Same as BenchKernel's decode.
+//
+// Returns:
+// Nothing.
+static void mm_block_decode( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	ham_code_decode_bytes( mm_code, in, out, n, corrected_errors, uncorrectable_errors );
+}
+
+// Every kernel that gets benchmarked. New kernels only need an entry here.
+static const BenchKernel kernels[] = {
+	{ "lookup_table", "bytewise", HAM_BACKEND_AUTO, lt_bytewise_encode, lt_bytewise_decode },
+	{ "lookup_table", "block_scalar", HAM_BACKEND_SCALAR, lt_block_encode, lt_block_decode },
+	{ "lookup_table", "block_bitslice", HAM_BACKEND_BITSLICE, lt_block_encode, lt_block_decode },
+	{ "lookup_table", "block_pair", HAM_BACKEND_PAIR, lt_block_encode, lt_block_decode },
+	{ "lookup_table", "block_ssse3", HAM_BACKEND_SSSE3, lt_block_encode, lt_block_decode },
+	{ "lookup_table", "block_avx2", HAM_BACKEND_AVX2, lt_block_encode, lt_block_decode },
+	{ "lookup_table", "block_avx512", HAM_BACKEND_AVX512, lt_block_encode, lt_block_decode },
+	{ "lookup_table", "verify_scalar", HAM_BACKEND_SCALAR, NULL, lt_block_verify },
+	{ "lookup_table", "verify_ssse3", HAM_BACKEND_SSSE3, NULL, lt_block_verify },
+	{ "lookup_table", "verify_avx2", HAM_BACKEND_AVX2, NULL, lt_block_verify },
+	{ "lookup_table", "verify_avx512", HAM_BACKEND_AVX512, NULL, lt_block_verify },
+	{ "lookup_table", "block_72_64_scalar", HAM_BACKEND_SCALAR, lt_72_64_encode, lt_72_64_decode },
+	{ "lookup_table", "block_72_64_popcnt", HAM_BACKEND_SSSE3, lt_72_64_encode, lt_72_64_decode },
+	{ "lookup_table", "block_72_64_avx512", HAM_BACKEND_AVX512, lt_72_64_encode, lt_72_64_decode },
+	{ "matrix_multiplication", "bytewise", HAM_BACKEND_AUTO, mm_encode, mm_decode },
+	{ "matrix_multiplication", "block", HAM_BACKEND_AUTO, mm_block_encode, mm_block_decode },
+};
+
+// Description:
+// Generates pseudorandom numbers with xorshift64, so every run benchmarks the same data.
+//
+// Parameters:
+// uint64_t *state - The generator state. Must be nonzero.
+//
+// Returns:
+// uint64_t - The next number.
+static uint64_t next_random( uint64_t *state ) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+// Description:
+// Gets the current time in seconds.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// double - The time from a monotonic clock.
+static double now( ) {
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Description:
+// Reads the CPU's timestamp counter.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// uint64_t - The timestamp, or 0 if there's no counter.
+static uint64_t cycles( ) {
+#ifdef BENCH_HAS_TSC
+	return __rdtsc( );
+#else
+	return 0;
+#endif
+}
+
+// Description:
+// Prints one CSV row of results.
+//
+// Parameters:
+// const BenchKernel *kernel - The kernel measured.
+// const char *operation - "encode" or "decode".
+// size_t size - The plaintext size in bytes.
+// double error_rate - The fraction of codes with a flipped bit.
+// uint64_t runs - The number of times the kernel ran.
+// double seconds - The total time of all runs.
+// uint64_t elapsed_cycles - The total timestamp counter ticks of all runs.
+//
+// Returns:
+// Nothing.
+static void report( const BenchKernel *kernel, const char *operation, size_t size, double error_rate, uint64_t runs, double seconds, uint64_t elapsed_cycles ) {
+	double bytes = ( double ) size * runs;
+	printf( "%s,%s,%s,%zu,%g,%" PRIu64 ",%.2f,%.4f,%.4f\n", kernel->implementation, kernel->name, operation, size, error_rate, runs, bytes / seconds / 1e6, seconds * 1e9 / bytes,
+	    elapsed_cycles / bytes );
+}
+
+// Description:
+// Runs a function over and over for at least a minimum time, then reports how fast it was.
+//
+// Parameters:
+// const BenchKernel *kernel - The kernel measured.
+// bool encode - Whether to measure the encoder instead of the decoder.
+// const uint8_t *in - The input of each run.
+// uint8_t *out - The output of each run.
+// size_t size - The plaintext size in bytes.
+// double error_rate - The fraction of codes with a flipped bit.
+// double min_seconds - The minimum time to spend.
+//
+// Returns:
+// Nothing.
+static void measure( const BenchKernel *kernel, bool encode, const uint8_t *in, uint8_t *out, size_t size, double error_rate, double min_seconds ) {
+	uint64_t corrected_errors = 0;
+	uint64_t uncorrectable_errors = 0;
+	uint64_t runs = 0;
+	double start = now( );
+	uint64_t start_cycles = cycles( );
+
+	do {
+		if ( encode ) {
+			kernel->encode( in, out, size );
+		} else {
+			kernel->decode( in, out, size, &corrected_errors, &uncorrectable_errors );
+		}
+
+		sink += out[ runs % size ];
+		runs++;
+	} while ( now( ) - start < min_seconds );
+
+	report( kernel, encode ? "encode" : "decode", size, error_rate, runs, now( ) - start, cycles( ) - start_cycles );
+	sink += corrected_errors + uncorrectable_errors;
+}
+
+// Description:
+// Flips one random bit in a fraction of the codes.
+//
+// Parameters:
+// uint8_t *codes - The codes.
+// size_t length - The number of codes.
+// double error_rate - The fraction of codes to flip a bit in.
+//
+// Returns:
+// Nothing.
+static void inject_errors( uint8_t *codes, size_t length, double error_rate ) {
+	uint64_t state = 0x9E3779B97F4A7C15;
+	uint64_t threshold = error_rate >= 1 ? UINT64_MAX : ( uint64_t ) ( error_rate * ( double ) UINT64_MAX );
+
+	for ( size_t i = 0; error_rate > 0 && i < length; i++ ) {
+		if ( next_random( &state ) <= threshold ) {
+			codes[ i ] ^= 1 << ( next_random( &state ) & 7 );
+		}
+	}
+}
+
+// Description:
+// The entry point of the program.
+//
+// Parameters:
+// int argc - The argument count.
+// char **argv - An array of argument strings.
+//
+// Returns:
+// int - The exit status of the program (0 = success, otherwise error).
+int main( int argc, char **argv ) {
+	int opt = 0;
+	size_t sizes[ MAX_RUNS ] = { 16 << 10, 256 << 10, 8 << 20 };
+	uint32_t size_count = 0;
+	double error_rates[ MAX_RUNS ] = { 0 };
+	uint32_t error_rate_count = 0;
+	double min_seconds = 0.25;
+
+	while ( ( opt = getopt( argc, argv, OPTIONS ) ) != -1 ) { // Process each option specified.
+		switch ( opt ) {
+		case 'h': print_help( *argv ); return 0; // Help.
+		case 's': // Size.
+			if ( size_count == MAX_RUNS || !block_io_parse_size( optarg, &sizes[ size_count++ ] ) ) {
+				fprintf( stderr, "Error: invalid or too many sizes.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'e': // Error rate.
+			if ( error_rate_count == MAX_RUNS || ( error_rates[ error_rate_count++ ] = strtod( optarg, NULL ) ) < 0 ) {
+				fprintf( stderr, "Error: invalid or too many error rates.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 't': min_seconds = strtod( optarg, NULL ); break; // Minimum time.
+		default: print_help( *argv ); return 1; // Invalid flag.
+		}
+	}
+
+	size_count = size_count ? size_count : 3;
+	error_rate_count = error_rate_count ? error_rate_count : 1;
+	size_t max_size = 0;
+
+	for ( uint32_t i = 0; i < size_count; i++ ) {
+		max_size = sizes[ i ] > max_size ? sizes[ i ] : max_size;
+	}
+
+	uint8_t *plain = malloc( max_size );
+	uint8_t *codes = malloc( 2 * max_size );
+	uint8_t *decoded = malloc( max_size );
+
+	mm_code = ham_code_create( 8, 4 );
+
+	if ( !plain || !codes || !decoded || !mm_code ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+
+		return 1;
+	}
+
+	uint64_t state = 0x2545F4914F6CDD1D;
+
+	for ( size_t i = 0; i < max_size; i++ ) {
+		plain[ i ] = next_random( &state );
+	}
+
+	printf( "implementation,kernel,operation,size_bytes,error_rate,runs,mb_per_s,ns_per_byte,cycles_per_byte\n" );
+
+	for ( size_t k = 0; k < sizeof( kernels ) / sizeof( *kernels ); k++ ) {
+		if ( !ham_set_backend( kernels[ k ].backend ) ) {
+			continue;
+		}
+
+		// Kernels without an encoder still need codes to decode, so make them untimed with the block encoder.
+		void ( *encode )( const uint8_t *in, uint8_t *out, size_t n ) = kernels[ k ].encode ? kernels[ k ].encode : lt_block_encode;
+
+		for ( uint32_t s = 0; s < size_count; s++ ) {
+			if ( kernels[ k ].encode ) {
+				measure( &kernels[ k ], true, plain, codes, sizes[ s ], 0, min_seconds );
+			}
+
+			for ( uint32_t e = 0; e < error_rate_count; e++ ) {
+				encode( plain, codes, sizes[ s ] );
+				inject_errors( codes, 2 * sizes[ s ], error_rates[ e ] );
+				measure( &kernels[ k ], false, codes, decoded, sizes[ s ], error_rates[ e ], min_seconds );
+			}
+		}
+
+		fflush( stdout );
+	}
+
+	ham_code_delete( &mm_code );
+	free( decoded );
+	free( codes );
+	free( plain );
+
+	return 0;
+}
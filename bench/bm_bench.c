@@ -0,0 +1,374 @@
+#include "../matrix_multiplication/bm.h"
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define OPTIONS "hs:t:" // Valid options for the program.
+#define MAX_RUNS 16 // Maximum number of sizes that can be given.
+
+// Description:
+// A version of a matrix operation to benchmark.
+//
+// Members:
+// const char *name - The name of the version.
+// BitMatrix *( *operation )( BitMatrix *a, BitMatrix *b ) - Runs the operation on a and b, and may ignore b.
+typedef struct MatrixKernel {
+	const char *name;
+	BitMatrix *( *operation )( BitMatrix *a, BitMatrix *b );
+} MatrixKernel;
+
+static volatile uint64_t sink = 0; // Keeps results alive so the compiler can't drop the work.
+
+// Description:
+// Prints the help message to stderr.
+//
+// Parameters:
+// char *program_path - The path to the program.
+//
+// Returns:
+// Nothing.
+static void print_help( char *program_path ) {
+	fprintf( stderr,
+	    "SYNOPSIS\n   Benchmarks the bit matrix multiplies and transpose against bit-at-a-time reference versions, printing CSV to stdout.\n\nUSAGE\n   %s [-h] [-s rowsxcols]... [-t "
+	    "seconds]\n\nOPTIONS\n   -h             Program usage and help.\n   -s rowsxcols   Matrix size, such as 72x64. A rows x cols matrix is multiplied by a cols x rows matrix. May be repeated "
+	    "(default 8x4, 72x64, 256x256, 1024x1024).\n   -t seconds     Minimum time to spend on each measurement (default 0.25).\n",
+	    program_path );
+}
+
+// Description:
+// Parses a matrix size such as 72x64.
+//
+// Parameters:
+// const char *str - The string to parse.
+// uint32_t *rows - Where to put the number of rows.
+// uint32_t *cols - Where to put the number of columns.
+//
+// Returns:
+// bool - Whether the string was a valid size.
+static bool parse_matrix_size( const char *str, uint32_t *rows, uint32_t *cols ) {
+	char *end = NULL;
+	unsigned long r = strtoul( str, &end, 10 );
+
+	if ( end == str || *end != 'x' ) {
+		return false;
+	}
+
+	const char *col_str = end + 1;
+	unsigned long c = strtoul( col_str, &end, 10 );
+
+	if ( end == col_str || *end != '\0' || r == 0 || c == 0 || r > 4096 || c > 4096 ) {
+		return false;
+	}
+
+	*rows = r;
+	*cols = c;
+
+	return true;
+}
+
+// Description:
+// Gets the current time.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// double - The time in seconds from an arbitrary start.
+static double now( ) {
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Description:
+// Generates pseudorandom numbers with xorshift64, so every run benchmarks the same matrices.
+//
+// Parameters:
+// uint64_t *state - The generator state. Must be nonzero.
+//
+// Returns:
+// uint64_t - The next number.
+static uint64_t next_random( uint64_t *state ) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+// Description:
+// Creates a bit matrix with each bit set with a probability of one half.
+//
+// Parameters:
+// uint32_t rows - The number of rows.
+// uint32_t cols - The number of columns.
+// uint64_t *state - The generator state.
+//
+// Returns:
+// BitMatrix * - The created bit matrix, or NULL if it couldn't be allocated.
+static BitMatrix *random_matrix( uint32_t rows, uint32_t cols, uint64_t *state ) {
+	BitMatrix *m = bm_create( rows, cols );
+
+	for ( uint32_t row = 0; m && row < rows; row++ ) {
+		for ( uint32_t col = 0; col < cols; col++ ) {
+			if ( next_random( state ) & 1 ) {
+				bm_set_bit( m, row, col );
+			}
+		}
+	}
+
+	return m;
+}
+
+// Description:
+// Multiplies two bit matrices one bit at a time, the way bm_multiply used to.
+//
+// Parameters:
+// BitMatrix *a - A pointer to the first bit matrix.
+// BitMatrix *b - A pointer to the second bit matrix.
+//
+// Returns:
+// BitMatrix * - The result of the matrices being multiplied.
+static BitMatrix *reference_multiply( BitMatrix *a, BitMatrix *b ) {
+	BitMatrix *m = bm_create( bm_rows( a ), bm_cols( b ) );
+
+	for ( uint32_t row = 0; m && row < bm_rows( m ); row++ ) {
+		for ( uint32_t col = 0; col < bm_cols( m ); col++ ) {
+			uint8_t result = 0;
+
+			for ( uint32_t a_col = 0; a_col < bm_cols( a ); a_col++ ) {
+				result ^= ( bm_get_bit( a, row, a_col ) & bm_get_bit( b, a_col, col ) );
+			}
+
+			if ( result ) {
+				bm_set_bit( m, row, col );
+			}
+		}
+	}
+
+	return m;
+}
+
+// Description:
+// Transposes a bit matrix one bit at a time.
+//
+// Parameters:
+// BitMatrix *m - A pointer to a bit matrix.
+//
+// Returns:
+// BitMatrix * - The transpose of the bit matrix.
+static BitMatrix *reference_transpose( BitMatrix *m ) {
+	BitMatrix *t = bm_create( bm_cols( m ), bm_rows( m ) );
+
+	for ( uint32_t row = 0; t && row < bm_rows( m ); row++ ) {
+		for ( uint32_t col = 0; col < bm_cols( m ); col++ ) {
+			if ( bm_get_bit( m, row, col ) ) {
+				bm_set_bit( t, col, row );
+			}
+		}
+	}
+
+	return t;
+}
+
+// Description:
+// Checks whether two bit matrices are equal.
+//
+// Parameters:
+// BitMatrix *a - A pointer to the first bit matrix.
+// BitMatrix *b - A pointer to the second bit matrix.
+//
+// Returns:
+// bool - Whether the matrices have the same size and bits.
+static bool matrices_equal( BitMatrix *a, BitMatrix *b ) {
+	if ( bm_rows( a ) != bm_rows( b ) || bm_cols( a ) != bm_cols( b ) ) {
+		return false;
+	}
+
+	for ( uint32_t row = 0; row < bm_rows( a ); row++ ) {
+		for ( uint32_t col = 0; col < bm_cols( a ); col++ ) {
+			if ( bm_get_bit( a, row, col ) != bm_get_bit( b, row, col ) ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// Description:
+// Runs a matrix operation over and over for at least a minimum time.
+//
+// Parameters:
+// BitMatrix *( *operation )( BitMatrix *a, BitMatrix *b ) - The operation. Gets both matrices, and may ignore b.
+// BitMatrix *a - The first operand.
+// BitMatrix *b - The second operand.
+// double min_seconds - The minimum time to spend.
+// uint64_t *runs - Where to put the number of times the operation ran.
+//
+// Returns:
+// double - The average time of a run in nanoseconds, or a negative number if a result couldn't be allocated.
+static double measure( BitMatrix *( *operation )( BitMatrix *a, BitMatrix *b ), BitMatrix *a, BitMatrix *b, double min_seconds, uint64_t *runs ) {
+	double start = now( );
+	*runs = 0;
+
+	do {
+		BitMatrix *result = operation( a, b );
+
+		if ( !result ) {
+			return -1;
+		}
+
+		sink += bm_get_bit( result, 0, 0 );
+		bm_delete( &result );
+		( *runs )++;
+	} while ( now( ) - start < min_seconds );
+
+	return ( now( ) - start ) * 1e9 / *runs;
+}
+
+// Description:
+// Transposes the first operand with bm_transpose.
+//
+// Parameters:
+// BitMatrix *a - The matrix to transpose.
+// BitMatrix *b - Ignored.
+//
+// Returns:
+// BitMatrix * - The transpose.
+static BitMatrix *word_transpose( BitMatrix *a, BitMatrix *b ) {
+	( void ) b;
+
+	return bm_transpose( a );
+}
+
+// Description:
+// Transposes the first operand with reference_transpose.
+//
+// Parameters:
+// BitMatrix *a - The matrix to transpose.
+// BitMatrix *b - Ignored.
+//
+// Returns:
+// BitMatrix * - The transpose.
+static BitMatrix *bit_transpose( BitMatrix *a, BitMatrix *b ) {
+	( void ) b;
+
+	return reference_transpose( a );
+}
+
+// Description:
+// Checks the versions of an operation against the first one, then measures each and prints a CSV row for each.
+//
+// Parameters:
+// const char *name - The name of the operation.
+// const MatrixKernel *kernels - The versions. The first one is the bit-at-a-time reference.
+// uint32_t kernel_count - The number of versions.
+// BitMatrix *a - The first operand.
+// BitMatrix *b - The second operand.
+// double min_seconds - The minimum time to spend on each measurement.
+//
+// Returns:
+// bool - Whether the versions agreed and all results could be allocated.
+static bool compare( const char *name, const MatrixKernel *kernels, uint32_t kernel_count, BitMatrix *a, BitMatrix *b, double min_seconds ) {
+	BitMatrix *expected = kernels[ 0 ].operation( a, b );
+
+	for ( uint32_t k = 1; k < kernel_count; k++ ) {
+		BitMatrix *actual = kernels[ k ].operation( a, b );
+		bool equal = expected && actual && matrices_equal( expected, actual );
+		bm_delete( &actual );
+
+		if ( !equal ) {
+			fprintf( stderr, "Error: %s %s of a %" PRIu32 "x%" PRIu32 " matrix doesn't match the reference.\n", kernels[ k ].name, name, bm_rows( a ), bm_cols( a ) );
+			bm_delete( &expected );
+
+			return false;
+		}
+	}
+
+	bm_delete( &expected );
+	double reference_ns = 0;
+
+	for ( uint32_t k = 0; k < kernel_count; k++ ) {
+		uint64_t runs = 0;
+		double ns = measure( kernels[ k ].operation, a, b, min_seconds, &runs );
+
+		if ( ns < 0 ) {
+			fprintf( stderr, "Error: failed to allocate memory.\n" );
+
+			return false;
+		}
+
+		reference_ns = k == 0 ? ns : reference_ns;
+		printf( "%s,%" PRIu32 ",%" PRIu32 ",%s,%" PRIu64 ",%.1f,%.2f\n", name, bm_rows( a ), bm_cols( a ), kernels[ k ].name, runs, ns, reference_ns / ns );
+		fflush( stdout );
+	}
+
+	return true;
+}
+
+// Description:
+// The entry point of the program.
+//
+// Parameters:
+// int argc - The argument count.
+// char **argv - An array of argument strings.
+//
+// Returns:
+// int - The exit status of the program (0 = success, otherwise error).
+int main( int argc, char **argv ) {
+	int opt = 0;
+	uint32_t rows[ MAX_RUNS ] = { 8, 72, 256, 1024 };
+	uint32_t cols[ MAX_RUNS ] = { 4, 64, 256, 1024 };
+	uint32_t size_count = 0;
+	double min_seconds = 0.25;
+
+	while ( ( opt = getopt( argc, argv, OPTIONS ) ) != -1 ) { // Process each option specified.
+		switch ( opt ) {
+		case 'h': print_help( *argv ); return 0; // Help.
+		case 's': // Size.
+			if ( size_count == MAX_RUNS || !parse_matrix_size( optarg, &rows[ size_count ], &cols[ size_count ] ) ) {
+				fprintf( stderr, "Error: invalid or too many sizes.\n" );
+
+				return 1;
+			}
+
+			size_count++;
+
+			break;
+		case 't': min_seconds = strtod( optarg, NULL ); break; // Minimum time.
+		default: print_help( *argv ); return 1; // Invalid flag.
+		}
+	}
+
+	static const MatrixKernel multiply_kernels[] = { { "bit", reference_multiply }, { "word", bm_multiply }, { "m4rm", bm_multiply_m4rm } };
+	static const MatrixKernel transpose_kernels[] = { { "bit", bit_transpose }, { "word", word_transpose } };
+	size_count = size_count ? size_count : 4;
+	uint64_t state = 0x2545F4914F6CDD1D;
+	int status = 0;
+	printf( "operation,rows,cols,kernel,runs,ns_per_op,speedup\n" );
+
+	for ( uint32_t s = 0; s < size_count && status == 0; s++ ) {
+		BitMatrix *a = random_matrix( rows[ s ], cols[ s ], &state );
+		BitMatrix *b = random_matrix( cols[ s ], rows[ s ], &state );
+
+		if ( !a || !b ) {
+			fprintf( stderr, "Error: failed to allocate memory.\n" );
+			status = 1;
+		} else if ( !compare( "multiply", multiply_kernels, 3, a, b, min_seconds ) || !compare( "transpose", transpose_kernels, 2, a, b, min_seconds ) ) {
+			status = 1;
+		}
+
+		bm_delete( &b );
+		bm_delete( &a );
+	}
+
+	return status;
+}
@@ -0,0 +1,32 @@
+#ifndef __MM_HAMMING_H__
+#define __MM_HAMMING_H__
+
+#include "../lookup_table/hamming.h"
+#include "../matrix_multiplication/bm.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The matrix multiplication codec is built with its functions renamed, so it can be linked next to the lookup table codec.
+
+uint8_t mm_ham_encode( BitMatrix *g, uint8_t msg );
+
+HAM_STATUS mm_ham_decode( BitMatrix *ht, uint8_t code, uint8_t *msg );
+
+// The code functions have no lookup table counterparts, so they keep their names. The header can't be included next to the lookup table one.
+
+typedef struct HammingCode HammingCode;
+
+HammingCode *ham_code_create( uint32_t n, uint32_t k );
+
+void ham_code_delete( HammingCode **code );
+
+uint8_t ham_code_lookup_encode( const HammingCode *code, uint8_t msg );
+
+HAM_STATUS ham_code_lookup_decode( const HammingCode *code, uint8_t codeword, uint8_t *msg );
+
+void ham_code_encode_bytes( const HammingCode *code, const uint8_t *in, uint8_t *out, size_t n );
+
+void ham_code_decode_bytes( const HammingCode *code, const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+#endif
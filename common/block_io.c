@@ -0,0 +1,327 @@
+#include "block_io.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Description:
+// Parses a byte count given on the command line. A K, M, or G suffix multiplies the count by 2^10, 2^20, or 2^30.
+//
+// Parameters:
+// const char *str - The string to parse.
+// unsigned long long *value - Where to put the parsed count. Will be unmodified upon failure.
+//
+// Returns:
+// bool - Whether the string was a valid count of at most SIZE_MAX / 2.
+static bool parse_scaled( const char *str, unsigned long long *value ) {
+	char *end = NULL;
+	errno = 0;
+	unsigned long long parsed = strtoull( str, &end, 10 );
+
+	if ( errno || end == str || *str == '-' ) {
+		return false;
+	}
+
+	uint32_t shift = 0;
+
+	switch ( *end ) {
+	case 'k':
+	case 'K': shift = 10; end++; break;
+	case 'm':
+	case 'M': shift = 20; end++; break;
+	case 'g':
+	case 'G': shift = 30; end++; break;
+	default: break;
+	}
+
+	// Checked before shifting, since a shift that overflows would wrap around to a small value.
+	if ( *end != '\0' || parsed > ( SIZE_MAX / 2 ) >> shift ) {
+		return false;
+	}
+
+	*value = parsed << shift;
+
+	return true;
+}
+
+// Description:
+// Parses a buffer size given on the command line. A K, M, or G suffix multiplies the size by 2^10, 2^20, or 2^30, and
+// a size too large to multiply without wrapping around is rejected rather than used modulo 2^64.
+//
+// Parameters:
+// const char *str - The string to parse.
+// size_t *size - Where to put the parsed size. Will be unmodified upon failure.
+//
+// Returns:
+// bool - Whether the string was a valid, nonzero size of at most SIZE_MAX / 2 after scaling.
+bool block_io_parse_size( const char *str, size_t *size ) {
+	unsigned long long value = 0;
+
+	if ( !parse_scaled( str, &value ) || value == 0 ) {
+		return false;
+	}
+
+	*size = value;
+
+	return true;
+}
+
+// Description:
+// Parses a file offset given on the command line, which may be zero. A K, M, or G suffix multiplies the offset by 2^10,
+// 2^20, or 2^30.
+//
+// Parameters:
+// const char *str - The string to parse.
+// uint64_t *offset - Where to put the parsed offset. Will be unmodified upon failure.
+//
+// Returns:
+// bool - Whether the string was a valid offset.
+bool block_io_parse_offset( const char *str, uint64_t *offset ) {
+	unsigned long long value = 0;
+
+	if ( !parse_scaled( str, &value ) ) {
+		return false;
+	}
+
+	*offset = value;
+
+	return true;
+}
+
+// Description:
+// Checks whether a file is a regular file small enough that block I/O isn't worth setting up.
+//
+// Parameters:
+// FILE *file - The file to check.
+//
+// Returns:
+// bool - Whether the file is a small regular file.
+bool block_io_is_small_input( FILE *file ) {
+	struct stat file_stats;
+
+	if ( fstat( fileno( file ), &file_stats ) != 0 ) {
+		return false;
+	}
+
+	return S_ISREG( file_stats.st_mode ) && file_stats.st_size < BLOCK_IO_SMALL_INPUT_SIZE;
+}
+
+// Description:
+// Writes a whole buffer to a file descriptor, retrying on short writes and interrupts.
+//
+// Parameters:
+// int fd - The file descriptor to write to.
+// const uint8_t *buffer - The data to write.
+// size_t length - The number of bytes to write.
+//
+// Returns:
+// bool - Whether the whole buffer was written.
+bool block_io_write_all( int fd, const uint8_t *buffer, size_t length ) {
+	while ( length > 0 ) {
+		ssize_t written = write( fd, buffer, length );
+
+		if ( written < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+
+			return false;
+		}
+
+		buffer += written;
+		length -= written;
+	}
+
+	return true;
+}
+
+// Description:
+// Writes a whole buffer to an offset of a file descriptor, retrying on short writes and interrupts.
+//
+// Parameters:
+// int fd - The file descriptor to write to.
+// const uint8_t *buffer - The data to write.
+// size_t length - The number of bytes to write.
+// off_t offset - The offset to write to.
+//
+// Returns:
+// bool - Whether the whole buffer was written.
+bool block_io_pwrite_all( int fd, const uint8_t *buffer, size_t length, off_t offset ) {
+	while ( length > 0 ) {
+		ssize_t written = pwrite( fd, buffer, length, offset );
+
+		if ( written < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+
+			return false;
+		}
+
+		buffer += written;
+		offset += written;
+		length -= written;
+	}
+
+	return true;
+}
+
+// Description:
+// Reads from a file descriptor until a buffer is full or the end of the file is reached, retrying on interrupts.
+//
+// Parameters:
+// int fd - The file descriptor to read from.
+// uint8_t *buffer - Where to put the data.
+// size_t length - The number of bytes to read.
+//
+// Returns:
+// ssize_t - The number of bytes read, which is less than length only at the end of the file, or -1 upon failure.
+ssize_t block_io_read_full( int fd, uint8_t *buffer, size_t length ) {
+	size_t total = 0;
+
+	while ( total < length ) {
+		ssize_t bytes_read = read( fd, buffer + total, length - total );
+
+		if ( bytes_read < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+
+			return -1;
+		}
+
+		if ( bytes_read == 0 ) {
+			break;
+		}
+
+		total += bytes_read;
+	}
+
+	return total;
+}
+
+// Description:
+// Reads from an offset of a file descriptor until a buffer is full or the end of the file is reached, retrying on interrupts.
+//
+// Parameters:
+// int fd - The file descriptor to read from.
+// uint8_t *buffer - Where to put the data.
+// size_t length - The number of bytes to read.
+// off_t offset - The offset to read from.
+//
+// Returns:
+// ssize_t - The number of bytes read, or -1 upon failure.
+ssize_t block_io_pread_full( int fd, uint8_t *buffer, size_t length, off_t offset ) {
+	size_t total = 0;
+
+	while ( total < length ) {
+		ssize_t bytes_read = pread( fd, buffer + total, length - total, offset + total );
+
+		if ( bytes_read < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+
+			return -1;
+		}
+
+		if ( bytes_read == 0 ) {
+			break;
+		}
+
+		total += bytes_read;
+	}
+
+	return total;
+}
+
+// Description:
+// Reads the input file in large blocks, runs the codec over each block, and writes each result with a single write.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The codec to run over the data.
+// size_t buffer_size - The size of the input buffer in bytes. Rounded down to a whole number of units.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, processed, and written to the output file.
+bool block_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t buffer_size, CodecStats *stats ) {
+	int input_fd = fileno( input_file );
+	int output_fd = fileno( output_file );
+	size_t buffer_units = buffer_size / codec->in_unit > 0 ? buffer_size / codec->in_unit : 1;
+	uint8_t *input_buffer = malloc( buffer_units * codec->in_unit );
+	uint8_t *output_buffer = malloc( buffer_units * codec->out_unit );
+	size_t buffered = 0;
+	bool success = true;
+
+	if ( !input_buffer || !output_buffer ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+		free( output_buffer );
+		free( input_buffer );
+
+		return false;
+	}
+
+	fflush( output_file ); // Nothing written through stdio may end up after the blocks.
+
+	while ( success ) {
+		ssize_t bytes_read = read( input_fd, input_buffer + buffered, buffer_units * codec->in_unit - buffered );
+
+		if ( bytes_read < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+
+			fprintf( stderr, "Error: failed to read from input file.\n" );
+			success = false;
+			break;
+		}
+
+		if ( bytes_read == 0 ) {
+			break;
+		}
+
+		stats->total_bytes_processed += bytes_read;
+		buffered += bytes_read;
+		size_t units = buffered / codec->in_unit;
+
+		if ( units == 0 ) {
+			continue;
+		}
+
+		codec->process( input_buffer, output_buffer, units, stats );
+
+		if ( !block_io_write_all( output_fd, output_buffer, units * codec->out_unit ) ) {
+			fprintf( stderr, "Error: failed to write to output file.\n" );
+			success = false;
+			break;
+		}
+
+		// Keep any partial unit for the next read.
+		buffered -= units * codec->in_unit;
+		memmove( input_buffer, input_buffer + units * codec->in_unit, buffered );
+	}
+
+	if ( success && buffered > 0 && codec->pad_tail ) {
+		memset( input_buffer + buffered, 0, codec->in_unit - buffered );
+		codec->process( input_buffer, output_buffer, 1, stats );
+
+		if ( !block_io_write_all( output_fd, output_buffer, codec->out_unit ) ) {
+			fprintf( stderr, "Error: failed to write to output file.\n" );
+			success = false;
+		}
+	}
+
+	free( output_buffer );
+	free( input_buffer );
+
+	return success;
+}
@@ -0,0 +1,45 @@
+#ifndef __BLOCK_IO_H__
+#define __BLOCK_IO_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#define BLOCK_IO_DEFAULT_BUFFER_SIZE ( 1 << 20 ) // Default size of the input buffer in bytes.
+#define BLOCK_IO_SMALL_INPUT_SIZE    4096 // Regular files smaller than this are processed byte-by-byte.
+
+typedef struct CodecStats {
+	uint64_t total_bytes_processed; // Number of input bytes read.
+	uint64_t uncorrectable_errors; // Number of code units that could not be corrected.
+	uint64_t corrected_errors; // Number of code units that were corrected.
+	uint64_t checksum_failures; // Number of container chunks whose decoded data didn't match their CRC-32C.
+} CodecStats;
+
+typedef void ( *BlockCodecFunction )( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats );
+
+typedef struct BlockCodec {
+	size_t in_unit; // Number of input bytes consumed per unit.
+	size_t out_unit; // Number of output bytes produced per unit.
+	bool pad_tail; // Whether a trailing partial unit is zero-padded and processed instead of dropped.
+	BlockCodecFunction process; // Processes a whole number of units from in to out.
+} BlockCodec;
+
+bool block_io_parse_size( const char *str, size_t *size );
+
+bool block_io_parse_offset( const char *str, uint64_t *offset );
+
+bool block_io_is_small_input( FILE *file );
+
+bool block_io_write_all( int fd, const uint8_t *buffer, size_t length );
+
+bool block_io_pwrite_all( int fd, const uint8_t *buffer, size_t length, off_t offset );
+
+ssize_t block_io_read_full( int fd, uint8_t *buffer, size_t length );
+
+ssize_t block_io_pread_full( int fd, uint8_t *buffer, size_t length, off_t offset );
+
+bool block_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t buffer_size, CodecStats *stats );
+
+#endif
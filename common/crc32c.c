@@ -0,0 +1,208 @@
+#include "crc32c.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined( __x86_64__ )
+#include <immintrin.h>
+
+#define CRC32C_X86 // Whether the crc32 instruction can be used.
+#endif
+
+#define CRC32C_POLYNOMIAL 0x82F63B78 // The Castagnoli polynomial, bit-reversed.
+#define CRC32C_LANE_SIZE  1024 // Size in bytes of each of the 3 lanes the crc32 instruction is run over at once.
+
+// Lookup tables for slicing-by-8. Table k holds the CRC of each byte followed by k zero bytes.
+static uint32_t crc32c_lookup[ 8 ][ 256 ];
+
+// Makes sure build_tables runs once.
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+// Description:
+// Builds the slicing-by-8 lookup tables.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// Nothing.
+static void build_tables( ) {
+	for ( uint32_t byte = 0; byte < 256; byte++ ) {
+		uint32_t crc = byte;
+
+		for ( uint32_t bit = 0; bit < 8; bit++ ) {
+			crc = crc & 1 ? ( crc >> 1 ) ^ CRC32C_POLYNOMIAL : crc >> 1;
+		}
+
+		crc32c_lookup[ 0 ][ byte ] = crc;
+	}
+
+	for ( uint32_t table = 1; table < 8; table++ ) {
+		for ( uint32_t byte = 0; byte < 256; byte++ ) {
+			uint32_t crc = crc32c_lookup[ table - 1 ][ byte ];
+			crc32c_lookup[ table ][ byte ] = ( crc >> 8 ) ^ crc32c_lookup[ 0 ][ crc & 0xFF ];
+		}
+	}
+}
+
+// Description:
+// Updates a CRC register with some bytes, 8 at a time with the slicing-by-8 tables.
+//
+// Parameters:
+// uint32_t crc - The register, already inverted.
+// const uint8_t *data - The bytes.
+// size_t length - The number of bytes.
+//
+// Returns:
+// uint32_t - The updated register.
+static uint32_t update_table( uint32_t crc, const uint8_t *data, size_t length ) {
+	pthread_once( &tables_once, build_tables );
+
+	for ( ; length >= 8; data += 8, length -= 8 ) {
+		uint32_t low = crc ^ ( data[ 0 ] | data[ 1 ] << 8 | data[ 2 ] << 16 | ( uint32_t ) data[ 3 ] << 24 );
+		crc = crc32c_lookup[ 7 ][ low & 0xFF ] ^ crc32c_lookup[ 6 ][ ( low >> 8 ) & 0xFF ] ^ crc32c_lookup[ 5 ][ ( low >> 16 ) & 0xFF ] ^ crc32c_lookup[ 4 ][ low >> 24 ] ^
+		    crc32c_lookup[ 3 ][ data[ 4 ] ] ^ crc32c_lookup[ 2 ][ data[ 5 ] ] ^ crc32c_lookup[ 1 ][ data[ 6 ] ] ^ crc32c_lookup[ 0 ][ data[ 7 ] ];
+	}
+
+	for ( ; length > 0; data++, length-- ) {
+		crc = ( crc >> 8 ) ^ crc32c_lookup[ 0 ][ ( crc ^ *data ) & 0xFF ];
+	}
+
+	return crc;
+}
+
+#ifdef CRC32C_X86
+// Lookup tables that shift a CRC register over CRC32C_LANE_SIZE zero bytes. Table k holds the shifted register of each
+// value of its byte k.
+static uint32_t crc32c_shift_lookup[ 4 ][ 256 ];
+
+// Makes sure build_shift_tables runs once.
+static pthread_once_t shift_tables_once = PTHREAD_ONCE_INIT;
+
+// Description:
+// Updates a CRC register with some bytes, 8 at a time with the SSE4.2 crc32 instruction.
+//
+// Parameters:
+// Same as update_table.
+//
+// Returns:
+// uint32_t - The updated register.
+__attribute__( ( target( "sse4.2" ) ) ) static uint32_t update_serial_sse42( uint32_t crc, const uint8_t *data, size_t length ) {
+	uint64_t crc64 = crc;
+
+	for ( ; length >= 8; data += 8, length -= 8 ) {
+		uint64_t word = 0;
+		memcpy( &word, data, sizeof( word ) );
+		crc64 = _mm_crc32_u64( crc64, word );
+	}
+
+	crc = crc64;
+
+	for ( ; length > 0; data++, length-- ) {
+		crc = _mm_crc32_u8( crc, *data );
+	}
+
+	return crc;
+}
+
+// Description:
+// Builds the lookup tables that shift a CRC register over a lane of zero bytes. The shift is linear, so only the shift
+// of each single bit is computed, and each table entry is the XOR of the shifts of its bits.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "sse4.2" ) ) ) static void build_shift_tables( ) {
+	static const uint8_t zeros[ CRC32C_LANE_SIZE ];
+	uint32_t bit_shifts[ 32 ];
+
+	for ( uint32_t bit = 0; bit < 32; bit++ ) {
+		bit_shifts[ bit ] = update_serial_sse42( 1u << bit, zeros, sizeof( zeros ) );
+	}
+
+	for ( uint32_t table = 0; table < 4; table++ ) {
+		for ( uint32_t byte = 0; byte < 256; byte++ ) {
+			uint32_t shifted = 0;
+
+			for ( uint32_t bit = 0; bit < 8; bit++ ) {
+				shifted ^= byte >> bit & 1 ? bit_shifts[ 8 * table + bit ] : 0;
+			}
+
+			crc32c_shift_lookup[ table ][ byte ] = shifted;
+		}
+	}
+}
+
+// Description:
+// Shifts a CRC register over a lane of zero bytes.
+//
+// Parameters:
+// uint32_t crc - The register.
+//
+// Returns:
+// uint32_t - The shifted register.
+static inline uint32_t shift_lane( uint32_t crc ) {
+	return crc32c_shift_lookup[ 0 ][ crc & 0xFF ] ^ crc32c_shift_lookup[ 1 ][ ( crc >> 8 ) & 0xFF ] ^ crc32c_shift_lookup[ 2 ][ ( crc >> 16 ) & 0xFF ] ^ crc32c_shift_lookup[ 3 ][ crc >> 24 ];
+}
+
+// Description:
+// Updates a CRC register with some bytes with the SSE4.2 crc32 instruction. Each crc32 waits 3 cycles for the last
+// one, so blocks of 3 lanes are done at once, the second and third starting from a zero register, and joined by shifting
+// each lane's register over the next lane and XORing it into the next lane's, which works because the CRC is linear.
+//
+// Parameters:
+// Same as update_table.
+//
+// Returns:
+// uint32_t - The updated register.
+__attribute__( ( target( "sse4.2" ) ) ) static uint32_t update_sse42( uint32_t crc, const uint8_t *data, size_t length ) {
+	if ( length >= 3 * CRC32C_LANE_SIZE ) {
+		pthread_once( &shift_tables_once, build_shift_tables );
+	}
+
+	for ( ; length >= 3 * CRC32C_LANE_SIZE; data += 3 * CRC32C_LANE_SIZE, length -= 3 * CRC32C_LANE_SIZE ) {
+		uint64_t crc0 = crc;
+		uint64_t crc1 = 0;
+		uint64_t crc2 = 0;
+
+		for ( size_t i = 0; i < CRC32C_LANE_SIZE; i += 8 ) {
+			uint64_t words[ 3 ];
+			memcpy( &words[ 0 ], data + i, sizeof( uint64_t ) );
+			memcpy( &words[ 1 ], data + CRC32C_LANE_SIZE + i, sizeof( uint64_t ) );
+			memcpy( &words[ 2 ], data + 2 * CRC32C_LANE_SIZE + i, sizeof( uint64_t ) );
+			crc0 = _mm_crc32_u64( crc0, words[ 0 ] );
+			crc1 = _mm_crc32_u64( crc1, words[ 1 ] );
+			crc2 = _mm_crc32_u64( crc2, words[ 2 ] );
+		}
+
+		crc = shift_lane( shift_lane( crc0 ) ^ crc1 ) ^ crc2;
+	}
+
+	return update_serial_sse42( crc, data, length );
+}
+#endif
+
+// Description:
+// Computes the CRC-32C (Castagnoli) checksum of some bytes, with the SSE4.2 crc32 instruction when the CPU has it and
+// with lookup tables otherwise. Safe to call from several threads at once.
+//
+// Parameters:
+// uint32_t crc - The checksum of the bytes before these, to continue it, or 0 to start a new one.
+// const uint8_t *data - The bytes.
+// size_t length - The number of bytes.
+//
+// Returns:
+// uint32_t - The checksum.
+uint32_t crc32c( uint32_t crc, const uint8_t *data, size_t length ) {
+#ifdef CRC32C_X86
+	if ( __builtin_cpu_supports( "sse4.2" ) ) {
+		return ~update_sse42( ~crc, data, length );
+	}
+#endif
+
+	return ~update_table( ~crc, data, length );
+}
@@ -0,0 +1,9 @@
+#ifndef __CRC32C_H__
+#define __CRC32C_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+uint32_t crc32c( uint32_t crc, const uint8_t *data, size_t length );
+
+#endif
@@ -0,0 +1,186 @@
+#include "error_map.h"
+
+#include "block_io.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Description:
+// The state of the error map. The codec callback has no context argument, so there is one map per program.
+//
+// Members:
+// FILE *file - The file the ranges are written to, or NULL if no map is open.
+// BlockCodec codec - The decoder whose uncorrectable units are mapped.
+// uint64_t position - The offset in the decoded data of the next unit the decoder will be given.
+// uint64_t range_offset - The offset of the range being built, which isn't written until a gap follows it.
+// uint64_t range_length - The number of bytes in the range being built, or 0 if there is none.
+// bool failed - Whether a write to the file failed.
+typedef struct ErrorMap {
+	FILE *file;
+	BlockCodec codec;
+	uint64_t position;
+	uint64_t range_offset;
+	uint64_t range_length;
+	bool failed;
+} ErrorMap;
+
+static ErrorMap error_map;
+
+// Description:
+// Writes the range being built to the file.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// Nothing.
+static void flush_range( ) {
+	if ( error_map.range_length > 0 && fprintf( error_map.file, "%" PRIu64 " %" PRIu64 "\n", error_map.range_offset, error_map.range_length ) < 0 ) {
+		error_map.failed = true;
+	}
+
+	error_map.range_length = 0;
+}
+
+// Description:
+// Adds a range of decoded bytes with uncorrectable errors to the map. Ranges must be added in order, and a range that
+// starts where the last one ended is merged into it. Does nothing if no map is open.
+//
+// Parameters:
+// uint64_t offset - The offset of the range in the decoded data.
+// uint64_t length - The number of bytes in the range.
+//
+// Returns:
+// Nothing.
+void error_map_add( uint64_t offset, uint64_t length ) {
+	if ( !error_map.file ) {
+		return;
+	}
+
+	if ( error_map.range_length > 0 && error_map.range_offset + error_map.range_length == offset ) {
+		error_map.range_length += length;
+
+		return;
+	}
+
+	flush_range( );
+	error_map.range_offset = offset;
+	error_map.range_length = length;
+}
+
+// Description:
+// Finds the units with uncorrectable errors in a block known to have some by decoding each half of it again, and only
+// looking further into the halves that still have some, down to single units.
+//
+// Parameters:
+// const uint8_t *in - The codes of the block.
+// uint8_t *out - Where the block was decoded to. The same data is decoded into it again.
+// size_t units - The number of units in the block.
+// uint64_t offset - The offset in the decoded data of the block's first unit.
+//
+// Returns:
+// Nothing.
+static void locate_errors( const uint8_t *in, uint8_t *out, size_t units, uint64_t offset ) {
+	const BlockCodec *codec = &error_map.codec;
+
+	if ( units == 1 ) {
+		error_map_add( offset, codec->out_unit );
+
+		return;
+	}
+
+	size_t half = units / 2;
+	CodecStats first_stats = { 0, 0, 0, 0 };
+	CodecStats second_stats = { 0, 0, 0, 0 };
+	codec->process( in, out, half, &first_stats );
+	codec->process( in + half * codec->in_unit, out + half * codec->out_unit, units - half, &second_stats );
+
+	if ( first_stats.uncorrectable_errors > 0 ) {
+		locate_errors( in, out, half, offset );
+	}
+
+	if ( second_stats.uncorrectable_errors > 0 ) {
+		locate_errors( in + half * codec->in_unit, out + half * codec->out_unit, units - half, offset + half * codec->out_unit );
+	}
+}
+
+// Description:
+// Decodes a block with the mapped decoder, and only when it had uncorrectable errors, finds and maps them, so clean
+// blocks only cost a comparison.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode.
+// uint8_t *out - Where to put the decoded data.
+// size_t units - The number of units to decode.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// Nothing.
+static void map_errors_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	uint64_t uncorrectable_errors = stats->uncorrectable_errors;
+	error_map.codec.process( in, out, units, stats );
+
+	if ( stats->uncorrectable_errors != uncorrectable_errors ) {
+		locate_errors( in, out, units, error_map.position );
+	}
+
+	error_map.position += units * error_map.codec.out_unit;
+}
+
+// Description:
+// Opens an error map, which lists the ranges of decoded bytes that came from codes with uncorrectable errors as lines
+// of a decimal offset and length, so they can be fetched again from elsewhere. The decoder must be given its blocks in
+// order, so the I/O must run on one thread.
+//
+// Parameters:
+// const char *file_name - The file to write the map to.
+// const BlockCodec *codec - The decoder to map the errors of.
+// uint64_t offset - The offset in the decoded data of the first unit the decoder will be given.
+// BlockCodec *mapped_codec - Where to put a codec that decodes with the decoder and maps its uncorrectable errors. May
+// be the decoder itself, which is copied first.
+//
+// Returns:
+// bool - Whether the file could be opened.
+bool error_map_open( const char *file_name, const BlockCodec *codec, uint64_t offset, BlockCodec *mapped_codec ) {
+	if ( !( error_map.file = fopen( file_name, "w" ) ) ) {
+		fprintf( stderr, "Error: failed to open error map file.\n" );
+
+		return false;
+	}
+
+	error_map.codec = *codec;
+	error_map.position = offset;
+	error_map.range_length = 0;
+	error_map.failed = false;
+	*mapped_codec = *codec;
+	mapped_codec->process = map_errors_block;
+
+	return true;
+}
+
+// Description:
+// Writes the last range of the error map and closes it. Does nothing if no map is open.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// bool - Whether the whole map could be written.
+bool error_map_close( ) {
+	if ( !error_map.file ) {
+		return true;
+	}
+
+	flush_range( );
+	bool success = fclose( error_map.file ) == 0 && !error_map.failed;
+	error_map.file = NULL;
+
+	if ( !success ) {
+		fprintf( stderr, "Error: failed to write to error map file.\n" );
+	}
+
+	return success;
+}
@@ -0,0 +1,17 @@
+#ifndef __ERROR_MAP_H__
+#define __ERROR_MAP_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+bool error_map_open( const char *file_name, const BlockCodec *codec, uint64_t offset, BlockCodec *mapped_codec );
+
+void error_map_add( uint64_t offset, uint64_t length );
+
+bool error_map_close( );
+
+#endif
@@ -0,0 +1,956 @@
+#include "frame_io.h"
+
+#include "block_io.h"
+#include "crc32c.h"
+#include "parallel_io.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FRAME_IO_MAGIC   "HAMF" // The first bytes of a container.
+#define FRAME_IO_VERSION 1 // Version of the container format.
+
+typedef enum FRAME_FAILURE {
+	FRAME_OK, // No failures.
+	FRAME_READ_FAILED, // A read from the input file failed.
+	FRAME_WRITE_FAILED, // A write to the output file failed.
+	FRAME_TRUNCATED, // The container ended in the middle of a chunk or before its last chunk.
+	FRAME_CORRUPT, // A chunk header didn't match its position or length.
+} FRAME_FAILURE;
+
+// Description:
+// State shared by the main thread and the workers.
+//
+// Members:
+// const BlockCodec *codec - The codec to run over each chunk.
+// bool encoding - Whether the codec encodes original data into codes, instead of decoding codes.
+// size_t data_unit - The number of bytes of original data in each unit of the codec.
+// size_t code_unit - The number of code bytes in each unit of the codec.
+// size_t chunk_size - The number of bytes of original data in each chunk but the last.
+// size_t trailer_size - The number of bytes after each chunk's codes, FRAME_IO_CHECKSUM_SIZE with checksums and 0 without.
+// size_t frame_size - The number of bytes a chunk takes up in the container, with its header and trailer, for all chunks but the last.
+// int input_fd - The file descriptor to read from.
+// int output_fd - The file descriptor to write to.
+// off_t input_base - The offset in the input file the original data or the first chunk starts at.
+// off_t output_base - The offset in the output file the container or the original data starts at.
+// uint64_t original_length - The number of bytes of original data. Only used by the workers.
+// uint64_t chunks - The number of chunks. Only used by the workers.
+// atomic_uint_fast64_t next_chunk - The next chunk for a worker to claim.
+// atomic_int failure - The first FRAME_FAILURE a worker hit.
+// atomic_uint_fast64_t checksum_failures - The number of decoded chunks whose data didn't match their checksum.
+typedef struct FrameJob {
+	const BlockCodec *codec;
+	bool encoding;
+	size_t data_unit;
+	size_t code_unit;
+	size_t chunk_size;
+	size_t trailer_size;
+	size_t frame_size;
+	int input_fd;
+	int output_fd;
+	off_t input_base;
+	off_t output_base;
+	uint64_t original_length;
+	uint64_t chunks;
+	atomic_uint_fast64_t next_chunk;
+	atomic_int failure;
+	atomic_uint_fast64_t checksum_failures;
+} FrameJob;
+
+// Description:
+// A worker thread and the buffers it owns.
+//
+// Members:
+// pthread_t thread - The thread.
+// FrameJob *job - The shared job state.
+// uint8_t *data_buffer - A chunk of original data.
+// uint8_t *frame_buffer - A chunk as it's laid out in the container, header first.
+// CodecStats stats - The statistics of the chunks processed by this worker, merged at the end.
+typedef struct FrameWorker {
+	pthread_t thread;
+	FrameJob *job;
+	uint8_t *data_buffer;
+	uint8_t *frame_buffer;
+	CodecStats stats;
+} FrameWorker;
+
+// Description:
+// Stores an integer in little-endian order.
+//
+// Parameters:
+// uint8_t *bytes - Where to store the integer.
+// uint64_t value - The integer.
+// uint32_t size - The number of bytes to store.
+//
+// Returns:
+// Nothing.
+static void put_le( uint8_t *bytes, uint64_t value, uint32_t size ) {
+	for ( uint32_t i = 0; i < size; i++ ) {
+		bytes[ i ] = value >> ( 8 * i );
+	}
+}
+
+// Description:
+// Loads an integer stored in little-endian order.
+//
+// Parameters:
+// const uint8_t *bytes - The stored integer.
+// uint32_t size - The number of bytes to load.
+//
+// Returns:
+// uint64_t - The integer.
+static uint64_t get_le( const uint8_t *bytes, uint32_t size ) {
+	uint64_t value = 0;
+
+	for ( uint32_t i = 0; i < size; i++ ) {
+		value |= ( uint64_t ) bytes[ i ] << ( 8 * i );
+	}
+
+	return value;
+}
+
+// Description:
+// Picks the number of bytes of original data in each chunk for a buffer size.
+//
+// Parameters:
+// size_t buffer_size - The buffer size given on the command line.
+// size_t data_unit - The number of bytes of original data in each unit of the code.
+//
+// Returns:
+// size_t - The buffer size capped at FRAME_IO_MAX_CHUNK_SIZE and rounded down to a whole number of units, but at least one unit.
+size_t frame_io_chunk_size( size_t buffer_size, size_t data_unit ) {
+	size_t size = buffer_size < FRAME_IO_MAX_CHUNK_SIZE ? buffer_size : FRAME_IO_MAX_CHUNK_SIZE;
+
+	return size / data_unit > 0 ? size / data_unit * data_unit : data_unit;
+}
+
+// Description:
+// Reads and checks a container's file header.
+//
+// Parameters:
+// FILE *input_file - The file to read from, positioned at the start of the container.
+// FrameHeader *header - Where to put the header's fields.
+//
+// Returns:
+// bool - Whether a valid header could be read.
+bool frame_io_read_header( FILE *input_file, FrameHeader *header ) {
+	uint8_t bytes[ FRAME_IO_HEADER_SIZE ];
+	ssize_t bytes_read = block_io_read_full( fileno( input_file ), bytes, sizeof( bytes ) );
+
+	if ( bytes_read < 0 ) {
+		fprintf( stderr, "Error: failed to read from input file.\n" );
+
+		return false;
+	}
+
+	if ( ( size_t ) bytes_read < sizeof( bytes ) || memcmp( bytes, FRAME_IO_MAGIC, 4 ) != 0 || get_le( bytes + 4, 2 ) != FRAME_IO_VERSION || get_le( bytes + 6, 2 ) != FRAME_IO_HEADER_SIZE ) {
+		fprintf( stderr, "Error: input file isn't a container.\n" );
+
+		return false;
+	}
+
+	header->code_length = get_le( bytes + 8, 4 );
+	header->message_length = get_le( bytes + 12, 4 );
+	header->chunk_size = get_le( bytes + 16, 4 );
+	header->flags = get_le( bytes + 20, 4 );
+	header->original_length = get_le( bytes + 24, 8 );
+
+	if ( header->chunk_size == 0 || header->chunk_size > FRAME_IO_MAX_CHUNK_SIZE || ( header->flags & ~FRAME_IO_FLAG_CRC32C ) != 0 ) {
+		fprintf( stderr, "Error: invalid container header.\n" );
+
+		return false;
+	}
+
+	return true;
+}
+
+// Description:
+// Lays out a container's file header.
+//
+// Parameters:
+// const FrameHeader *header - The header's fields.
+// uint8_t *bytes - Where to put the header. Must hold FRAME_IO_HEADER_SIZE bytes.
+//
+// Returns:
+// Nothing.
+static void build_header( const FrameHeader *header, uint8_t *bytes ) {
+	memset( bytes, 0, FRAME_IO_HEADER_SIZE );
+	memcpy( bytes, FRAME_IO_MAGIC, 4 );
+	put_le( bytes + 4, FRAME_IO_VERSION, 2 );
+	put_le( bytes + 6, FRAME_IO_HEADER_SIZE, 2 );
+	put_le( bytes + 8, header->code_length, 4 );
+	put_le( bytes + 12, header->message_length, 4 );
+	put_le( bytes + 16, header->chunk_size, 4 );
+	put_le( bytes + 20, header->flags, 4 );
+	put_le( bytes + 24, header->original_length, 8 );
+}
+
+// Description:
+// Gets the number of code bytes that a number of bytes of original data is encoded into. A trailing partial unit is
+// zero-padded.
+//
+// Parameters:
+// const FrameJob *job - The job.
+// size_t data_length - The number of bytes of original data.
+//
+// Returns:
+// size_t - The number of code bytes.
+static size_t code_length_of( const FrameJob *job, size_t data_length ) {
+	return ( data_length + job->data_unit - 1 ) / job->data_unit * job->code_unit;
+}
+
+// Description:
+// Gets the number of bytes a chunk takes up in the container, with its header and trailer.
+//
+// Parameters:
+// const FrameJob *job - The job.
+// size_t data_length - The number of bytes of original data in the chunk.
+//
+// Returns:
+// size_t - The number of bytes in the chunk.
+static size_t frame_length_of( const FrameJob *job, size_t data_length ) {
+	return FRAME_IO_CHUNK_HEADER_SIZE + code_length_of( job, data_length ) + job->trailer_size;
+}
+
+// Description:
+// Gets the number of bytes of original data in a chunk of a container whose original length is known.
+//
+// Parameters:
+// const FrameJob *job - The job.
+// uint64_t chunk - The index of the chunk.
+//
+// Returns:
+// size_t - The number of bytes of original data in the chunk.
+static size_t data_length_of( const FrameJob *job, uint64_t chunk ) {
+	return chunk + 1 < job->chunks ? job->chunk_size : job->original_length - chunk * job->chunk_size;
+}
+
+// Description:
+// Encodes a chunk of original data into a chunk header followed by the codes, and the checksum of the data if the
+// container has them.
+//
+// Parameters:
+// const FrameJob *job - The job.
+// uint64_t chunk - The index of the chunk.
+// uint8_t *data - The original data. Must have room to pad the last unit.
+// size_t data_length - The number of bytes of original data.
+// uint8_t *frame - Where to put the chunk. Must hold frame_size bytes.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// size_t - The number of bytes put in the frame.
+static size_t encode_chunk( const FrameJob *job, uint64_t chunk, uint8_t *data, size_t data_length, uint8_t *frame, CodecStats *stats ) {
+	size_t code_length = code_length_of( job, data_length );
+	size_t units = code_length / job->code_unit;
+	memset( data + data_length, 0, units * job->data_unit - data_length );
+	put_le( frame, chunk, 8 );
+	put_le( frame + 8, data_length, 4 );
+	put_le( frame + 12, code_length, 4 );
+
+	if ( units > 0 ) {
+		job->codec->process( data, frame + FRAME_IO_CHUNK_HEADER_SIZE, units, stats );
+	}
+
+	if ( job->trailer_size > 0 ) {
+		put_le( frame + FRAME_IO_CHUNK_HEADER_SIZE + code_length, crc32c( 0, data, data_length ), FRAME_IO_CHECKSUM_SIZE );
+	}
+
+	stats->total_bytes_processed += data_length;
+
+	return frame_length_of( job, data_length );
+}
+
+// Description:
+// Checks a chunk header against the chunk's position in the container.
+//
+// Parameters:
+// const FrameJob *job - The job.
+// uint64_t chunk - The index the chunk should have.
+// const uint8_t *frame - The chunk header.
+// size_t *data_length - Where to put the number of bytes of original data in the chunk.
+//
+// Returns:
+// bool - Whether the header is valid.
+static bool parse_chunk_header( const FrameJob *job, uint64_t chunk, const uint8_t *frame, size_t *data_length ) {
+	*data_length = get_le( frame + 8, 4 );
+
+	return get_le( frame, 8 ) == chunk && *data_length <= job->chunk_size && get_le( frame + 12, 4 ) == code_length_of( job, *data_length );
+}
+
+// Description:
+// Decodes the codes of a chunk whose header was checked, and checks the decoded data against the chunk's checksum if
+// the container has them, counting the chunk if it doesn't match. The data is still output, since all but a few of its
+// bytes are usually right.
+//
+// Parameters:
+// FrameJob *job - The job.
+// const uint8_t *frame - The chunk, header first.
+// size_t data_length - The number of bytes of original data in the chunk.
+// uint8_t *data - Where to put the original data. Must hold chunk_size bytes.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// Nothing.
+static void decode_chunk( FrameJob *job, const uint8_t *frame, size_t data_length, uint8_t *data, CodecStats *stats ) {
+	size_t code_length = code_length_of( job, data_length );
+
+	if ( code_length > 0 ) {
+		job->codec->process( frame + FRAME_IO_CHUNK_HEADER_SIZE, data, code_length / job->code_unit, stats );
+	}
+
+	if ( job->trailer_size > 0 && get_le( frame + FRAME_IO_CHUNK_HEADER_SIZE + code_length, FRAME_IO_CHECKSUM_SIZE ) != crc32c( 0, data, data_length ) ) {
+		atomic_fetch_add( &job->checksum_failures, 1 );
+	}
+
+	stats->total_bytes_processed += frame_length_of( job, data_length );
+}
+
+// Description:
+// Records a failure unless another one was recorded first.
+//
+// Parameters:
+// FrameJob *job - The job that failed.
+// FRAME_FAILURE failure - The failure.
+//
+// Returns:
+// Nothing.
+static void record_failure( FrameJob *job, FRAME_FAILURE failure ) {
+	int expected = FRAME_OK;
+	atomic_compare_exchange_strong( &job->failure, &expected, failure );
+}
+
+// Description:
+// Reads, encodes, and writes one chunk at its offsets.
+//
+// Parameters:
+// FrameWorker *worker - The worker.
+// uint64_t chunk - The index of the chunk.
+//
+// Returns:
+// FRAME_FAILURE - FRAME_OK, or what went wrong.
+static FRAME_FAILURE encode_positional( FrameWorker *worker, uint64_t chunk ) {
+	FrameJob *job = worker->job;
+	size_t data_length = data_length_of( job, chunk );
+
+	if ( block_io_pread_full( job->input_fd, worker->data_buffer, data_length, job->input_base + chunk * job->chunk_size ) != ( ssize_t ) data_length ) {
+		return FRAME_READ_FAILED;
+	}
+
+	size_t frame_length = encode_chunk( job, chunk, worker->data_buffer, data_length, worker->frame_buffer, &worker->stats );
+
+	if ( !block_io_pwrite_all( job->output_fd, worker->frame_buffer, frame_length, job->output_base + FRAME_IO_HEADER_SIZE + chunk * job->frame_size ) ) {
+		return FRAME_WRITE_FAILED;
+	}
+
+	return FRAME_OK;
+}
+
+// Description:
+// Reads, checks, decodes, and writes one chunk at its offsets.
+//
+// Parameters:
+// FrameWorker *worker - The worker.
+// uint64_t chunk - The index of the chunk.
+//
+// Returns:
+// FRAME_FAILURE - FRAME_OK, or what went wrong.
+static FRAME_FAILURE decode_positional( FrameWorker *worker, uint64_t chunk ) {
+	FrameJob *job = worker->job;
+	size_t data_length = data_length_of( job, chunk );
+	size_t frame_length = frame_length_of( job, data_length );
+	ssize_t bytes_read = block_io_pread_full( job->input_fd, worker->frame_buffer, frame_length, job->input_base + chunk * job->frame_size );
+	size_t header_length = 0;
+
+	if ( bytes_read < 0 ) {
+		return FRAME_READ_FAILED;
+	}
+
+	if ( ( size_t ) bytes_read < frame_length ) {
+		return FRAME_TRUNCATED;
+	}
+
+	if ( !parse_chunk_header( job, chunk, worker->frame_buffer, &header_length ) || header_length != data_length ) {
+		return FRAME_CORRUPT;
+	}
+
+	decode_chunk( job, worker->frame_buffer, data_length, worker->data_buffer, &worker->stats );
+
+	if ( !block_io_pwrite_all( job->output_fd, worker->data_buffer, data_length, job->output_base + chunk * job->chunk_size ) ) {
+		return FRAME_WRITE_FAILED;
+	}
+
+	return FRAME_OK;
+}
+
+// Description:
+// The entry point of a worker thread. Claims chunks until none are left.
+//
+// Parameters:
+// void *arg - The FrameWorker the thread runs as.
+//
+// Returns:
+// void * - Always NULL.
+static void *worker_main( void *arg ) {
+	FrameWorker *worker = arg;
+	FrameJob *job = worker->job;
+
+	while ( atomic_load( &job->failure ) == FRAME_OK ) {
+		uint64_t chunk = atomic_fetch_add( &job->next_chunk, 1 );
+
+		if ( chunk >= job->chunks ) {
+			break;
+		}
+
+		FRAME_FAILURE failure = job->encoding ? encode_positional( worker, chunk ) : decode_positional( worker, chunk );
+
+		if ( failure != FRAME_OK ) {
+			record_failure( job, failure );
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+// Description:
+// Processes every chunk of the job on a pool of worker threads, each reading and writing its chunks at their offsets.
+//
+// Parameters:
+// FrameJob *job - The job, with the number of chunks and the original length set.
+// uint32_t threads - The number of worker threads.
+// CodecStats *stats - The statistics to add the merged statistics of every worker to.
+//
+// Returns:
+// FRAME_FAILURE - FRAME_OK, FRAME_READ_FAILED if the workers couldn't be started, or what a worker hit first.
+static FRAME_FAILURE run_workers( FrameJob *job, uint32_t threads, CodecStats *stats ) {
+	FrameWorker *workers = calloc( threads, sizeof( FrameWorker ) );
+	uint32_t started = 0;
+	bool success = workers != NULL;
+
+	for ( uint32_t i = 0; workers && i < threads; i++ ) {
+		workers[ i ].job = job;
+		workers[ i ].data_buffer = malloc( job->chunk_size );
+		workers[ i ].frame_buffer = malloc( job->frame_size );
+		success = success && workers[ i ].data_buffer && workers[ i ].frame_buffer;
+	}
+
+	if ( !success ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+	}
+
+	for ( ; success && started < threads; started++ ) {
+		if ( pthread_create( &workers[ started ].thread, NULL, worker_main, &workers[ started ] ) != 0 ) {
+			fprintf( stderr, "Error: failed to create thread.\n" );
+			success = false;
+			// Let the started workers finish without claiming more chunks.
+			record_failure( job, FRAME_READ_FAILED );
+			break;
+		}
+	}
+
+	for ( uint32_t i = 0; i < started; i++ ) {
+		pthread_join( workers[ i ].thread, NULL );
+	}
+
+	for ( uint32_t i = 0; workers && i < threads; i++ ) {
+		stats->total_bytes_processed += workers[ i ].stats.total_bytes_processed;
+		stats->uncorrectable_errors += workers[ i ].stats.uncorrectable_errors;
+		stats->corrected_errors += workers[ i ].stats.corrected_errors;
+		free( workers[ i ].frame_buffer );
+		free( workers[ i ].data_buffer );
+	}
+
+	free( workers );
+
+	return success ? atomic_load( &job->failure ) : FRAME_READ_FAILED;
+}
+
+// Description:
+// Reads the input in chunks, encoding each and writing it after the last.
+//
+// Parameters:
+// FrameJob *job - The job.
+// uint8_t *data - A buffer for a chunk of original data.
+// uint8_t *frame - A buffer for a chunk as it's laid out in the container.
+// uint64_t *original_length - Where to put the number of bytes of original data.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// FRAME_FAILURE - FRAME_OK, or what went wrong.
+static FRAME_FAILURE encode_stream( FrameJob *job, uint8_t *data, uint8_t *frame, uint64_t *original_length, CodecStats *stats ) {
+	*original_length = 0;
+
+	// The last chunk is the first one that isn't full, so the end of the data is marked even when it fills the last chunk.
+	for ( uint64_t chunk = 0;; chunk++ ) {
+		ssize_t bytes_read = block_io_read_full( job->input_fd, data, job->chunk_size );
+
+		if ( bytes_read < 0 ) {
+			return FRAME_READ_FAILED;
+		}
+
+		size_t frame_length = encode_chunk( job, chunk, data, bytes_read, frame, stats );
+
+		if ( !block_io_write_all( job->output_fd, frame, frame_length ) ) {
+			return FRAME_WRITE_FAILED;
+		}
+
+		*original_length += bytes_read;
+
+		if ( ( size_t ) bytes_read < job->chunk_size ) {
+			return FRAME_OK;
+		}
+	}
+}
+
+// Description:
+// Reads the chunks in order, checking and decoding each and writing its original data after the last.
+//
+// Parameters:
+// FrameJob *job - The job.
+// uint8_t *data - A buffer for a chunk of original data.
+// uint8_t *frame - A buffer for a chunk as it's laid out in the container.
+// uint64_t *original_length - Where to put the number of bytes of original data.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// FRAME_FAILURE - FRAME_OK, or what went wrong.
+static FRAME_FAILURE decode_stream( FrameJob *job, uint8_t *data, uint8_t *frame, uint64_t *original_length, CodecStats *stats ) {
+	*original_length = 0;
+
+	for ( uint64_t chunk = 0;; chunk++ ) {
+		ssize_t bytes_read = block_io_read_full( job->input_fd, frame, FRAME_IO_CHUNK_HEADER_SIZE );
+		size_t data_length = 0;
+
+		if ( bytes_read < 0 ) {
+			return FRAME_READ_FAILED;
+		}
+
+		if ( bytes_read < FRAME_IO_CHUNK_HEADER_SIZE ) {
+			return FRAME_TRUNCATED;
+		}
+
+		if ( !parse_chunk_header( job, chunk, frame, &data_length ) ) {
+			return FRAME_CORRUPT;
+		}
+
+		size_t body_length = frame_length_of( job, data_length ) - FRAME_IO_CHUNK_HEADER_SIZE;
+		bytes_read = block_io_read_full( job->input_fd, frame + FRAME_IO_CHUNK_HEADER_SIZE, body_length );
+
+		if ( bytes_read < 0 ) {
+			return FRAME_READ_FAILED;
+		}
+
+		if ( ( size_t ) bytes_read < body_length ) {
+			return FRAME_TRUNCATED;
+		}
+
+		decode_chunk( job, frame, data_length, data, stats );
+
+		if ( !block_io_write_all( job->output_fd, data, data_length ) ) {
+			return FRAME_WRITE_FAILED;
+		}
+
+		*original_length += data_length;
+
+		if ( data_length < job->chunk_size ) {
+			return FRAME_OK;
+		}
+	}
+}
+
+// Description:
+// Prints how many decoded chunks didn't match their checksum, if any, and adds them to the statistics, so the caller
+// can still report the rest of the statistics before failing.
+//
+// Parameters:
+// FrameJob *job - The finished job.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// Nothing.
+static void report_checksums( FrameJob *job, CodecStats *stats ) {
+	uint64_t checksum_failures = atomic_load( &job->checksum_failures );
+
+	if ( checksum_failures > 0 ) {
+		fprintf( stderr, "Error: CRC-32C check failed in %" PRIu64 " chunk(s).\n", checksum_failures );
+		stats->checksum_failures += checksum_failures;
+	}
+}
+
+// Description:
+// Sets up a job, with everything but the number of chunks and the original length.
+//
+// Parameters:
+// FrameJob *job - The job to set up.
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The codec to run over each chunk.
+// bool encoding - Whether the codec encodes original data into codes.
+// const FrameHeader *header - The container's file header, which gives the chunk size and the optional parts of each chunk.
+//
+// Returns:
+// Nothing.
+static void init_job( FrameJob *job, FILE *input_file, FILE *output_file, const BlockCodec *codec, bool encoding, const FrameHeader *header ) {
+	job->codec = codec;
+	job->encoding = encoding;
+	job->data_unit = encoding ? codec->in_unit : codec->out_unit;
+	job->code_unit = encoding ? codec->out_unit : codec->in_unit;
+	job->chunk_size = header->chunk_size;
+	job->trailer_size = header->flags & FRAME_IO_FLAG_CRC32C ? FRAME_IO_CHECKSUM_SIZE : 0;
+	job->frame_size = frame_length_of( job, job->chunk_size );
+	job->input_fd = fileno( input_file );
+	job->output_fd = fileno( output_file );
+	job->input_base = lseek( job->input_fd, 0, SEEK_CUR );
+	job->output_base = lseek( job->output_fd, 0, SEEK_CUR );
+	job->original_length = 0;
+	job->chunks = 0;
+	atomic_init( &job->next_chunk, 0 );
+	atomic_init( &job->failure, FRAME_OK );
+	atomic_init( &job->checksum_failures, 0 );
+}
+
+// Description:
+// Prints the error message of a failure.
+//
+// Parameters:
+// FRAME_FAILURE failure - The failure.
+//
+// Returns:
+// bool - Whether there was no failure.
+static bool report_failure( FRAME_FAILURE failure ) {
+	switch ( failure ) {
+	case FRAME_OK: return true;
+	case FRAME_READ_FAILED: fprintf( stderr, "Error: failed to read from input file.\n" ); break;
+	case FRAME_WRITE_FAILED: fprintf( stderr, "Error: failed to write to output file.\n" ); break;
+	case FRAME_TRUNCATED: fprintf( stderr, "Error: container is truncated.\n" ); break;
+	case FRAME_CORRUPT: fprintf( stderr, "Error: container has a corrupt chunk header.\n" ); break;
+	}
+
+	return false;
+}
+
+// Description:
+// Encodes the input file into a container: a file header, then chunks of chunk_size bytes of original data, each
+// encoded and preceded by a chunk header with its index, its length, and its code length. With FRAME_IO_FLAG_CRC32C,
+// the codes are followed by the CRC-32C of the chunk's data, computed while the data is still in the cache from being
+// encoded. The last chunk is the first one with less than chunk_size bytes, which may be none. When the input is a
+// regular file, its length goes in the file header up front, and with several threads and a regular output file, each
+// worker encodes chunks at their offsets. Otherwise, chunks are encoded in order, and the length is filled in at the
+// end if the output file is seekable.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The encoder. Trailing partial units are zero-padded. Must be safe to call from several threads at once.
+// FrameHeader *header - The header to write, with the code, chunk size, and flags set. The chunk size must be a whole number of
+// the codec's input units. The original length is set.
+// uint32_t threads - The number of threads to encode with.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, encoded, and written to the output file.
+bool frame_io_encode( FILE *input_file, FILE *output_file, const BlockCodec *codec, FrameHeader *header, uint32_t threads, CodecStats *stats ) {
+	uint8_t header_bytes[ FRAME_IO_HEADER_SIZE ];
+	struct stat input_stats;
+	FrameJob job;
+
+	fflush( output_file ); // Nothing written through stdio may end up after the container.
+	init_job( &job, input_file, output_file, codec, true, header );
+	header->original_length = FRAME_IO_UNKNOWN_LENGTH;
+
+	if ( job.input_base >= 0 && fstat( job.input_fd, &input_stats ) == 0 && S_ISREG( input_stats.st_mode ) ) {
+		header->original_length = input_stats.st_size > job.input_base ? input_stats.st_size - job.input_base : 0;
+	}
+
+	build_header( header, header_bytes );
+
+	if ( !block_io_write_all( job.output_fd, header_bytes, sizeof( header_bytes ) ) ) {
+		return report_failure( FRAME_WRITE_FAILED );
+	}
+
+	if ( threads > 1 && header->original_length != FRAME_IO_UNKNOWN_LENGTH && parallel_io_is_positional( job.input_fd, job.output_fd ) ) {
+		job.original_length = header->original_length;
+		job.chunks = job.original_length / job.chunk_size + 1;
+		FRAME_FAILURE failure = run_workers( &job, threads, stats );
+
+		if ( failure == FRAME_OK ) {
+			// Leave both files positioned after the data, as if it had been streamed.
+			lseek( job.input_fd, job.input_base + job.original_length, SEEK_SET );
+			lseek( job.output_fd, job.output_base + FRAME_IO_HEADER_SIZE + ( job.chunks - 1 ) * job.frame_size + frame_length_of( &job, data_length_of( &job, job.chunks - 1 ) ), SEEK_SET );
+		}
+
+		return report_failure( failure );
+	}
+
+	uint8_t *data = malloc( job.chunk_size );
+	uint8_t *frame = malloc( job.frame_size );
+	uint64_t original_length = 0;
+	FRAME_FAILURE failure = FRAME_OK;
+
+	if ( !data || !frame ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+		free( frame );
+		free( data );
+
+		return false;
+	}
+
+	failure = encode_stream( &job, data, frame, &original_length, stats );
+	free( frame );
+	free( data );
+
+	if ( failure == FRAME_OK && header->original_length == FRAME_IO_UNKNOWN_LENGTH && job.output_base >= 0 ) {
+		header->original_length = original_length;
+		build_header( header, header_bytes );
+
+		if ( !block_io_pwrite_all( job.output_fd, header_bytes, sizeof( header_bytes ), job.output_base ) ) {
+			failure = FRAME_WRITE_FAILED;
+		}
+	}
+
+	return report_failure( failure );
+}
+
+// Description:
+// Decodes a container whose file header was read, writing exactly the original data. Every chunk header is checked
+// against the chunk's position, and a container that ends early is reported as truncated. When the container has
+// checksums, each chunk's decoded data is checked against its checksum right after it's decoded, and the chunks that
+// don't match are reported at the end. When the original length is known and both files are regular files, each of
+// several threads decodes chunks at their offsets. Otherwise, chunks are decoded in order.
+//
+// Parameters:
+// FILE *input_file - The file to read from, positioned after the file header.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The decoder of the container's code. Must be safe to call from several threads at once.
+// const FrameHeader *header - The container's file header.
+// uint32_t threads - The number of threads to decode with.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the container could be read, decoded, and written to the output file. Chunks that don't match their
+// checksum are counted in the statistics instead.
+bool frame_io_decode( FILE *input_file, FILE *output_file, const BlockCodec *codec, const FrameHeader *header, uint32_t threads, CodecStats *stats ) {
+	FrameJob job;
+
+	if ( header->chunk_size % codec->out_unit != 0 ) {
+		fprintf( stderr, "Error: invalid container header.\n" );
+
+		return false;
+	}
+
+	fflush( output_file );
+	init_job( &job, input_file, output_file, codec, false, header );
+	stats->total_bytes_processed += FRAME_IO_HEADER_SIZE;
+
+	if ( threads > 1 && header->original_length != FRAME_IO_UNKNOWN_LENGTH && parallel_io_is_positional( job.input_fd, job.output_fd ) ) {
+		job.original_length = header->original_length;
+		job.chunks = job.original_length / job.chunk_size + 1;
+		FRAME_FAILURE failure = run_workers( &job, threads, stats );
+
+		if ( failure == FRAME_OK ) {
+			lseek( job.input_fd, job.input_base + ( job.chunks - 1 ) * job.frame_size + frame_length_of( &job, data_length_of( &job, job.chunks - 1 ) ), SEEK_SET );
+			lseek( job.output_fd, job.output_base + job.original_length, SEEK_SET );
+		}
+
+		report_checksums( &job, stats );
+
+		return report_failure( failure );
+	}
+
+	uint8_t *data = malloc( job.chunk_size );
+	uint8_t *frame = malloc( job.frame_size );
+	uint64_t original_length = 0;
+	FRAME_FAILURE failure = FRAME_OK;
+
+	if ( !data || !frame ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+		free( frame );
+		free( data );
+
+		return false;
+	}
+
+	failure = decode_stream( &job, data, frame, &original_length, stats );
+	free( frame );
+	free( data );
+
+	if ( failure == FRAME_OK && header->original_length != FRAME_IO_UNKNOWN_LENGTH && original_length != header->original_length ) {
+		failure = FRAME_CORRUPT;
+	}
+
+	report_checksums( &job, stats );
+
+	return report_failure( failure );
+}
+
+// Description:
+// Decodes the part of a range of original data that lies in one chunk, reading only the chunk header and the codes of
+// the units overlapping the range.
+//
+// Parameters:
+// FrameJob *job - The job, with the original length set, which may be FRAME_IO_UNKNOWN_LENGTH.
+// uint64_t chunk - The index of the chunk.
+// size_t skip - The number of bytes of the chunk's original data before the range.
+// uint64_t length - The number of bytes left in the range.
+// uint8_t *data - A buffer for a chunk of original data.
+// uint8_t *frame - A buffer for a chunk as it's laid out in the container.
+// size_t *decoded - Where to put the number of bytes of the range written.
+// bool *last - Where to put whether the chunk was the last one.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// FRAME_FAILURE - FRAME_OK, or what went wrong.
+static FRAME_FAILURE decode_range_chunk( FrameJob *job, uint64_t chunk, size_t skip, uint64_t length, uint8_t *data, uint8_t *frame, size_t *decoded, bool *last, CodecStats *stats ) {
+	off_t frame_offset = job->input_base + chunk * job->frame_size;
+	ssize_t bytes_read = block_io_pread_full( job->input_fd, frame, FRAME_IO_CHUNK_HEADER_SIZE, frame_offset );
+	size_t data_length = 0;
+	*decoded = 0;
+	*last = true;
+
+	if ( bytes_read < 0 ) {
+		return FRAME_READ_FAILED;
+	}
+
+	// Without the original length, the end of the file after a full chunk is the only sign that there are no more.
+	if ( bytes_read == 0 && job->original_length == FRAME_IO_UNKNOWN_LENGTH ) {
+		return FRAME_OK;
+	}
+
+	if ( bytes_read < FRAME_IO_CHUNK_HEADER_SIZE ) {
+		return FRAME_TRUNCATED;
+	}
+
+	if ( !parse_chunk_header( job, chunk, frame, &data_length ) ) {
+		return FRAME_CORRUPT;
+	}
+
+	*last = data_length < job->chunk_size;
+
+	if ( skip >= data_length ) {
+		return FRAME_OK;
+	}
+
+	size_t end = length < data_length - skip ? skip + length : data_length;
+	size_t first_unit = skip / job->data_unit;
+	size_t units = ( end + job->data_unit - 1 ) / job->data_unit - first_unit;
+	size_t code_length = units * job->code_unit;
+	// The checksum covers the whole chunk, so it's only checked when the whole chunk is in the range.
+	bool whole_chunk = skip == 0 && end == data_length;
+	size_t body_length = code_length + ( whole_chunk ? job->trailer_size : 0 );
+	bytes_read = block_io_pread_full( job->input_fd, frame + FRAME_IO_CHUNK_HEADER_SIZE, body_length, frame_offset + FRAME_IO_CHUNK_HEADER_SIZE + first_unit * job->code_unit );
+
+	if ( bytes_read < 0 ) {
+		return FRAME_READ_FAILED;
+	}
+
+	if ( ( size_t ) bytes_read < body_length ) {
+		return FRAME_TRUNCATED;
+	}
+
+	if ( whole_chunk ) {
+		decode_chunk( job, frame, data_length, data, stats );
+	} else {
+		job->codec->process( frame + FRAME_IO_CHUNK_HEADER_SIZE, data, units, stats );
+		stats->total_bytes_processed += FRAME_IO_CHUNK_HEADER_SIZE + code_length;
+	}
+
+	if ( !block_io_write_all( job->output_fd, data + skip - first_unit * job->data_unit, end - skip ) ) {
+		return FRAME_WRITE_FAILED;
+	}
+
+	*decoded = end - skip;
+
+	return FRAME_OK;
+}
+
+// Description:
+// Decodes a range of the original data of a container whose file header was read. Since every chunk but the last has
+// the same size, the chunks overlapping the range are found from its offset, and only their headers and the codes of
+// the units overlapping the range are read with pread(2). A range running past the end of the data is cut short.
+//
+// Parameters:
+// FILE *input_file - The file to read from, positioned after the file header. Must be seekable.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The decoder of the container's code.
+// const FrameHeader *header - The container's file header.
+// uint64_t offset - The offset of the range in the original data.
+// uint64_t length - The number of bytes in the range, or UINT64_MAX to run to the end.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the range could be read, decoded, and written to the output file. Chunks that don't match their
+// checksum are counted in the statistics instead.
+bool frame_io_decode_range( FILE *input_file, FILE *output_file, const BlockCodec *codec, const FrameHeader *header, uint64_t offset, uint64_t length, CodecStats *stats ) {
+	FrameJob job;
+
+	if ( header->chunk_size % codec->out_unit != 0 ) {
+		fprintf( stderr, "Error: invalid container header.\n" );
+
+		return false;
+	}
+
+	fflush( output_file );
+	init_job( &job, input_file, output_file, codec, false, header );
+	job.original_length = header->original_length;
+	stats->total_bytes_processed += FRAME_IO_HEADER_SIZE;
+
+	if ( job.input_base < 0 ) {
+		fprintf( stderr, "Error: --offset and --length need a seekable infile.\n" );
+
+		return false;
+	}
+
+	if ( job.original_length != FRAME_IO_UNKNOWN_LENGTH ) {
+		uint64_t available = offset < job.original_length ? job.original_length - offset : 0;
+		length = length < available ? length : available;
+	}
+
+	uint8_t *data = malloc( job.chunk_size );
+	uint8_t *frame = malloc( job.frame_size );
+	uint64_t chunk = offset / job.chunk_size;
+	size_t skip = offset % job.chunk_size;
+	FRAME_FAILURE failure = FRAME_OK;
+
+	if ( !data || !frame ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+		free( frame );
+		free( data );
+
+		return false;
+	}
+
+	while ( failure == FRAME_OK && length > 0 ) {
+		size_t decoded = 0;
+		bool last = true;
+		failure = decode_range_chunk( &job, chunk, skip, length, data, frame, &decoded, &last, stats );
+		length -= decoded;
+
+		if ( failure == FRAME_OK && last && length > 0 && job.original_length != FRAME_IO_UNKNOWN_LENGTH ) {
+			failure = FRAME_CORRUPT; // The chunks hold less data than the file header says.
+		}
+
+		if ( last ) {
+			break;
+		}
+
+		chunk++;
+		skip = 0;
+	}
+
+	free( frame );
+	free( data );
+
+	report_checksums( &job, stats );
+
+	return report_failure( failure );
+}
@@ -0,0 +1,46 @@
+#ifndef __FRAME_IO_H__
+#define __FRAME_IO_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define FRAME_IO_HEADER_SIZE       32 // Size in bytes of the file header.
+#define FRAME_IO_CHUNK_HEADER_SIZE 16 // Size in bytes of the header in front of each chunk's codes.
+#define FRAME_IO_MAX_CHUNK_SIZE    ( 1 << 30 ) // Maximum number of bytes of original data in a chunk.
+#define FRAME_IO_UNKNOWN_LENGTH    UINT64_MAX // Original length stored when the input's length wasn't known up front.
+#define FRAME_IO_CHECKSUM_SIZE     4 // Size in bytes of the CRC-32C trailer after each chunk's codes.
+
+#define FRAME_IO_FLAG_CRC32C 1 // Each chunk's codes are followed by the CRC-32C of its original data.
+
+// Description:
+// The fields of a container's file header.
+//
+// Members:
+// uint32_t code_length - The number of bits in each codeword of the code the data was encoded with.
+// uint32_t message_length - The number of data bits in each codeword.
+// uint32_t chunk_size - The number of bytes of original data in each chunk but the last, which has fewer.
+// uint32_t flags - FRAME_IO_FLAG_ values of the optional parts of each chunk.
+// uint64_t original_length - The number of bytes of original data, or FRAME_IO_UNKNOWN_LENGTH.
+typedef struct FrameHeader {
+	uint32_t code_length;
+	uint32_t message_length;
+	uint32_t chunk_size;
+	uint32_t flags;
+	uint64_t original_length;
+} FrameHeader;
+
+size_t frame_io_chunk_size( size_t buffer_size, size_t data_unit );
+
+bool frame_io_read_header( FILE *input_file, FrameHeader *header );
+
+bool frame_io_encode( FILE *input_file, FILE *output_file, const BlockCodec *codec, FrameHeader *header, uint32_t threads, CodecStats *stats );
+
+bool frame_io_decode( FILE *input_file, FILE *output_file, const BlockCodec *codec, const FrameHeader *header, uint32_t threads, CodecStats *stats );
+
+bool frame_io_decode_range( FILE *input_file, FILE *output_file, const BlockCodec *codec, const FrameHeader *header, uint64_t offset, uint64_t length, CodecStats *stats );
+
+#endif
@@ -0,0 +1,66 @@
+#include "io_engine.h"
+
+#include "block_io.h"
+#include "mmap_io.h"
+#include "parallel_io.h"
+#include "pipe_io.h"
+#include "pipeline_io.h"
+#include "uring_io.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Description:
+// Sets the options used when none are given on the command line.
+//
+// Parameters:
+// IoOptions *options - The options to set.
+//
+// Returns:
+// Nothing.
+void io_engine_default_options( IoOptions *options ) {
+	options->buffer_size = BLOCK_IO_DEFAULT_BUFFER_SIZE;
+	options->threads = 1;
+	options->memory_map = false;
+	options->splice = false;
+	options->io_uring = false;
+}
+
+// Description:
+// Runs the codec over the input file and writes the result to the output file, using the fastest way to move the data
+// that the options allow and the files support.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The codec to run over the data.
+// const IoOptions *options - The options given on the command line.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, processed, and written to the output file.
+bool io_engine_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, const IoOptions *options, CodecStats *stats ) {
+	if ( options->memory_map && mmap_io_is_supported( input_file, output_file ) ) {
+		return mmap_io_process( input_file, output_file, codec, options->threads, stats );
+	}
+
+	if ( options->threads > 1 ) {
+		return parallel_io_process( input_file, output_file, codec, options->buffer_size, options->threads, stats );
+	}
+
+	if ( options->splice && pipe_io_is_supported( output_file ) ) {
+		return pipe_io_process( input_file, output_file, codec, options->buffer_size, stats );
+	}
+
+	if ( options->io_uring ) {
+		return uring_io_process( input_file, output_file, codec, options->buffer_size, stats );
+	}
+
+	// With one CPU, the reader and writer threads would only take turns with the codec.
+	if ( sysconf( _SC_NPROCESSORS_ONLN ) > 1 ) {
+		return pipeline_io_process( input_file, output_file, codec, options->buffer_size, stats );
+	}
+
+	return block_io_process( input_file, output_file, codec, options->buffer_size, stats );
+}
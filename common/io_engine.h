@@ -0,0 +1,23 @@
+#ifndef __IO_ENGINE_H__
+#define __IO_ENGINE_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct IoOptions {
+	size_t buffer_size; // Size of the input buffer in bytes, or of each chunk when using several threads.
+	uint32_t threads; // Number of threads to run the codec on.
+	bool memory_map; // Whether to memory-map the files when both are regular files.
+	bool splice; // Whether to splice the output into the output file when it's a pipe.
+	bool io_uring; // Whether to overlap reads and writes with processing using io_uring when the kernel supports it.
+} IoOptions;
+
+void io_engine_default_options( IoOptions *options );
+
+bool io_engine_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, const IoOptions *options, CodecStats *stats );
+
+#endif
@@ -0,0 +1,217 @@
+#include "mmap_io.h"
+
+#include "block_io.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Description:
+// A range of units for one thread to process between the mappings.
+//
+// Members:
+// pthread_t thread - The thread.
+// const BlockCodec *codec - The codec to run over the range.
+// const uint8_t *in - The start of the range in the input mapping.
+// uint8_t *out - The start of the range in the output mapping.
+// size_t units - The number of units in the range.
+// CodecStats stats - The statistics of the range, merged at the end.
+typedef struct MmapSlice {
+	pthread_t thread;
+	const BlockCodec *codec;
+	const uint8_t *in;
+	uint8_t *out;
+	size_t units;
+	CodecStats stats;
+} MmapSlice;
+
+// Description:
+// Checks whether the input and output files can be memory-mapped.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to. Must be open for reading as well as writing to be mapped.
+//
+// Returns:
+// bool - Whether both files are regular files that can be mapped.
+bool mmap_io_is_supported( FILE *input_file, FILE *output_file ) {
+	struct stat input_stats;
+	struct stat output_stats;
+
+	if ( fstat( fileno( input_file ), &input_stats ) != 0 || fstat( fileno( output_file ), &output_stats ) != 0 ) {
+		return false;
+	}
+
+	return S_ISREG( input_stats.st_mode ) && S_ISREG( output_stats.st_mode ) && ( fcntl( fileno( output_file ), F_GETFL ) & O_ACCMODE ) == O_RDWR;
+}
+
+// Description:
+// The entry point of a thread processing a slice.
+//
+// Parameters:
+// void *arg - The MmapSlice to process.
+//
+// Returns:
+// void * - Always NULL.
+static void *process_slice( void *arg ) {
+	MmapSlice *slice = arg;
+
+	if ( slice->units > 0 ) {
+		slice->codec->process( slice->in, slice->out, slice->units, &slice->stats );
+	}
+
+	return NULL;
+}
+
+// Description:
+// Runs the codec over the whole units of the input mapping, split across threads.
+//
+// Parameters:
+// const BlockCodec *codec - The codec to run.
+// const uint8_t *in - The input data.
+// uint8_t *out - The output data.
+// size_t units - The number of whole units in the input data.
+// uint32_t threads - The number of threads to split the units across.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the threads could be created.
+static bool process_mapping( const BlockCodec *codec, const uint8_t *in, uint8_t *out, size_t units, uint32_t threads, CodecStats *stats ) {
+	MmapSlice *slices = calloc( threads, sizeof( MmapSlice ) );
+	uint32_t started = 0;
+	bool success = true;
+
+	if ( !slices ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+
+		return false;
+	}
+
+	for ( uint32_t i = 0; i < threads; i++ ) {
+		size_t first_unit = units / threads * i;
+		slices[ i ].codec = codec;
+		slices[ i ].in = in + first_unit * codec->in_unit;
+		slices[ i ].out = out + first_unit * codec->out_unit;
+		slices[ i ].units = i + 1 < threads ? units / threads : units - first_unit;
+	}
+
+	// The last slice is processed on this thread.
+	for ( ; started + 1 < threads; started++ ) {
+		if ( pthread_create( &slices[ started ].thread, NULL, process_slice, &slices[ started ] ) != 0 ) {
+			fprintf( stderr, "Error: failed to create thread.\n" );
+			success = false;
+			break;
+		}
+	}
+
+	if ( success ) {
+		process_slice( &slices[ threads - 1 ] );
+	}
+
+	for ( uint32_t i = 0; i < started; i++ ) {
+		pthread_join( slices[ i ].thread, NULL );
+	}
+
+	for ( uint32_t i = 0; i < threads; i++ ) {
+		stats->uncorrectable_errors += slices[ i ].stats.uncorrectable_errors;
+		stats->corrected_errors += slices[ i ].stats.corrected_errors;
+	}
+
+	free( slices );
+
+	return success;
+}
+
+// Description:
+// Maps the input file, sizes and maps the output file, and runs the codec directly from one mapping to the other.
+// The data starts at the current offset of each file, and both files are left positioned after it.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to. Must be open for reading as well as writing.
+// const BlockCodec *codec - The codec to run over the data. Must be safe to call from several threads at once if threads > 1.
+// uint32_t threads - The number of threads to split the data across.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be mapped, processed, and written to the output file.
+bool mmap_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, uint32_t threads, CodecStats *stats ) {
+	int input_fd = fileno( input_file );
+	int output_fd = fileno( output_file );
+	struct stat input_stats;
+	fflush( output_file );
+
+	if ( fstat( input_fd, &input_stats ) != 0 ) {
+		fprintf( stderr, "Error: failed to read from input file.\n" );
+
+		return false;
+	}
+
+	off_t input_base = lseek( input_fd, 0, SEEK_CUR );
+	off_t output_base = lseek( output_fd, 0, SEEK_CUR );
+	size_t input_length = input_stats.st_size > input_base ? input_stats.st_size - input_base : 0;
+	size_t units = input_length / codec->in_unit;
+	size_t remainder = input_length % codec->in_unit;
+	size_t output_length = ( units + ( codec->pad_tail && remainder > 0 ) ) * codec->out_unit;
+
+	if ( ftruncate( output_fd, output_base + output_length ) != 0 ) {
+		fprintf( stderr, "Error: failed to write to output file.\n" );
+
+		return false;
+	}
+
+	uint8_t *input_map = NULL;
+	uint8_t *output_map = NULL;
+	bool success = true;
+
+	if ( output_length > 0 ) {
+		input_map = mmap( NULL, input_base + input_length, PROT_READ, MAP_SHARED, input_fd, 0 );
+		output_map = mmap( NULL, output_base + output_length, PROT_READ | PROT_WRITE, MAP_SHARED, output_fd, 0 );
+
+		if ( input_map == MAP_FAILED || output_map == MAP_FAILED ) {
+			fprintf( stderr, "Error: failed to map %s file.\n", input_map == MAP_FAILED ? "input" : "output" );
+			success = false;
+		} else {
+			madvise( input_map, input_base + input_length, MADV_SEQUENTIAL );
+			success = process_mapping( codec, input_map + input_base, output_map + output_base, units, threads, stats );
+		}
+	}
+
+	if ( success && codec->pad_tail && remainder > 0 ) {
+		// The last unit reaches past the end of the input mapping, so pad a copy of it.
+		uint8_t *tail = calloc( 1, codec->in_unit );
+
+		if ( tail ) {
+			memcpy( tail, input_map + input_base + units * codec->in_unit, remainder );
+			codec->process( tail, output_map + output_base + units * codec->out_unit, 1, stats );
+			free( tail );
+		} else {
+			fprintf( stderr, "Error: failed to allocate memory.\n" );
+			success = false;
+		}
+	}
+
+	if ( output_map && output_map != MAP_FAILED ) {
+		munmap( output_map, output_base + output_length );
+	}
+
+	if ( input_map && input_map != MAP_FAILED ) {
+		munmap( input_map, input_base + input_length );
+	}
+
+	if ( success ) {
+		stats->total_bytes_processed += input_length;
+		lseek( input_fd, input_base + input_length, SEEK_SET );
+		lseek( output_fd, output_base + output_length, SEEK_SET );
+	}
+
+	return success;
+}
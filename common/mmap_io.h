@@ -0,0 +1,14 @@
+#ifndef __MMAP_IO_H__
+#define __MMAP_IO_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+bool mmap_io_is_supported( FILE *input_file, FILE *output_file );
+
+bool mmap_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, uint32_t threads, CodecStats *stats );
+
+#endif
@@ -0,0 +1,435 @@
+#include "parallel_io.h"
+
+#include "block_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef enum PARALLEL_FAILURE {
+	PARALLEL_OK, // No failures.
+	PARALLEL_READ_FAILED, // A read from the input file failed.
+	PARALLEL_WRITE_FAILED, // A write to the output file failed.
+} PARALLEL_FAILURE;
+
+// Description:
+// State shared by the main thread and the workers.
+//
+// Members:
+// const BlockCodec *codec - The codec to run over the data.
+// size_t chunk_units - The number of units in each chunk.
+// int input_fd - The file descriptor to read from.
+// int output_fd - The file descriptor to write to.
+// bool positional - Whether workers read and write at their chunk's offsets themselves instead of being fed by the main thread.
+// off_t input_base - The offset in the input file the data starts at. Only used when positional.
+// off_t output_base - The offset in the output file the data starts at. Only used when positional.
+// uint64_t input_length - The number of bytes of input data. Only used when positional.
+// uint64_t chunks - The number of chunks in the input data. Only used when positional.
+// atomic_uint_fast64_t next_chunk - The next chunk for a worker to claim. Only used when positional.
+// atomic_int failure - The first PARALLEL_FAILURE a worker hit.
+// pthread_mutex_t lock - Guards the members below. Only used when not positional.
+// pthread_cond_t start - Signaled once the main thread has filled the workers' buffers. Only used when not positional.
+// pthread_cond_t finish - Signaled once the workers have processed their buffers. Only used when not positional.
+// uint64_t generation - Incremented each time the workers' buffers are filled. Only used when not positional.
+// uint32_t pending - The number of workers still processing the current generation. Only used when not positional.
+// bool done - Whether the workers should exit. Only used when not positional.
+typedef struct ParallelJob {
+	const BlockCodec *codec;
+	size_t chunk_units;
+	int input_fd;
+	int output_fd;
+	bool positional;
+	off_t input_base;
+	off_t output_base;
+	uint64_t input_length;
+	uint64_t chunks;
+	atomic_uint_fast64_t next_chunk;
+	atomic_int failure;
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t finish;
+	uint64_t generation;
+	uint32_t pending;
+	bool done;
+} ParallelJob;
+
+// Description:
+// A worker thread and the buffers it owns.
+//
+// Members:
+// pthread_t thread - The thread.
+// ParallelJob *job - The shared job state.
+// uint8_t *input_buffer - The chunk being processed.
+// uint8_t *output_buffer - The result of processing the chunk.
+// size_t input_length - The number of bytes in the input buffer.
+// size_t output_length - The number of bytes in the output buffer.
+// CodecStats stats - The statistics of the chunks processed by this worker, merged at the end.
+typedef struct ParallelWorker {
+	pthread_t thread;
+	ParallelJob *job;
+	uint8_t *input_buffer;
+	uint8_t *output_buffer;
+	size_t input_length;
+	size_t output_length;
+	CodecStats stats;
+} ParallelWorker;
+
+// Description:
+// Parses a thread count given on the command line.
+//
+// Parameters:
+// const char *str - The string to parse.
+// uint32_t *threads - Where to put the thread count. Will be unmodified upon failure.
+//
+// Returns:
+// bool - Whether the string was a thread count between 1 and PARALLEL_IO_MAX_THREADS.
+bool parallel_io_parse_threads( const char *str, uint32_t *threads ) {
+	char *end = NULL;
+	errno = 0;
+	long value = strtol( str, &end, 10 );
+
+	if ( errno || end == str || *end != '\0' || value < 1 || value > PARALLEL_IO_MAX_THREADS ) {
+		return false;
+	}
+
+	*threads = value;
+
+	return true;
+}
+
+// Description:
+// Runs the codec over a chunk, zero-padding a trailing partial unit if the codec wants it.
+//
+// Parameters:
+// const BlockCodec *codec - The codec to run.
+// uint8_t *input_buffer - The chunk. Must have room to pad the last unit.
+// size_t input_length - The number of bytes in the chunk.
+// uint8_t *output_buffer - Where to put the result.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// size_t - The number of bytes put in the output buffer.
+static size_t process_chunk( const BlockCodec *codec, uint8_t *input_buffer, size_t input_length, uint8_t *output_buffer, CodecStats *stats ) {
+	size_t units = input_length / codec->in_unit;
+	size_t remainder = input_length % codec->in_unit;
+
+	if ( codec->pad_tail && remainder > 0 ) {
+		memset( input_buffer + input_length, 0, codec->in_unit - remainder );
+		units++;
+	}
+
+	if ( units > 0 ) {
+		codec->process( input_buffer, output_buffer, units, stats );
+	}
+
+	stats->total_bytes_processed += input_length;
+
+	return units * codec->out_unit;
+}
+
+// Description:
+// Records a failure unless another one was recorded first.
+//
+// Parameters:
+// ParallelJob *job - The job that failed.
+// PARALLEL_FAILURE failure - The failure.
+//
+// Returns:
+// Nothing.
+static void record_failure( ParallelJob *job, PARALLEL_FAILURE failure ) {
+	int expected = PARALLEL_OK;
+	atomic_compare_exchange_strong( &job->failure, &expected, failure );
+}
+
+// Description:
+// Claims chunks until none are left, reading each from and writing each to its offset.
+//
+// Parameters:
+// ParallelWorker *worker - The worker.
+//
+// Returns:
+// Nothing.
+static void run_positional( ParallelWorker *worker ) {
+	ParallelJob *job = worker->job;
+	size_t chunk_size = job->chunk_units * job->codec->in_unit;
+
+	while ( atomic_load( &job->failure ) == PARALLEL_OK ) {
+		uint64_t chunk = atomic_fetch_add( &job->next_chunk, 1 );
+
+		if ( chunk >= job->chunks ) {
+			break;
+		}
+
+		uint64_t offset = chunk * chunk_size;
+		size_t length = job->input_length - offset < chunk_size ? job->input_length - offset : chunk_size;
+
+		if ( block_io_pread_full( job->input_fd, worker->input_buffer, length, job->input_base + offset ) != ( ssize_t ) length ) {
+			record_failure( job, PARALLEL_READ_FAILED );
+			break;
+		}
+
+		size_t output_length = process_chunk( job->codec, worker->input_buffer, length, worker->output_buffer, &worker->stats );
+
+		if ( !block_io_pwrite_all( job->output_fd, worker->output_buffer, output_length, job->output_base + chunk * job->chunk_units * job->codec->out_unit ) ) {
+			record_failure( job, PARALLEL_WRITE_FAILED );
+			break;
+		}
+	}
+}
+
+// Description:
+// Processes the chunk the main thread put in the worker's buffer each time the buffers are filled, until told to exit.
+//
+// Parameters:
+// ParallelWorker *worker - The worker.
+//
+// Returns:
+// Nothing.
+static void run_fed( ParallelWorker *worker ) {
+	ParallelJob *job = worker->job;
+	uint64_t generation = 0;
+
+	for ( ;; ) {
+		pthread_mutex_lock( &job->lock );
+
+		while ( !job->done && job->generation == generation ) {
+			pthread_cond_wait( &job->start, &job->lock );
+		}
+
+		generation = job->generation;
+		bool done = job->done;
+		pthread_mutex_unlock( &job->lock );
+
+		if ( done ) {
+			break;
+		}
+
+		worker->output_length = process_chunk( job->codec, worker->input_buffer, worker->input_length, worker->output_buffer, &worker->stats );
+		pthread_mutex_lock( &job->lock );
+
+		if ( --job->pending == 0 ) {
+			pthread_cond_signal( &job->finish );
+		}
+
+		pthread_mutex_unlock( &job->lock );
+	}
+}
+
+// Description:
+// The entry point of a worker thread.
+//
+// Parameters:
+// void *arg - The ParallelWorker the thread runs as.
+//
+// Returns:
+// void * - Always NULL.
+static void *worker_main( void *arg ) {
+	ParallelWorker *worker = arg;
+
+	if ( worker->job->positional ) {
+		run_positional( worker );
+	} else {
+		run_fed( worker );
+	}
+
+	return NULL;
+}
+
+// Description:
+// Checks whether both files are regular files that workers can read and write at any offset.
+//
+// Parameters:
+// int input_fd - The input file descriptor.
+// int output_fd - The output file descriptor.
+//
+// Returns:
+// bool - Whether positional I/O can be used.
+bool parallel_io_is_positional( int input_fd, int output_fd ) {
+	struct stat input_stats;
+	struct stat output_stats;
+
+	if ( fstat( input_fd, &input_stats ) != 0 || fstat( output_fd, &output_stats ) != 0 ) {
+		return false;
+	}
+
+	// Appending writes ignore the offset given to pwrite.
+	return S_ISREG( input_stats.st_mode ) && S_ISREG( output_stats.st_mode ) && !( fcntl( output_fd, F_GETFL ) & O_APPEND );
+}
+
+// Description:
+// Feeds chunks to the workers from the main thread and writes their results in order.
+//
+// Parameters:
+// ParallelJob *job - The job.
+// ParallelWorker *workers - The workers.
+// uint32_t threads - The number of workers.
+//
+// Returns:
+// Nothing. Failures are recorded in the job.
+static void feed_workers( ParallelJob *job, ParallelWorker *workers, uint32_t threads ) {
+	size_t chunk_size = job->chunk_units * job->codec->in_unit;
+	bool end_of_file = false;
+
+	while ( !end_of_file ) {
+		for ( uint32_t i = 0; i < threads; i++ ) {
+			ssize_t bytes_read = end_of_file ? 0 : block_io_read_full( job->input_fd, workers[ i ].input_buffer, chunk_size );
+
+			if ( bytes_read < 0 ) {
+				record_failure( job, PARALLEL_READ_FAILED );
+
+				return;
+			}
+
+			workers[ i ].input_length = bytes_read;
+			end_of_file = end_of_file || ( size_t ) bytes_read < chunk_size;
+		}
+
+		pthread_mutex_lock( &job->lock );
+		job->pending = threads;
+		job->generation++;
+		pthread_cond_broadcast( &job->start );
+
+		while ( job->pending > 0 ) {
+			pthread_cond_wait( &job->finish, &job->lock );
+		}
+
+		pthread_mutex_unlock( &job->lock );
+
+		for ( uint32_t i = 0; i < threads; i++ ) {
+			if ( !block_io_write_all( job->output_fd, workers[ i ].output_buffer, workers[ i ].output_length ) ) {
+				record_failure( job, PARALLEL_WRITE_FAILED );
+
+				return;
+			}
+		}
+	}
+}
+
+// Description:
+// Splits the input into chunks, runs the codec over them on a pool of worker threads, and writes the results in order.
+// When both files are regular files, each worker reads and writes its chunks at their offsets. Otherwise, the main thread
+// reads a chunk for each worker, waits for all of them, and writes their results.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The codec to run over the data. Must be safe to call from several threads at once.
+// size_t chunk_size - The size of each chunk in bytes. Rounded down to a whole number of units.
+// uint32_t threads - The number of worker threads.
+// CodecStats *stats - The statistics to add the merged statistics of every worker to.
+//
+// Returns:
+// bool - Whether the data could be read, processed, and written to the output file.
+bool parallel_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t chunk_size, uint32_t threads, CodecStats *stats ) {
+	ParallelJob job;
+	ParallelWorker *workers = calloc( threads, sizeof( ParallelWorker ) );
+	uint32_t started = 0;
+	bool success = true;
+
+	job.codec = codec;
+	job.chunk_units = chunk_size / codec->in_unit > 0 ? chunk_size / codec->in_unit : 1;
+	job.input_fd = fileno( input_file );
+	job.output_fd = fileno( output_file );
+	job.positional = parallel_io_is_positional( job.input_fd, job.output_fd );
+	job.input_base = 0;
+	job.output_base = 0;
+	job.input_length = 0;
+	job.chunks = 0;
+	atomic_init( &job.next_chunk, 0 );
+	atomic_init( &job.failure, PARALLEL_OK );
+	job.done = false;
+
+	fflush( output_file );
+
+	if ( job.positional ) {
+		struct stat input_stats;
+		fstat( job.input_fd, &input_stats );
+		job.input_base = lseek( job.input_fd, 0, SEEK_CUR );
+		job.output_base = lseek( job.output_fd, 0, SEEK_CUR );
+		job.input_length = input_stats.st_size > job.input_base ? input_stats.st_size - job.input_base : 0;
+		job.chunks = ( job.input_length + job.chunk_units * codec->in_unit - 1 ) / ( job.chunk_units * codec->in_unit );
+	} else {
+		pthread_mutex_init( &job.lock, NULL );
+		pthread_cond_init( &job.start, NULL );
+		pthread_cond_init( &job.finish, NULL );
+		job.generation = 0;
+		job.pending = 0;
+	}
+
+	for ( uint32_t i = 0; workers && i < threads; i++ ) {
+		workers[ i ].job = &job;
+		workers[ i ].input_buffer = malloc( job.chunk_units * codec->in_unit );
+		workers[ i ].output_buffer = malloc( job.chunk_units * codec->out_unit );
+
+		if ( !workers[ i ].input_buffer || !workers[ i ].output_buffer ) {
+			success = false;
+		}
+	}
+
+	if ( !workers || !success ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+		success = false;
+	}
+
+	for ( ; success && started < threads; started++ ) {
+		if ( pthread_create( &workers[ started ].thread, NULL, worker_main, &workers[ started ] ) != 0 ) {
+			fprintf( stderr, "Error: failed to create thread.\n" );
+			success = false;
+			break;
+		}
+	}
+
+	if ( !job.positional ) {
+		if ( success ) {
+			feed_workers( &job, workers, threads );
+		}
+
+		pthread_mutex_lock( &job.lock );
+		job.done = true;
+		pthread_cond_broadcast( &job.start );
+		pthread_mutex_unlock( &job.lock );
+	}
+
+	for ( uint32_t i = 0; i < started; i++ ) {
+		pthread_join( workers[ i ].thread, NULL );
+	}
+
+	if ( success && atomic_load( &job.failure ) != PARALLEL_OK ) {
+		fprintf( stderr, atomic_load( &job.failure ) == PARALLEL_READ_FAILED ? "Error: failed to read from input file.\n" : "Error: failed to write to output file.\n" );
+		success = false;
+	}
+
+	if ( success && job.positional ) {
+		// Leave both files positioned after the data, as if it had been streamed.
+		uint64_t output_length = job.input_length / codec->in_unit * codec->out_unit + ( codec->pad_tail && job.input_length % codec->in_unit ? codec->out_unit : 0 );
+		lseek( job.input_fd, job.input_base + job.input_length, SEEK_SET );
+		lseek( job.output_fd, job.output_base + output_length, SEEK_SET );
+	}
+
+	for ( uint32_t i = 0; workers && i < threads; i++ ) {
+		stats->total_bytes_processed += workers[ i ].stats.total_bytes_processed;
+		stats->uncorrectable_errors += workers[ i ].stats.uncorrectable_errors;
+		stats->corrected_errors += workers[ i ].stats.corrected_errors;
+		free( workers[ i ].output_buffer );
+		free( workers[ i ].input_buffer );
+	}
+
+	if ( !job.positional ) {
+		pthread_cond_destroy( &job.finish );
+		pthread_cond_destroy( &job.start );
+		pthread_mutex_destroy( &job.lock );
+	}
+
+	free( workers );
+
+	return success;
+}
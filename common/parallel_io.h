@@ -0,0 +1,19 @@
+#ifndef __PARALLEL_IO_H__
+#define __PARALLEL_IO_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define PARALLEL_IO_MAX_THREADS 256 // Maximum number of worker threads.
+
+bool parallel_io_parse_threads( const char *str, uint32_t *threads );
+
+bool parallel_io_is_positional( int input_fd, int output_fd );
+
+bool parallel_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t chunk_size, uint32_t threads, CodecStats *stats );
+
+#endif
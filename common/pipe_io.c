@@ -0,0 +1,207 @@
+#define _GNU_SOURCE // For vmsplice and F_SETPIPE_SZ.
+
+#include "pipe_io.h"
+
+#include "block_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined( __linux__ ) && defined( F_SETPIPE_SZ ) && defined( SPLICE_F_GIFT )
+#define PIPE_IO_AVAILABLE // Whether vmsplice can be used.
+#endif
+
+// Description:
+// Checks whether the output file is a pipe that output buffers can be spliced into.
+//
+// Parameters:
+// FILE *output_file - The file to write to.
+//
+// Returns:
+// bool - Whether the output file is a pipe and vmsplice is available.
+bool pipe_io_is_supported( FILE *output_file ) {
+#ifdef PIPE_IO_AVAILABLE
+	struct stat output_stats;
+
+	return fstat( fileno( output_file ), &output_stats ) == 0 && S_ISFIFO( output_stats.st_mode );
+#else
+	( void ) output_file;
+
+	return false;
+#endif
+}
+
+#ifdef PIPE_IO_AVAILABLE
+// Description:
+// Grows a pipe to hold a number of bytes, as far as the system allows.
+//
+// Parameters:
+// int fd - A file descriptor of the pipe.
+// size_t size - The size to grow the pipe to in bytes.
+//
+// Returns:
+// size_t - The size of the pipe in bytes, or 0 if it isn't a pipe.
+static size_t grow_pipe( int fd, size_t size ) {
+	int current = fcntl( fd, F_GETPIPE_SZ );
+
+	if ( current > 0 && ( size_t ) current < size ) {
+		// Unprivileged processes can't grow pipes past /proc/sys/fs/pipe-max-size, so try halving the size until it fits.
+		for ( size_t attempt = size < INT32_MAX ? size : INT32_MAX; attempt > ( size_t ) current; attempt /= 2 ) {
+			if ( fcntl( fd, F_SETPIPE_SZ, ( int ) attempt ) >= 0 ) {
+				break;
+			}
+		}
+
+		current = fcntl( fd, F_GETPIPE_SZ );
+	}
+
+	return current > 0 ? current : 0;
+}
+
+// Description:
+// Moves a whole buffer's pages into a pipe with vmsplice, retrying on short transfers and interrupts.
+//
+// Parameters:
+// int fd - A file descriptor of the pipe.
+// uint8_t *buffer - The data to splice. Must be page-aligned and left unmodified until the reader has copied it out.
+// size_t length - The number of bytes to splice.
+//
+// Returns:
+// bool - Whether the whole buffer was spliced.
+static bool splice_all( int fd, uint8_t *buffer, size_t length ) {
+	struct iovec iov = { buffer, length };
+
+	while ( iov.iov_len > 0 ) {
+		ssize_t spliced = vmsplice( fd, &iov, 1, SPLICE_F_GIFT );
+
+		if ( spliced < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+
+			return false;
+		}
+
+		iov.iov_base = ( uint8_t * ) iov.iov_base + spliced;
+		iov.iov_len -= spliced;
+	}
+
+	return true;
+}
+#endif
+
+// Description:
+// Reads the input file in blocks, runs the codec over each block, and splices the result into the output pipe, so the
+// output isn't copied into the kernel. The pipes are grown first. The output alternates between two page-aligned
+// buffers of the size of the output pipe, so once one buffer is fully spliced, every page of the other has been read
+// out of the pipe, and it can be reused. Like any vmsplice user, this needs the reader to copy the data out of the pipe
+// with read, not move its pages on with splice or tee. Blocks are only spliced when they fill the pipe, so a short last
+// block is written instead.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The pipe to write to.
+// const BlockCodec *codec - The codec to run over the data.
+// size_t buffer_size - The requested size of the input buffer in bytes. The output pipe is grown to fit its result.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, processed, and written to the output pipe.
+bool pipe_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t buffer_size, CodecStats *stats ) {
+#ifdef PIPE_IO_AVAILABLE
+	int input_fd = fileno( input_file );
+	int output_fd = fileno( output_file );
+	size_t page_size = sysconf( _SC_PAGESIZE );
+	size_t requested_units = buffer_size / codec->in_unit > 0 ? buffer_size / codec->in_unit : 1;
+	grow_pipe( input_fd, requested_units * codec->in_unit );
+	size_t capacity = grow_pipe( output_fd, requested_units * codec->out_unit );
+
+	if ( capacity < page_size || codec->out_unit > page_size ) {
+		return block_io_process( input_file, output_file, codec, buffer_size, stats );
+	}
+
+	size_t buffer_units = capacity / codec->out_unit;
+	size_t output_size = ( ( buffer_units + 1 ) * codec->out_unit + page_size - 1 ) / page_size * page_size;
+	uint8_t *input_buffer = malloc( ( buffer_units + 1 ) * codec->in_unit );
+	uint32_t current = 0;
+	bool success = true;
+
+	// The output buffers are mapped instead of allocated, since free could write to pages still in the pipe.
+	uint8_t *output_buffers = mmap( NULL, 2 * output_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+	if ( !input_buffer || output_buffers == MAP_FAILED ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+
+		if ( output_buffers != MAP_FAILED ) {
+			munmap( output_buffers, 2 * output_size );
+		}
+
+		free( input_buffer );
+
+		return false;
+	}
+
+	fflush( output_file ); // Nothing written through stdio may end up after the blocks.
+
+	while ( success ) {
+		// Filling the whole buffer keeps the spliced blocks as large as the pipe.
+		ssize_t bytes_read = block_io_read_full( input_fd, input_buffer, buffer_units * codec->in_unit );
+
+		if ( bytes_read < 0 ) {
+			fprintf( stderr, "Error: failed to read from input file.\n" );
+			success = false;
+			break;
+		}
+
+		stats->total_bytes_processed += bytes_read;
+		size_t units = bytes_read / codec->in_unit;
+		size_t remainder = bytes_read % codec->in_unit;
+
+		if ( remainder > 0 && codec->pad_tail ) {
+			memset( input_buffer + bytes_read, 0, codec->in_unit - remainder );
+			units++;
+		}
+
+		if ( units == 0 ) {
+			break;
+		}
+
+		uint8_t *output_buffer = output_buffers + current * output_size;
+		size_t output_length = units * codec->out_unit;
+		codec->process( input_buffer, output_buffer, units, stats );
+
+		// Only a block spanning every page of the pipe pushes all of the other buffer's pages out of it.
+		if ( output_length + page_size > capacity ) {
+			success = splice_all( output_fd, output_buffer, output_length );
+			current ^= 1;
+		} else {
+			success = block_io_write_all( output_fd, output_buffer, output_length );
+		}
+
+		if ( !success ) {
+			fprintf( stderr, "Error: failed to write to output file.\n" );
+		}
+
+		if ( ( size_t ) bytes_read < buffer_units * codec->in_unit ) {
+			break;
+		}
+	}
+
+	munmap( output_buffers, 2 * output_size );
+	free( input_buffer );
+
+	return success;
+#else
+	return block_io_process( input_file, output_file, codec, buffer_size, stats );
+#endif
+}
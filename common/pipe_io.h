@@ -0,0 +1,14 @@
+#ifndef __PIPE_IO_H__
+#define __PIPE_IO_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+bool pipe_io_is_supported( FILE *output_file );
+
+bool pipe_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t buffer_size, CodecStats *stats );
+
+#endif
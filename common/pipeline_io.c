@@ -0,0 +1,348 @@
+#include "pipeline_io.h"
+
+#include "block_io.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Description:
+// A buffer moving from the reader to the codec to the writer and back.
+//
+// Members:
+// uint8_t *input_buffer - The data read.
+// uint8_t *output_buffer - The result of processing the data. Has room for one more unit than the input buffer.
+// size_t input_length - The number of bytes in the input buffer.
+// size_t output_length - The number of bytes in the output buffer.
+// bool last - Whether this is the last block of the stream.
+typedef struct PipelineBlock {
+	uint8_t *input_buffer;
+	uint8_t *output_buffer;
+	size_t input_length;
+	size_t output_length;
+	bool last;
+} PipelineBlock;
+
+// Description:
+// A single-producer single-consumer ring of blocks. It holds every block, so pushing never waits, and a semaphore
+// counting the blocks in it lets the consumer sleep while it's empty. Posting and waiting on the semaphore also make
+// each pushed block visible to the consumer, so the indices need no synchronization of their own.
+//
+// Members:
+// PipelineBlock *blocks[ PIPELINE_IO_BLOCKS ] - The blocks in the ring.
+// uint32_t head - The index of the next block to pop. Only used by the consumer.
+// uint32_t tail - The index of the next block to push. Only used by the producer.
+// sem_t ready - The number of blocks in the ring.
+typedef struct PipelineRing {
+	PipelineBlock *blocks[ PIPELINE_IO_BLOCKS ];
+	uint32_t head;
+	uint32_t tail;
+	sem_t ready;
+} PipelineRing;
+
+// Description:
+// State shared by the reader, the codec, and the writer.
+//
+// Members:
+// int input_fd - The file descriptor to read from.
+// int output_fd - The file descriptor to write to.
+// size_t input_size - The size of each input buffer in bytes.
+// PipelineRing free_blocks - Blocks the writer is done with, waiting to be read into.
+// PipelineRing read_blocks - Blocks read, waiting to be processed.
+// PipelineRing processed_blocks - Blocks processed, waiting to be written.
+// atomic_bool read_failed - Whether a read failed.
+// atomic_bool write_failed - Whether a write failed, so the reader should stop.
+// uint64_t bytes_read - The number of bytes read. Only read once the reader has finished.
+typedef struct PipelineJob {
+	int input_fd;
+	int output_fd;
+	size_t input_size;
+	PipelineRing free_blocks;
+	PipelineRing read_blocks;
+	PipelineRing processed_blocks;
+	atomic_bool read_failed;
+	atomic_bool write_failed;
+	uint64_t bytes_read;
+} PipelineJob;
+
+// Description:
+// Sets up an empty ring.
+//
+// Parameters:
+// PipelineRing *ring - The ring to set up.
+//
+// Returns:
+// bool - Whether the semaphore could be created.
+static bool ring_init( PipelineRing *ring ) {
+	ring->head = 0;
+	ring->tail = 0;
+
+	return sem_init( &ring->ready, 0, 0 ) == 0;
+}
+
+// Description:
+// Adds a block to a ring. Only called by the ring's producer.
+//
+// Parameters:
+// PipelineRing *ring - The ring.
+// PipelineBlock *block - The block to add.
+//
+// Returns:
+// Nothing.
+static void ring_push( PipelineRing *ring, PipelineBlock *block ) {
+	ring->blocks[ ring->tail % PIPELINE_IO_BLOCKS ] = block;
+	ring->tail++;
+	sem_post( &ring->ready );
+}
+
+// Description:
+// Takes the oldest block from a ring, waiting for one if it's empty. Only called by the ring's consumer.
+//
+// Parameters:
+// PipelineRing *ring - The ring.
+//
+// Returns:
+// PipelineBlock * - The block.
+static PipelineBlock *ring_pop( PipelineRing *ring ) {
+	while ( sem_wait( &ring->ready ) != 0 && errno == EINTR ) {
+	}
+
+	PipelineBlock *block = ring->blocks[ ring->head % PIPELINE_IO_BLOCKS ];
+	ring->head++;
+
+	return block;
+}
+
+// Description:
+// The entry point of the reader thread. Reads into free blocks until the end of the input, a failure, or a failed
+// write, and ends the stream with a block marked last.
+//
+// Parameters:
+// void *arg - The PipelineJob.
+//
+// Returns:
+// void * - Always NULL.
+static void *reader_main( void *arg ) {
+	PipelineJob *job = arg;
+	bool done = false;
+
+	while ( !done ) {
+		PipelineBlock *block = ring_pop( &job->free_blocks );
+		ssize_t bytes_read = 0;
+
+		do {
+			bytes_read = atomic_load( &job->write_failed ) ? 0 : read( job->input_fd, block->input_buffer, job->input_size );
+		} while ( bytes_read < 0 && errno == EINTR );
+
+		if ( bytes_read < 0 ) {
+			atomic_store( &job->read_failed, true );
+		}
+
+		block->input_length = bytes_read > 0 ? bytes_read : 0;
+		block->last = bytes_read <= 0;
+		job->bytes_read += block->input_length;
+		done = block->last;
+		ring_push( &job->read_blocks, block );
+	}
+
+	return NULL;
+}
+
+// Description:
+// The entry point of the writer thread. Writes processed blocks and hands them back to the reader until the last
+// block. After a failed write, blocks are passed back without writing them.
+//
+// Parameters:
+// void *arg - The PipelineJob.
+//
+// Returns:
+// void * - Always NULL.
+static void *writer_main( void *arg ) {
+	PipelineJob *job = arg;
+	bool done = false;
+
+	while ( !done ) {
+		PipelineBlock *block = ring_pop( &job->processed_blocks );
+		done = block->last;
+
+		if ( !atomic_load( &job->write_failed ) && !block_io_write_all( job->output_fd, block->output_buffer, block->output_length ) ) {
+			atomic_store( &job->write_failed, true );
+		}
+
+		if ( !done ) {
+			ring_push( &job->free_blocks, block );
+		}
+	}
+
+	return NULL;
+}
+
+// Description:
+// Runs the codec over a block, finishing the unit carried over from the previous block first and carrying over the new
+// trailing partial unit. The last block also gets the carried unit padded if the codec wants it.
+//
+// Parameters:
+// const BlockCodec *codec - The codec to run.
+// PipelineBlock *block - The block. Its output buffer and length are set.
+// uint8_t *carry - The partial unit carried between blocks. Must hold codec->in_unit bytes.
+// size_t *carried - The number of bytes in carry.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// Nothing.
+static void process_block( const BlockCodec *codec, PipelineBlock *block, uint8_t *carry, size_t *carried, CodecStats *stats ) {
+	const uint8_t *in = block->input_buffer;
+	size_t length = block->input_length;
+	block->output_length = 0;
+
+	if ( *carried > 0 ) {
+		size_t taken = length < codec->in_unit - *carried ? length : codec->in_unit - *carried;
+		memcpy( carry + *carried, in, taken );
+		*carried += taken;
+		in += taken;
+		length -= taken;
+
+		if ( *carried == codec->in_unit ) {
+			codec->process( carry, block->output_buffer, 1, stats );
+			block->output_length = codec->out_unit;
+			*carried = 0;
+		}
+	}
+
+	if ( *carried == 0 ) {
+		size_t units = length / codec->in_unit;
+
+		if ( units > 0 ) {
+			codec->process( in, block->output_buffer + block->output_length, units, stats );
+			block->output_length += units * codec->out_unit;
+		}
+
+		*carried = length - units * codec->in_unit;
+		memcpy( carry, in + units * codec->in_unit, *carried );
+	}
+
+	if ( block->last && *carried > 0 && codec->pad_tail ) {
+		memset( carry + *carried, 0, codec->in_unit - *carried );
+		codec->process( carry, block->output_buffer + block->output_length, 1, stats );
+		block->output_length += codec->out_unit;
+		*carried = 0;
+	}
+}
+
+// Description:
+// Reads the input file on a reader thread, runs the codec on the calling thread, and writes the output file on a
+// writer thread, so reading and writing overlap with processing. The threads pass PIPELINE_IO_BLOCKS buffers around
+// through single-producer single-consumer rings, so no buffers are allocated per block.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The codec to run over the data.
+// size_t buffer_size - The size of each input buffer in bytes. Rounded down to a whole number of units.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, processed, and written to the output file.
+bool pipeline_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t buffer_size, CodecStats *stats ) {
+	size_t buffer_units = buffer_size / codec->in_unit > 0 ? buffer_size / codec->in_unit : 1;
+	PipelineBlock blocks[ PIPELINE_IO_BLOCKS ] = { 0 };
+	PipelineJob job;
+	memset( &job, 0, sizeof( job ) );
+	job.input_fd = fileno( input_file );
+	job.output_fd = fileno( output_file );
+	job.input_size = buffer_units * codec->in_unit;
+	uint8_t *carry = malloc( codec->in_unit );
+	size_t carried = 0;
+	bool success = carry != NULL;
+	atomic_init( &job.read_failed, false );
+	atomic_init( &job.write_failed, false );
+
+	for ( uint32_t i = 0; i < PIPELINE_IO_BLOCKS; i++ ) {
+		blocks[ i ].input_buffer = malloc( job.input_size );
+		blocks[ i ].output_buffer = malloc( ( buffer_units + 1 ) * codec->out_unit );
+		success = success && blocks[ i ].input_buffer && blocks[ i ].output_buffer;
+	}
+
+	PipelineRing *rings[] = { &job.free_blocks, &job.read_blocks, &job.processed_blocks };
+	size_t ring_count = sizeof( rings ) / sizeof( *rings );
+	size_t rings_ready = 0;
+
+	while ( success && rings_ready < ring_count && ring_init( rings[ rings_ready ] ) ) {
+		rings_ready++;
+	}
+
+	if ( !success ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+	} else if ( rings_ready < ring_count ) {
+		fprintf( stderr, "Error: failed to create thread.\n" );
+		success = false;
+	}
+
+	pthread_t reader;
+	pthread_t writer;
+
+	if ( success ) {
+		for ( uint32_t i = 0; i < PIPELINE_IO_BLOCKS; i++ ) {
+			ring_push( &job.free_blocks, &blocks[ i ] );
+		}
+
+		fflush( output_file ); // Nothing written through stdio may end up after the blocks.
+
+		if ( pthread_create( &writer, NULL, writer_main, &job ) != 0 ) {
+			fprintf( stderr, "Error: failed to create thread.\n" );
+			success = false;
+		} else if ( pthread_create( &reader, NULL, reader_main, &job ) != 0 ) {
+			// Let the writer finish on an empty last block.
+			fprintf( stderr, "Error: failed to create thread.\n" );
+			blocks[ 0 ].last = true;
+			ring_push( &job.processed_blocks, &blocks[ 0 ] );
+			pthread_join( writer, NULL );
+			success = false;
+		}
+	}
+
+	if ( success ) {
+		bool done = false;
+
+		while ( !done ) {
+			PipelineBlock *block = ring_pop( &job.read_blocks );
+			done = block->last;
+			process_block( codec, block, carry, &carried, stats );
+			ring_push( &job.processed_blocks, block );
+		}
+
+		pthread_join( reader, NULL );
+		pthread_join( writer, NULL );
+		stats->total_bytes_processed += job.bytes_read;
+
+		if ( atomic_load( &job.read_failed ) ) {
+			fprintf( stderr, "Error: failed to read from input file.\n" );
+			success = false;
+		} else if ( atomic_load( &job.write_failed ) ) {
+			fprintf( stderr, "Error: failed to write to output file.\n" );
+			success = false;
+		}
+	}
+
+	// Only the rings that were set up have a semaphore to destroy.
+	for ( size_t i = 0; i < rings_ready; i++ ) {
+		sem_destroy( &rings[ i ]->ready );
+	}
+
+	for ( uint32_t i = 0; i < PIPELINE_IO_BLOCKS; i++ ) {
+		free( blocks[ i ].output_buffer );
+		free( blocks[ i ].input_buffer );
+	}
+
+	free( carry );
+
+	return success;
+}
@@ -0,0 +1,14 @@
+#ifndef __PIPELINE_IO_H__
+#define __PIPELINE_IO_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define PIPELINE_IO_BLOCKS 4 // Number of buffers recycled between the reader, the codec, and the writer.
+
+bool pipeline_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t buffer_size, CodecStats *stats );
+
+#endif
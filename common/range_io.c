@@ -0,0 +1,100 @@
+#include "range_io.h"
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// Description:
+// Decodes a range of the original data without reading the codes before or after it. Since every unit of original
+// data is encoded into a unit of codes at the same index, only the units overlapping the range are read, a buffer at a
+// time with pread(2) from their offset after the input file's current position, and only the bytes of the range are
+// written. A range running past the end of the data is cut short, and a trailing partial unit of codes is dropped.
+//
+// Parameters:
+// FILE *input_file - The file to read the codes from. Must be seekable.
+// FILE *output_file - The file to write the original data to.
+// const BlockCodec *codec - The decoder.
+// uint64_t offset - The offset of the range in the original data.
+// uint64_t length - The number of bytes in the range, or RANGE_IO_TO_END.
+// size_t buffer_size - The most code bytes to read at once.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the codes could be read, decoded, and written to the output file.
+bool range_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, uint64_t offset, uint64_t length, size_t buffer_size, CodecStats *stats ) {
+	int input_fd = fileno( input_file );
+	int output_fd = fileno( output_file );
+	off_t input_base = lseek( input_fd, 0, SEEK_CUR );
+
+	if ( input_base < 0 ) {
+		fprintf( stderr, "Error: --offset and --length need a seekable infile.\n" );
+
+		return false;
+	}
+
+	size_t buffer_units = buffer_size / codec->in_unit > 0 ? buffer_size / codec->in_unit : 1;
+	uint8_t *codes = malloc( buffer_units * codec->in_unit );
+	uint8_t *data = malloc( buffer_units * codec->out_unit );
+	uint64_t unit = offset / codec->out_unit;
+	size_t skip = offset % codec->out_unit; // Bytes of the first unit before the range.
+	bool success = codes && data;
+
+	if ( !success ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+	}
+
+	fflush( output_file ); // Nothing written through stdio may end up after the range.
+
+	while ( success && length > 0 ) {
+		size_t units = buffer_units;
+
+		if ( length < ( uint64_t ) buffer_units * codec->out_unit ) {
+			uint64_t needed = ( skip + length + codec->out_unit - 1 ) / codec->out_unit;
+			units = needed < units ? needed : units;
+		}
+
+		ssize_t bytes_read = block_io_pread_full( input_fd, codes, units * codec->in_unit, input_base + unit * codec->in_unit );
+
+		if ( bytes_read < 0 ) {
+			fprintf( stderr, "Error: failed to read from input file.\n" );
+			success = false;
+			break;
+		}
+
+		size_t whole_units = bytes_read / codec->in_unit;
+		stats->total_bytes_processed += bytes_read;
+
+		if ( whole_units * codec->out_unit <= skip ) {
+			break; // The range starts or continues past the end of the data.
+		}
+
+		codec->process( codes, data, whole_units, stats );
+		size_t decoded = whole_units * codec->out_unit - skip;
+		decoded = length < decoded ? length : decoded;
+
+		if ( !block_io_write_all( output_fd, data + skip, decoded ) ) {
+			fprintf( stderr, "Error: failed to write to output file.\n" );
+			success = false;
+			break;
+		}
+
+		unit += whole_units;
+		skip = 0;
+		length -= decoded;
+
+		if ( whole_units < units ) {
+			break;
+		}
+	}
+
+	free( data );
+	free( codes );
+
+	return success;
+}
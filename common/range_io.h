@@ -0,0 +1,15 @@
+#ifndef __RANGE_IO_H__
+#define __RANGE_IO_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define RANGE_IO_TO_END UINT64_MAX // Length of a range that runs to the end of the data.
+
+bool range_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, uint64_t offset, uint64_t length, size_t buffer_size, CodecStats *stats );
+
+#endif
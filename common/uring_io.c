@@ -0,0 +1,560 @@
+#include "uring_io.h"
+
+#include "block_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined( __linux__ ) && defined( __has_include )
+#if __has_include( <linux/io_uring.h> )
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#define URING_IO_AVAILABLE // Whether io_uring can be built.
+#endif
+#endif
+
+#ifdef URING_IO_AVAILABLE
+#define URING_IO_MAX_TRANSFER ( 1 << 30 ) // Maximum number of bytes moved by one read or write.
+
+typedef enum URING_SLOT_STATE {
+	URING_SLOT_FREE, // Not in use.
+	URING_SLOT_READING, // Being read into.
+	URING_SLOT_READ, // Read, waiting to be processed.
+	URING_SLOT_WRITABLE, // Processed, waiting to be written.
+	URING_SLOT_WRITING, // Being written from.
+} URING_SLOT_STATE;
+
+// Description:
+// An io_uring instance and the rings shared with the kernel.
+//
+// Members:
+// int fd - The file descriptor of the instance.
+// uint8_t *sq_ring - The mapping of the submission queue ring.
+// size_t sq_ring_size - The size of the submission queue ring mapping.
+// uint8_t *cq_ring - The mapping of the completion queue ring. Same as sq_ring if the kernel maps both at once.
+// size_t cq_ring_size - The size of the completion queue ring mapping.
+// struct io_uring_sqe *sqes - The submission queue entries.
+// size_t sqes_size - The size of the submission queue entry mapping.
+// uint32_t *sq_tail - The tail of the submission queue, written by us.
+// uint32_t sq_mask - The mask of submission queue indices.
+// uint32_t *sq_array - The indices of the submitted entries.
+// uint32_t *cq_head - The head of the completion queue, written by us.
+// uint32_t *cq_tail - The tail of the completion queue, written by the kernel.
+// uint32_t cq_mask - The mask of completion queue indices.
+// struct io_uring_cqe *cqes - The completion queue entries.
+// uint32_t to_submit - The number of entries queued since the last submission.
+typedef struct UringQueue {
+	int fd;
+	uint8_t *sq_ring;
+	size_t sq_ring_size;
+	uint8_t *cq_ring;
+	size_t cq_ring_size;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	uint32_t *sq_tail;
+	uint32_t sq_mask;
+	uint32_t *sq_array;
+	uint32_t *cq_head;
+	uint32_t *cq_tail;
+	uint32_t cq_mask;
+	struct io_uring_cqe *cqes;
+	uint32_t to_submit;
+} UringQueue;
+
+// Description:
+// A pair of buffers moving through the pipeline. Slots are used round-robin, so slot i holds every URING_IO_DEPTH-th
+// buffer of the stream.
+//
+// Members:
+// URING_SLOT_STATE state - What the slot is being used for.
+// uint8_t *input_buffer - The data read.
+// uint8_t *output_buffer - The result of processing the data. Has room for one more unit than the input buffer.
+// size_t input_length - The number of bytes read into the input buffer.
+// size_t output_length - The number of bytes in the output buffer.
+// size_t written - The number of bytes of the output buffer written.
+// uint64_t offset - The offset of the current read or write in its file, or -1 to use the file's position.
+typedef struct UringSlot {
+	URING_SLOT_STATE state;
+	uint8_t *input_buffer;
+	uint8_t *output_buffer;
+	size_t input_length;
+	size_t output_length;
+	size_t written;
+	uint64_t offset;
+} UringSlot;
+
+// Description:
+// Sets up an io_uring instance and maps its rings.
+//
+// Parameters:
+// UringQueue *queue - The queue to set up.
+// uint32_t entries - The number of submission queue entries.
+//
+// Returns:
+// bool - Whether the kernel supports io_uring and the instance could be set up.
+static bool queue_init( UringQueue *queue, uint32_t entries ) {
+	struct io_uring_params params;
+	memset( &params, 0, sizeof( params ) );
+	memset( queue, 0, sizeof( *queue ) );
+	queue->fd = syscall( __NR_io_uring_setup, entries, &params );
+
+	if ( queue->fd < 0 ) {
+		return false;
+	}
+
+	queue->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof( uint32_t );
+	queue->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof( struct io_uring_cqe );
+	queue->sqes_size = params.sq_entries * sizeof( struct io_uring_sqe );
+
+	// Newer kernels map both rings at once.
+	if ( params.features & IORING_FEAT_SINGLE_MMAP ) {
+		queue->sq_ring_size = queue->sq_ring_size > queue->cq_ring_size ? queue->sq_ring_size : queue->cq_ring_size;
+		queue->cq_ring_size = 0;
+	}
+
+	void *sq_ring = mmap( NULL, queue->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, queue->fd, IORING_OFF_SQ_RING );
+	void *cq_ring = sq_ring;
+	void *sqes = MAP_FAILED;
+
+	if ( sq_ring != MAP_FAILED && queue->cq_ring_size > 0 ) {
+		cq_ring = mmap( NULL, queue->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, queue->fd, IORING_OFF_CQ_RING );
+	}
+
+	if ( sq_ring != MAP_FAILED && cq_ring != MAP_FAILED ) {
+		sqes = mmap( NULL, queue->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, queue->fd, IORING_OFF_SQES );
+	}
+
+	if ( sqes == MAP_FAILED ) {
+		if ( cq_ring != MAP_FAILED && cq_ring != sq_ring ) {
+			munmap( cq_ring, queue->cq_ring_size );
+		}
+
+		if ( sq_ring != MAP_FAILED ) {
+			munmap( sq_ring, queue->sq_ring_size );
+		}
+
+		close( queue->fd );
+
+		return false;
+	}
+
+	queue->sq_ring = sq_ring;
+	queue->cq_ring = cq_ring;
+	queue->sqes = sqes;
+	queue->sq_tail = ( uint32_t * ) ( queue->sq_ring + params.sq_off.tail );
+	queue->sq_mask = *( uint32_t * ) ( queue->sq_ring + params.sq_off.ring_mask );
+	queue->sq_array = ( uint32_t * ) ( queue->sq_ring + params.sq_off.array );
+	queue->cq_head = ( uint32_t * ) ( queue->cq_ring + params.cq_off.head );
+	queue->cq_tail = ( uint32_t * ) ( queue->cq_ring + params.cq_off.tail );
+	queue->cq_mask = *( uint32_t * ) ( queue->cq_ring + params.cq_off.ring_mask );
+	queue->cqes = ( struct io_uring_cqe * ) ( queue->cq_ring + params.cq_off.cqes );
+
+	return true;
+}
+
+// Description:
+// Unmaps the rings of an io_uring instance and closes it.
+//
+// Parameters:
+// UringQueue *queue - The queue to delete.
+//
+// Returns:
+// Nothing.
+static void queue_delete( UringQueue *queue ) {
+	munmap( queue->sqes, queue->sqes_size );
+
+	if ( queue->cq_ring != queue->sq_ring ) {
+		munmap( queue->cq_ring, queue->cq_ring_size );
+	}
+
+	munmap( queue->sq_ring, queue->sq_ring_size );
+	close( queue->fd );
+}
+
+// Description:
+// Queues a read or write. It's submitted by the next call to queue_submit.
+//
+// Parameters:
+// UringQueue *queue - The queue.
+// uint8_t opcode - The IORING_OP_* operation.
+// int fd - The file descriptor to read from or write to.
+// uint8_t *buffer - The buffer to read into or write from.
+// size_t length - The number of bytes to move. Capped at URING_IO_MAX_TRANSFER.
+// uint64_t offset - The offset in the file, or -1 to use the file's position.
+// uint16_t buffer_index - The index of the registered buffer holding buffer. Only used by the fixed operations.
+// uint64_t user_data - Passed back with the completion.
+//
+// Returns:
+// Nothing.
+static void queue_transfer( UringQueue *queue, uint8_t opcode, int fd, uint8_t *buffer, size_t length, uint64_t offset, uint16_t buffer_index, uint64_t user_data ) {
+	uint32_t tail = *queue->sq_tail + queue->to_submit;
+	uint32_t index = tail & queue->sq_mask;
+	struct io_uring_sqe *sqe = &queue->sqes[ index ];
+	memset( sqe, 0, sizeof( *sqe ) );
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->addr = ( uintptr_t ) buffer;
+	sqe->len = length < URING_IO_MAX_TRANSFER ? length : URING_IO_MAX_TRANSFER;
+	sqe->off = offset;
+	sqe->buf_index = opcode == IORING_OP_READ_FIXED || opcode == IORING_OP_WRITE_FIXED ? buffer_index : 0;
+	sqe->user_data = user_data;
+	queue->sq_array[ index ] = index;
+	queue->to_submit++;
+}
+
+// Description:
+// Submits the queued operations and waits for a completion if asked to.
+//
+// Parameters:
+// UringQueue *queue - The queue.
+// bool wait - Whether to wait until at least one operation has completed.
+//
+// Returns:
+// bool - Whether the operations could be submitted. False if the kernel stops taking them, so a full submission
+// queue can't loop forever.
+static bool queue_submit( UringQueue *queue, bool wait ) {
+	__atomic_store_n( queue->sq_tail, *queue->sq_tail + queue->to_submit, __ATOMIC_RELEASE );
+
+	while ( true ) {
+		long submitted = syscall( __NR_io_uring_enter, queue->fd, queue->to_submit, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0 );
+
+		if ( submitted < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+
+			return false;
+		}
+
+		if ( submitted == 0 && queue->to_submit > 0 ) {
+			return false;
+		}
+
+		queue->to_submit -= submitted;
+
+		if ( queue->to_submit == 0 ) {
+			return true;
+		}
+	}
+}
+
+// Description:
+// Waits for at least one completion without submitting anything, for draining the operations the kernel took after a
+// submission failed.
+//
+// Parameters:
+// UringQueue *queue - The queue.
+//
+// Returns:
+// bool - Whether the wait succeeded.
+static bool queue_wait( UringQueue *queue ) {
+	while ( syscall( __NR_io_uring_enter, queue->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0 ) < 0 ) {
+		if ( errno != EINTR ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Description:
+// Checks whether a file can be read or written at explicit offsets, so several reads or writes can be in flight at once.
+//
+// Parameters:
+// int fd - The file descriptor to check.
+// uint64_t *offset - Where to put the file's position if it's positional.
+//
+// Returns:
+// bool - Whether the file is a regular file or block device that isn't in append mode.
+static bool is_positional( int fd, uint64_t *offset ) {
+	struct stat file_stats;
+
+	if ( fstat( fd, &file_stats ) != 0 || !( S_ISREG( file_stats.st_mode ) || S_ISBLK( file_stats.st_mode ) ) || ( fcntl( fd, F_GETFL ) & O_APPEND ) ) {
+		return false;
+	}
+
+	off_t position = lseek( fd, 0, SEEK_CUR );
+	*offset = position;
+
+	return position >= 0;
+}
+
+// Description:
+// Runs the codec over a read buffer, finishing the unit carried over from the previous buffer first and carrying over
+// the new trailing partial unit.
+//
+// Parameters:
+// const BlockCodec *codec - The codec to run.
+// UringSlot *slot - The slot holding the read buffer. Its output buffer and length are set.
+// uint8_t *carry - The partial unit carried between buffers. Must hold codec->in_unit bytes.
+// size_t *carried - The number of bytes in carry.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// Nothing.
+static void process_slot( const BlockCodec *codec, UringSlot *slot, uint8_t *carry, size_t *carried, CodecStats *stats ) {
+	const uint8_t *in = slot->input_buffer;
+	size_t length = slot->input_length;
+	slot->output_length = 0;
+
+	if ( *carried > 0 ) {
+		size_t taken = length < codec->in_unit - *carried ? length : codec->in_unit - *carried;
+		memcpy( carry + *carried, in, taken );
+		*carried += taken;
+		in += taken;
+		length -= taken;
+
+		if ( *carried < codec->in_unit ) {
+			return;
+		}
+
+		codec->process( carry, slot->output_buffer, 1, stats );
+		slot->output_length = codec->out_unit;
+		*carried = 0;
+	}
+
+	size_t units = length / codec->in_unit;
+
+	if ( units > 0 ) {
+		codec->process( in, slot->output_buffer + slot->output_length, units, stats );
+		slot->output_length += units * codec->out_unit;
+	}
+
+	*carried = length - units * codec->in_unit;
+	memcpy( carry, in + units * codec->in_unit, *carried );
+}
+#endif
+
+// Description:
+// Reads the input file, runs the codec, and writes the output file with io_uring, keeping URING_IO_DEPTH buffers
+// between reads in flight, the codec, and writes in flight, so I/O overlaps with processing. Several reads or writes are
+// in flight at once when their file is positional. Falls back to block_io_process when io_uring isn't available.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// FILE *output_file - The file to write to.
+// const BlockCodec *codec - The codec to run over the data.
+// size_t buffer_size - The size of each input buffer in bytes. Rounded down to a whole number of units.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, processed, and written to the output file.
+bool uring_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t buffer_size, CodecStats *stats ) {
+#ifdef URING_IO_AVAILABLE
+	UringQueue queue;
+
+	if ( !queue_init( &queue, URING_IO_DEPTH ) ) {
+		return block_io_process( input_file, output_file, codec, buffer_size, stats );
+	}
+
+	int input_fd = fileno( input_file );
+	int output_fd = fileno( output_file );
+	size_t buffer_units = buffer_size / codec->in_unit > 0 ? buffer_size / codec->in_unit : 1;
+	size_t input_size = buffer_units * codec->in_unit;
+	UringSlot slots[ URING_IO_DEPTH ] = { 0 };
+	struct iovec buffers[ 2 * URING_IO_DEPTH ];
+	uint8_t *carry = malloc( codec->in_unit );
+	size_t carried = 0;
+	bool success = carry != NULL;
+
+	for ( uint32_t i = 0; i < URING_IO_DEPTH; i++ ) {
+		slots[ i ].input_buffer = malloc( input_size );
+		slots[ i ].output_buffer = malloc( ( buffer_units + 1 ) * codec->out_unit );
+		success = success && slots[ i ].input_buffer && slots[ i ].output_buffer;
+		buffers[ i ] = ( struct iovec ) { slots[ i ].input_buffer, input_size };
+		buffers[ URING_IO_DEPTH + i ] = ( struct iovec ) { slots[ i ].output_buffer, ( buffer_units + 1 ) * codec->out_unit };
+	}
+
+	if ( !success ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+	}
+
+	// Registered buffers save pinning the pages on every transfer, but the kernel may refuse them.
+	bool fixed = success && syscall( __NR_io_uring_register, queue.fd, IORING_REGISTER_BUFFERS, buffers, 2 * URING_IO_DEPTH ) == 0;
+	uint8_t read_op = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	uint8_t write_op = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+	uint64_t read_offset = 0;
+	uint64_t write_offset = 0;
+	bool positional_input = is_positional( input_fd, &read_offset );
+	bool positional_output = is_positional( output_fd, &write_offset );
+	bool end_of_input = false;
+	uint64_t next_read = 0;
+	uint64_t next_process = 0;
+	uint64_t next_write = 0;
+	uint32_t reads_in_flight = 0;
+	uint32_t writes_in_flight = 0;
+	bool started = false;
+	bool fall_back = false;
+	bool submit_failed = false;
+	fflush( output_file ); // Nothing written through stdio may end up after the blocks.
+
+	// Operations still queued were never taken by the kernel, so they'll never complete and aren't waited for.
+	while ( success || reads_in_flight + writes_in_flight > queue.to_submit ) {
+		// Unpositional files have to be read and written one transfer at a time to keep the data in order.
+		while ( success && !end_of_input && slots[ next_read % URING_IO_DEPTH ].state == URING_SLOT_FREE && ( positional_input || reads_in_flight == 0 ) ) {
+			uint32_t index = next_read++ % URING_IO_DEPTH;
+			UringSlot *slot = &slots[ index ];
+			slot->state = URING_SLOT_READING;
+			slot->input_length = 0;
+			slot->offset = positional_input ? read_offset : ( uint64_t ) -1;
+			read_offset += positional_input ? input_size : 0;
+			queue_transfer( &queue, read_op, input_fd, slot->input_buffer, input_size, slot->offset, index, index );
+			reads_in_flight++;
+		}
+
+		while ( success && slots[ next_process % URING_IO_DEPTH ].state == URING_SLOT_READ ) {
+			UringSlot *slot = &slots[ next_process++ % URING_IO_DEPTH ];
+			process_slot( codec, slot, carry, &carried, stats );
+			slot->state = URING_SLOT_WRITABLE;
+		}
+
+		while ( success && slots[ next_write % URING_IO_DEPTH ].state == URING_SLOT_WRITABLE && ( positional_output || writes_in_flight == 0 ) ) {
+			uint32_t index = next_write++ % URING_IO_DEPTH;
+			UringSlot *slot = &slots[ index ];
+
+			if ( slot->output_length == 0 ) {
+				slot->state = URING_SLOT_FREE;
+				continue;
+			}
+
+			slot->state = URING_SLOT_WRITING;
+			slot->written = 0;
+			slot->offset = positional_output ? write_offset : ( uint64_t ) -1;
+			write_offset += positional_output ? slot->output_length : 0;
+			queue_transfer( &queue, write_op, output_fd, slot->output_buffer, slot->output_length, slot->offset, URING_IO_DEPTH + index, index );
+			writes_in_flight++;
+		}
+
+		if ( reads_in_flight + writes_in_flight == 0 ) {
+			if ( !success || ( end_of_input && next_write == next_read ) ) {
+				break;
+			}
+
+			continue;
+		}
+
+		uint32_t queued = queue.to_submit;
+
+		if ( submit_failed ) {
+			// Drain the operations the kernel took, so their buffers aren't freed while it may still use them.
+			if ( !queue_wait( &queue ) ) {
+				break;
+			}
+		} else if ( !queue_submit( &queue, true ) ) {
+			// If the kernel never took anything, nothing has been read or written, so the blocking path can do it all.
+			fall_back = !started && queue.to_submit == queued;
+
+			if ( !fall_back ) {
+				fprintf( stderr, "Error: failed to submit I/O.\n" );
+			}
+
+			success = false;
+			submit_failed = true;
+			continue;
+		}
+
+		started = true;
+
+		uint32_t head = *queue.cq_head;
+		uint32_t tail = __atomic_load_n( queue.cq_tail, __ATOMIC_ACQUIRE );
+
+		for ( ; head != tail; head++ ) {
+			struct io_uring_cqe *cqe = &queue.cqes[ head & queue.cq_mask ];
+			uint32_t index = cqe->user_data;
+			UringSlot *slot = &slots[ index ];
+			bool retry = cqe->res == -EINTR || cqe->res == -EAGAIN;
+
+			if ( slot->state == URING_SLOT_READING ) {
+				if ( cqe->res < 0 && !retry ) {
+					if ( success ) {
+						fprintf( stderr, "Error: failed to read from input file.\n" );
+					}
+
+					success = false;
+				}
+
+				if ( cqe->res > 0 ) {
+					stats->total_bytes_processed += cqe->res;
+					slot->input_length += cqe->res;
+				}
+
+				end_of_input = end_of_input || cqe->res == 0;
+
+				// A short read of a positional file is only the end of the input if nothing more can be read.
+				if ( success && ( retry || ( cqe->res > 0 && positional_input && slot->input_length < input_size ) ) ) {
+					uint64_t offset = positional_input ? slot->offset + slot->input_length : ( uint64_t ) -1;
+					queue_transfer( &queue, read_op, input_fd, slot->input_buffer + slot->input_length, input_size - slot->input_length, offset, index, index );
+				} else {
+					slot->state = URING_SLOT_READ;
+					reads_in_flight--;
+				}
+			} else {
+				if ( cqe->res <= 0 && !retry ) {
+					if ( success ) {
+						fprintf( stderr, "Error: failed to write to output file.\n" );
+					}
+
+					success = false;
+				}
+
+				slot->written += cqe->res > 0 ? cqe->res : 0;
+
+				if ( success && slot->written < slot->output_length ) {
+					uint64_t offset = positional_output ? slot->offset + slot->written : ( uint64_t ) -1;
+					queue_transfer( &queue, write_op, output_fd, slot->output_buffer + slot->written, slot->output_length - slot->written, offset, URING_IO_DEPTH + index, index );
+				} else {
+					slot->state = URING_SLOT_FREE;
+					writes_in_flight--;
+				}
+			}
+		}
+
+		__atomic_store_n( queue.cq_head, head, __ATOMIC_RELEASE );
+	}
+
+	// Leave the output file's position after the data, like the blocking writes do.
+	if ( positional_output ) {
+		lseek( output_fd, write_offset, SEEK_SET );
+	}
+
+	if ( success && carried > 0 && codec->pad_tail ) {
+		memset( carry + carried, 0, codec->in_unit - carried );
+		codec->process( carry, slots[ 0 ].output_buffer, 1, stats );
+
+		if ( !block_io_write_all( output_fd, slots[ 0 ].output_buffer, codec->out_unit ) ) {
+			fprintf( stderr, "Error: failed to write to output file.\n" );
+			success = false;
+		}
+	}
+
+	// If even waiting failed, the kernel may still write into the buffers, so leak them rather than free them.
+	if ( reads_in_flight + writes_in_flight <= queue.to_submit ) {
+		for ( uint32_t i = 0; i < URING_IO_DEPTH; i++ ) {
+			free( slots[ i ].output_buffer );
+			free( slots[ i ].input_buffer );
+		}
+	}
+
+	free( carry );
+	queue_delete( &queue );
+
+	if ( fall_back ) {
+		return block_io_process( input_file, output_file, codec, buffer_size, stats );
+	}
+
+	return success;
+#else
+	return block_io_process( input_file, output_file, codec, buffer_size, stats );
+#endif
+}
@@ -0,0 +1,14 @@
+#ifndef __URING_IO_H__
+#define __URING_IO_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define URING_IO_DEPTH 4 // Number of buffers being read, processed, or written at once.
+
+bool uring_io_process( FILE *input_file, FILE *output_file, const BlockCodec *codec, size_t buffer_size, CodecStats *stats );
+
+#endif
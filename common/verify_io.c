@@ -0,0 +1,184 @@
+#include "verify_io.h"
+
+#include "block_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+// Description:
+// Waits until reading more bytes would keep the average read rate since the start at or under the limit.
+//
+// Parameters:
+// const struct timespec *start - When the first read started.
+// uint64_t bytes_read - The number of bytes read so far.
+// uint64_t max_rate - The limit in bytes per second.
+//
+// Returns:
+// Nothing.
+static void throttle( const struct timespec *start, uint64_t bytes_read, uint64_t max_rate ) {
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	double elapsed = ( double ) ( now.tv_sec - start->tv_sec ) + ( double ) ( now.tv_nsec - start->tv_nsec ) / 1e9;
+	double wait = ( double ) bytes_read / ( double ) max_rate - elapsed;
+
+	if ( wait <= 0 ) {
+		return;
+	}
+
+	struct timespec delay = { ( time_t ) wait, ( long ) ( ( wait - ( double ) ( time_t ) wait ) * 1e9 ) };
+
+	while ( nanosleep( &delay, &delay ) != 0 && errno == EINTR ) {
+	}
+}
+
+// Description:
+// Rewrites the pieces of a buffer that have correctable errors. Each piece is checked again, and only pieces with a
+// correctable error are repaired and written back at their offset, so a few errors only cost a few small writes.
+//
+// Parameters:
+// int fd - The file descriptor the buffer was read from.
+// off_t offset - The offset in the file of the start of the buffer.
+// uint8_t *buffer - The codes, which are repaired in place.
+// size_t units - The number of units in the buffer.
+// const BlockCodec *codec - The codec the buffer was checked with.
+// RepairFunction repair - Repairs a piece of the buffer in place.
+//
+// Returns:
+// bool - Whether every repaired piece could be written.
+static bool repair_buffer( int fd, off_t offset, uint8_t *buffer, size_t units, const BlockCodec *codec, RepairFunction repair ) {
+	size_t piece_units = VERIFY_IO_REPAIR_SIZE / codec->in_unit > 0 ? VERIFY_IO_REPAIR_SIZE / codec->in_unit : 1;
+
+	for ( size_t first = 0; first < units; first += piece_units ) {
+		size_t count = units - first < piece_units ? units - first : piece_units;
+		uint8_t *piece = buffer + first * codec->in_unit;
+		CodecStats piece_stats = { 0, 0, 0, 0 };
+		codec->process( piece, NULL, count, &piece_stats );
+
+		if ( piece_stats.corrected_errors > 0 && repair( piece, count ) > 0 && !block_io_pwrite_all( fd, piece, count * codec->in_unit, offset + first * codec->in_unit ) ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Description:
+// Reads the input file in large blocks and runs a checking codec over each block without writing anything. The kernel
+// is told the file is read sequentially, and each block's successor is requested before the block is checked, so the
+// disk reads ahead while the codec runs. The codec's process function is given NULL for its output. When repairing,
+// codes with correctable errors are rewritten in the input file, which must be a regular file open for writing.
+//
+// Parameters:
+// FILE *input_file - The file to read from.
+// const BlockCodec *codec - The codec to run over the data. Its out_unit is ignored.
+// RepairFunction repair - Repairs the codes of a number of units in place, returning how many codes it rewrote, or NULL
+// to only check the input.
+// size_t buffer_size - The size of the input buffer in bytes. Rounded down to a whole number of units.
+// uint64_t max_rate - The most bytes to read per second on average, or 0 for no limit. Reads are still a whole buffer at
+// a time, so a smaller buffer smooths out the rate.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, and repaired if asked to.
+bool verify_io_process( FILE *input_file, const BlockCodec *codec, RepairFunction repair, size_t buffer_size, uint64_t max_rate, CodecStats *stats ) {
+	int input_fd = fileno( input_file );
+	size_t buffer_units = buffer_size / codec->in_unit > 0 ? buffer_size / codec->in_unit : 1;
+	size_t buffer_length = buffer_units * codec->in_unit;
+	uint8_t *buffer = malloc( buffer_length );
+	off_t offset = lseek( input_fd, 0, SEEK_CUR ); // Negative for pipes, which can't be read ahead.
+	uint64_t bytes_read_total = 0;
+	uint64_t corrected_errors = stats->corrected_errors;
+	size_t buffered = 0;
+	bool repaired = false;
+	struct timespec start;
+
+	if ( repair && offset < 0 ) {
+		fprintf( stderr, "Error: only seekable files can be repaired.\n" );
+
+		return false;
+	}
+
+	if ( !buffer ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+
+		return false;
+	}
+
+	if ( offset >= 0 ) {
+		posix_fadvise( input_fd, offset, 0, POSIX_FADV_SEQUENTIAL );
+	}
+
+	clock_gettime( CLOCK_MONOTONIC, &start );
+
+	while ( true ) {
+		if ( max_rate ) {
+			throttle( &start, bytes_read_total, max_rate );
+		}
+
+		ssize_t bytes_read = block_io_read_full( input_fd, buffer + buffered, buffer_length - buffered );
+
+		if ( bytes_read < 0 ) {
+			fprintf( stderr, "Error: failed to read from input file.\n" );
+			free( buffer );
+
+			return false;
+		}
+
+		if ( bytes_read == 0 ) {
+			break;
+		}
+
+		bytes_read_total += bytes_read;
+		stats->total_bytes_processed += bytes_read;
+
+		if ( offset >= 0 ) {
+			offset += bytes_read;
+			posix_fadvise( input_fd, offset, buffer_length, POSIX_FADV_WILLNEED );
+		}
+
+		buffered += bytes_read;
+		size_t units = buffered / codec->in_unit;
+		codec->process( buffer, NULL, units, stats );
+
+		// Most buffers are clean, so only buffers with correctable errors are looked at again.
+		if ( repair && stats->corrected_errors > corrected_errors ) {
+			corrected_errors = stats->corrected_errors;
+			repaired = true;
+
+			if ( !repair_buffer( input_fd, offset - ( off_t ) buffered, buffer, units, codec, repair ) ) {
+				fprintf( stderr, "Error: failed to write repaired codes to input file.\n" );
+				free( buffer );
+
+				return false;
+			}
+		}
+
+		// Keep any partial unit for the next read.
+		buffered -= units * codec->in_unit;
+		memmove( buffer, buffer + units * codec->in_unit, buffered );
+	}
+
+	if ( buffered > 0 && codec->pad_tail ) {
+		memset( buffer + buffered, 0, codec->in_unit - buffered );
+		codec->process( buffer, NULL, 1, stats );
+	}
+
+	free( buffer );
+
+	if ( repaired && fdatasync( input_fd ) != 0 ) {
+		fprintf( stderr, "Error: failed to write repaired codes to input file.\n" );
+
+		return false;
+	}
+
+	return true;
+}
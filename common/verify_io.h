@@ -0,0 +1,17 @@
+#ifndef __VERIFY_IO_H__
+#define __VERIFY_IO_H__
+
+#include "block_io.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define VERIFY_IO_REPAIR_SIZE 4096 // Size in bytes of the pieces of a buffer with errors that are checked again and rewritten if they need repair.
+
+typedef size_t ( *RepairFunction )( uint8_t *codes, size_t units );
+
+bool verify_io_process( FILE *input_file, const BlockCodec *codec, RepairFunction repair, size_t buffer_size, uint64_t max_rate, CodecStats *stats );
+
+#endif
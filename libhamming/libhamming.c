@@ -0,0 +1,473 @@
+#include "libhamming.h"
+
+#include "hamming.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define RANGE_CODE_SIZE 4608 // Size in bytes of the codes read at once by hamming_decode_range, a whole number of units of both codes.
+
+// A codec context. Everything the codec needs lives here or in constant tables, so contexts never share mutable state.
+//
+// Members:
+// HAMMING_CODE code - The code used.
+// HAM_BACKEND backend - The resolved backend used by the block functions.
+// size_t data_unit - The number of data bytes in a unit.
+// size_t code_unit - The number of code bytes in a unit.
+// uint8_t pending[ HAM_72_64_CODE_SIZE ] - The partial unit carried between streaming calls.
+// size_t pending_length - The number of bytes in pending.
+struct HammingContext {
+	HAMMING_CODE code;
+	HAM_BACKEND backend;
+	size_t data_unit;
+	size_t code_unit;
+	uint8_t pending[ HAM_72_64_CODE_SIZE ];
+	size_t pending_length;
+};
+
+// Description:
+// Creates a codec context.
+//
+// Parameters:
+// HAMMING_CODE code - The code to use.
+// HAM_BACKEND backend - The backend to use. HAM_BACKEND_AUTO picks the fastest one the CPU supports.
+//
+// Returns:
+// HammingContext * - The created context, or NULL if the code or backend isn't supported or allocation failed.
+HammingContext *hamming_create( HAMMING_CODE code, HAM_BACKEND backend ) {
+	if ( ( code != HAMMING_CODE_8_4 && code != HAMMING_CODE_72_64 ) || !ham_backend_supported( backend ) ) {
+		return NULL;
+	}
+
+	HammingContext *context = calloc( 1, sizeof( HammingContext ) );
+
+	if ( !context ) {
+		return NULL;
+	}
+
+	context->code = code;
+	context->backend = ham_resolve_backend( backend );
+	context->data_unit = code == HAMMING_CODE_8_4 ? 1 : HAM_72_64_DATA_SIZE;
+	context->code_unit = code == HAMMING_CODE_8_4 ? 2 : HAM_72_64_CODE_SIZE;
+
+	return context;
+}
+
+// Description:
+// Deletes a codec context.
+//
+// Parameters:
+// HammingContext **context - A pointer to a pointer to a context.
+//
+// Returns:
+// Nothing.
+void hamming_delete( HammingContext **context ) {
+	if ( *context ) {
+		free( *context );
+		*context = NULL;
+	}
+}
+
+// Description:
+// Gets the number of data bytes in a unit, the data of one code for Hamming(72, 64) and of two codes for Hamming(8, 4).
+//
+// Parameters:
+// const HammingContext *context - The context.
+//
+// Returns:
+// size_t - The number of data bytes in a unit.
+size_t hamming_data_unit( const HammingContext *context ) {
+	return context->data_unit;
+}
+
+// Description:
+// Gets the number of code bytes in a unit.
+//
+// Parameters:
+// const HammingContext *context - The context.
+//
+// Returns:
+// size_t - The number of code bytes in a unit.
+size_t hamming_code_unit( const HammingContext *context ) {
+	return context->code_unit;
+}
+
+// Description:
+// Gets the number of code bytes hamming_encode outputs for some data, including the padded last unit.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// size_t n - The number of data bytes.
+//
+// Returns:
+// size_t - The number of code bytes.
+size_t hamming_encoded_size( const HammingContext *context, size_t n ) {
+	return ( n + context->data_unit - 1 ) / context->data_unit * context->code_unit;
+}
+
+// Description:
+// Gets the number of data bytes hamming_decode outputs for some codes. A trailing partial unit is dropped.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// size_t n - The number of code bytes.
+//
+// Returns:
+// size_t - The number of data bytes.
+size_t hamming_decoded_size( const HammingContext *context, size_t n ) {
+	return n / context->code_unit * context->data_unit;
+}
+
+// Description:
+// Encodes whole units with the context's code and backend.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// const uint8_t *in - The data to encode. Must hold units data units.
+// uint8_t *out - Where to put the codes. Must hold units code units.
+// size_t units - The number of units to encode.
+//
+// Returns:
+// Nothing.
+static void encode_units( const HammingContext *context, const uint8_t *in, uint8_t *out, size_t units ) {
+	if ( context->code == HAMMING_CODE_8_4 ) {
+		ham_encode_block_with( context->backend, in, out, units );
+	} else {
+		ham_encode_72_64_block_with( context->backend, in, out, units );
+	}
+}
+
+// Description:
+// Decodes whole units with the context's code and backend.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// const uint8_t *in - The codes to decode. Must hold units code units.
+// uint8_t *out - Where to put the data. Must hold units data units. Data of uncorrectable codes is set to 0.
+// size_t units - The number of units to decode.
+// HammingStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void decode_units( const HammingContext *context, const uint8_t *in, uint8_t *out, size_t units, HammingStats *stats ) {
+	if ( context->code == HAMMING_CODE_8_4 ) {
+		ham_decode_block_with( context->backend, in, out, units, NULL, &stats->corrected_errors, &stats->uncorrectable_errors );
+	} else {
+		ham_decode_72_64_block_with( context->backend, in, out, units, &stats->corrected_errors, &stats->uncorrectable_errors );
+	}
+}
+
+// Description:
+// Encodes a whole buffer. A partial last unit is padded with zeros. Only reads the context, so several threads may
+// encode with the same context at once.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// const uint8_t *in - The data to encode.
+// size_t n - The number of data bytes.
+// uint8_t *out - Where to put the codes. Must hold hamming_encoded_size( context, n ) bytes.
+//
+// Returns:
+// size_t - The number of code bytes output.
+size_t hamming_encode( const HammingContext *context, const uint8_t *in, size_t n, uint8_t *out ) {
+	size_t units = n / context->data_unit;
+	size_t tail = n % context->data_unit;
+	encode_units( context, in, out, units );
+
+	if ( tail > 0 ) {
+		uint8_t padded[ HAM_72_64_CODE_SIZE ] = { 0 };
+		memcpy( padded, in + units * context->data_unit, tail );
+		encode_units( context, padded, out + units * context->code_unit, 1 );
+		units++;
+	}
+
+	return units * context->code_unit;
+}
+
+// Description:
+// Decodes a whole buffer. A trailing partial unit is dropped. Only reads the context, so several threads may decode
+// with the same context at once.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// const uint8_t *in - The codes to decode.
+// size_t n - The number of code bytes.
+// uint8_t *out - Where to put the data. Must hold hamming_decoded_size( context, n ) bytes.
+// HammingStats *stats - The statistics to add to.
+//
+// Returns:
+// size_t - The number of data bytes output.
+size_t hamming_decode( const HammingContext *context, const uint8_t *in, size_t n, uint8_t *out, HammingStats *stats ) {
+	size_t units = n / context->code_unit;
+	stats->total_bytes_processed += n;
+	decode_units( context, in, out, units, stats );
+
+	return units * context->data_unit;
+}
+
+// Description:
+// Reads from an offset of a file descriptor until a buffer is full or the end of the file is reached, retrying on interrupts.
+//
+// Parameters:
+// int fd - The file descriptor to read from.
+// uint8_t *buffer - Where to put the data.
+// size_t length - The number of bytes to read.
+// off_t offset - The offset to read from.
+//
+// Returns:
+// ssize_t - The number of bytes read, or -1 upon failure.
+static ssize_t pread_full( int fd, uint8_t *buffer, size_t length, off_t offset ) {
+	size_t total = 0;
+
+	while ( total < length ) {
+		ssize_t bytes_read = pread( fd, buffer + total, length - total, offset + total );
+
+		if ( bytes_read < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+
+			return -1;
+		}
+
+		if ( bytes_read == 0 ) {
+			break;
+		}
+
+		total += bytes_read;
+	}
+
+	return total;
+}
+
+// Description:
+// Decodes a range of the data encoded in a file of codes without reading the codes before or after it. Since every unit
+// of data is encoded into a unit of codes at the same index, only the units overlapping the range are read with
+// pread(2), so fetching a small record from a large file costs a read of about twice its size, and the file's offset
+// isn't changed. Doesn't allocate memory and only reads the context, so several threads may decode ranges with the same
+// context at once.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// int fd - The file of codes, which start at the beginning of the file.
+// uint64_t offset - The offset of the range in the data.
+// size_t length - The number of bytes in the range.
+// uint8_t *out - Where to put the data. Must hold length bytes.
+// HammingStats *stats - The statistics to add to.
+//
+// Returns:
+// ssize_t - The number of data bytes output, which is less than length if the range runs past the last whole unit of
+// codes, or -1 if the file couldn't be read.
+ssize_t hamming_decode_range( const HammingContext *context, int fd, uint64_t offset, size_t length, uint8_t *out, HammingStats *stats ) {
+	uint8_t codes[ RANGE_CODE_SIZE ];
+	uint8_t data[ RANGE_CODE_SIZE ];
+	size_t buffer_units = RANGE_CODE_SIZE / context->code_unit;
+	uint64_t unit = offset / context->data_unit;
+	size_t skip = offset % context->data_unit; // Bytes of the first unit before the range.
+	size_t total = 0;
+
+	while ( total < length ) {
+		size_t needed = ( skip + length - total + context->data_unit - 1 ) / context->data_unit;
+		size_t units = needed < buffer_units ? needed : buffer_units;
+		ssize_t bytes_read = pread_full( fd, codes, units * context->code_unit, unit * context->code_unit );
+
+		if ( bytes_read < 0 ) {
+			return -1;
+		}
+
+		size_t whole_units = bytes_read / context->code_unit;
+		stats->total_bytes_processed += bytes_read;
+
+		if ( whole_units * context->data_unit <= skip ) {
+			break;
+		}
+
+		size_t decoded = whole_units * context->data_unit - skip;
+		decoded = decoded < length - total ? decoded : length - total;
+
+		if ( skip == 0 && decoded == whole_units * context->data_unit ) {
+			decode_units( context, codes, out + total, whole_units, stats ); // Whole units go straight to the output.
+		} else {
+			decode_units( context, codes, data, whole_units, stats );
+			memcpy( out + total, data + skip, decoded );
+		}
+
+		unit += whole_units;
+		skip = 0;
+		total += decoded;
+
+		if ( whole_units < units ) {
+			break;
+		}
+	}
+
+	return total;
+}
+
+// Description:
+// Drops any partial unit carried between streaming calls, so the context can start a new stream.
+//
+// Parameters:
+// HammingContext *context - The context.
+//
+// Returns:
+// Nothing.
+void hamming_stream_reset( HammingContext *context ) {
+	context->pending_length = 0;
+}
+
+// Description:
+// Runs whole units of a stream through the codec, finishing the carried partial unit first and carrying the new one.
+//
+// Parameters:
+// HammingContext *context - The context.
+// bool encode - Whether to encode instead of decode.
+// const uint8_t *in - The input.
+// size_t n - The number of input bytes.
+// uint8_t *out - Where to put the output.
+// HammingStats *stats - The statistics to add to when decoding.
+//
+// Returns:
+// size_t - The number of bytes output.
+static size_t stream_update( HammingContext *context, bool encode, const uint8_t *in, size_t n, uint8_t *out, HammingStats *stats ) {
+	size_t in_unit = encode ? context->data_unit : context->code_unit;
+	size_t out_unit = encode ? context->code_unit : context->data_unit;
+	size_t written = 0;
+
+	if ( context->pending_length > 0 ) {
+		size_t taken = n < in_unit - context->pending_length ? n : in_unit - context->pending_length;
+		memcpy( context->pending + context->pending_length, in, taken );
+		context->pending_length += taken;
+		in += taken;
+		n -= taken;
+
+		if ( context->pending_length < in_unit ) {
+			return 0;
+		}
+
+		if ( encode ) {
+			encode_units( context, context->pending, out, 1 );
+		} else {
+			decode_units( context, context->pending, out, 1, stats );
+		}
+
+		context->pending_length = 0;
+		written = out_unit;
+	}
+
+	size_t units = n / in_unit;
+
+	if ( encode ) {
+		encode_units( context, in, out + written, units );
+	} else {
+		decode_units( context, in, out + written, units, stats );
+	}
+
+	// Keep any partial unit for the next call.
+	context->pending_length = n - units * in_unit;
+	memcpy( context->pending, in + units * in_unit, context->pending_length );
+
+	return written + units * out_unit;
+}
+
+// Description:
+// Gets the number of code bytes the next hamming_encode_update call outputs.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// size_t n - The number of data bytes the call is given.
+//
+// Returns:
+// size_t - The number of code bytes.
+size_t hamming_encode_update_size( const HammingContext *context, size_t n ) {
+	return ( context->pending_length + n ) / context->data_unit * context->code_unit;
+}
+
+// Description:
+// Encodes the next piece of a stream. Data that doesn't fill a unit is carried to the next call.
+//
+// Parameters:
+// HammingContext *context - The context.
+// const uint8_t *in - The data to encode.
+// size_t n - The number of data bytes.
+// uint8_t *out - Where to put the codes. Must hold hamming_encode_update_size( context, n ) bytes.
+//
+// Returns:
+// size_t - The number of code bytes output.
+size_t hamming_encode_update( HammingContext *context, const uint8_t *in, size_t n, uint8_t *out ) {
+	return stream_update( context, true, in, n, out, NULL );
+}
+
+// Description:
+// Ends a stream being encoded, padding the carried partial unit with zeros and encoding it. Resets the stream.
+//
+// Parameters:
+// HammingContext *context - The context.
+// uint8_t *out - Where to put the codes. Must hold hamming_code_unit( context ) bytes.
+//
+// Returns:
+// size_t - The number of code bytes output.
+size_t hamming_encode_final( HammingContext *context, uint8_t *out ) {
+	if ( context->pending_length == 0 ) {
+		return 0;
+	}
+
+	memset( context->pending + context->pending_length, 0, context->data_unit - context->pending_length );
+	encode_units( context, context->pending, out, 1 );
+	context->pending_length = 0;
+
+	return context->code_unit;
+}
+
+// Description:
+// Gets the number of data bytes the next hamming_decode_update call outputs.
+//
+// Parameters:
+// const HammingContext *context - The context.
+// size_t n - The number of code bytes the call is given.
+//
+// Returns:
+// size_t - The number of data bytes.
+size_t hamming_decode_update_size( const HammingContext *context, size_t n ) {
+	return ( context->pending_length + n ) / context->code_unit * context->data_unit;
+}
+
+// Description:
+// Decodes the next piece of a stream. Codes that don't fill a unit, such as an odd trailing Hamming(8, 4) code, are
+// carried to the next call.
+//
+// Parameters:
+// HammingContext *context - The context.
+// const uint8_t *in - The codes to decode.
+// size_t n - The number of code bytes.
+// uint8_t *out - Where to put the data. Must hold hamming_decode_update_size( context, n ) bytes.
+// HammingStats *stats - The statistics to add to.
+//
+// Returns:
+// size_t - The number of data bytes output.
+size_t hamming_decode_update( HammingContext *context, const uint8_t *in, size_t n, uint8_t *out, HammingStats *stats ) {
+	stats->total_bytes_processed += n;
+
+	return stream_update( context, false, in, n, out, stats );
+}
+
+// Description:
+// Ends a stream being decoded, dropping the carried partial unit. Resets the stream.
+//
+// Parameters:
+// HammingContext *context - The context.
+//
+// Returns:
+// bool - Whether the stream ended on a whole unit.
+bool hamming_decode_final( HammingContext *context ) {
+	bool whole = context->pending_length == 0;
+	context->pending_length = 0;
+
+	return whole;
+}
@@ -0,0 +1,56 @@
+#ifndef __LIBHAMMING_H__
+#define __LIBHAMMING_H__
+
+#include "hamming.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef enum HAMMING_CODE {
+	HAMMING_CODE_8_4, // Hamming(8, 4), two code bytes per data byte.
+	HAMMING_CODE_72_64, // Hamming(72, 64), a check byte after every 8 data bytes.
+} HAMMING_CODE;
+
+typedef struct HammingStats {
+	uint64_t total_bytes_processed; // Number of code bytes given to the decoder.
+	uint64_t uncorrectable_errors; // Number of codes that could not be corrected.
+	uint64_t corrected_errors; // Number of codes that were corrected.
+} HammingStats;
+
+typedef struct HammingContext HammingContext;
+
+HammingContext *hamming_create( HAMMING_CODE code, HAM_BACKEND backend );
+
+void hamming_delete( HammingContext **context );
+
+size_t hamming_data_unit( const HammingContext *context );
+
+size_t hamming_code_unit( const HammingContext *context );
+
+size_t hamming_encoded_size( const HammingContext *context, size_t n );
+
+size_t hamming_decoded_size( const HammingContext *context, size_t n );
+
+size_t hamming_encode( const HammingContext *context, const uint8_t *in, size_t n, uint8_t *out );
+
+size_t hamming_decode( const HammingContext *context, const uint8_t *in, size_t n, uint8_t *out, HammingStats *stats );
+
+ssize_t hamming_decode_range( const HammingContext *context, int fd, uint64_t offset, size_t length, uint8_t *out, HammingStats *stats );
+
+void hamming_stream_reset( HammingContext *context );
+
+size_t hamming_encode_update_size( const HammingContext *context, size_t n );
+
+size_t hamming_encode_update( HammingContext *context, const uint8_t *in, size_t n, uint8_t *out );
+
+size_t hamming_encode_final( HammingContext *context, uint8_t *out );
+
+size_t hamming_decode_update_size( const HammingContext *context, size_t n );
+
+size_t hamming_decode_update( HammingContext *context, const uint8_t *in, size_t n, uint8_t *out, HammingStats *stats );
+
+bool hamming_decode_final( HammingContext *context );
+
+#endif
@@ -1,6 +1,64 @@
 #include "hamming.h"
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+
+#define HAM_X86 // Whether the SIMD backends can be built.
+#endif
+
+// Lookup table for the Hamming(8, 4) code of each nibble.
+static const uint8_t encode_lookup[ 16 ] = { 0, 225, 210, 51, 180, 85, 102, 135, 120, 153, 170, 75, 204, 45, 30, 255 };
+
+// Syndrome contributed by each value of a code's lower nibble. The upper nibble holds the parity bits, so it contributes itself.
+static const uint8_t syndrome_lookup[ 16 ] = { 0, 14, 13, 3, 11, 5, 6, 8, 7, 9, 10, 4, 12, 2, 1, 15 };
+
+// Bit of the data nibble to flip for each syndrome. Syndromes of the parity bits don't need a data bit flipped.
+static const uint8_t syndrome_data_flip[ 16 ] = { 0, 0, 0, 0, 0, 0, 0, 8, 0, 0, 0, 4, 0, 2, 1, 0 };
+
+// 0xFF for each syndrome of a single bit error.
+static const uint8_t syndrome_correctable[ 16 ] = { 0, 0xFF, 0xFF, 0, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0, 0xFF, 0, 0xFF, 0xFF, 0 };
+
+// 0xFF for each syndrome of an uncorrectable error.
+static const uint8_t syndrome_uncorrectable[ 16 ] = { 0, 0, 0, 0xFF, 0, 0xFF, 0xFF, 0, 0, 0xFF, 0xFF, 0, 0xFF, 0, 0, 0xFF };
+
+// Data bits checked by each check bit of a Hamming(72, 64) code. Check bit i is the parity of the data bits in mask i.
+static const uint64_t check_masks_72_64[ 8 ] = { 0x48ED348D221A4420, 0xA4DAAA4A91152210, 0x92B65926488C9108, 0x7171C711C4438884, 0x0F0FC0F03C207842, 0xFF003FF003E007C1,
+	0xFF00000FFFE0003F, 0xFF000000001FFFFF };
+
+// Flipped bit of a Hamming(72, 64) code for each syndrome, with 64 + i for check bit i, HAM_OK for no error, and HAM_ERR for uncorrectable errors.
+static const int8_t syndrome_bit_72_64[ 256 ] = { HAM_OK, 64, 65, HAM_ERR, 66, HAM_ERR, HAM_ERR, 55, 67, HAM_ERR, HAM_ERR, 54, HAM_ERR, 53, 52, HAM_ERR, 68, HAM_ERR, HAM_ERR, 51, HAM_ERR, 50, 49,
+	HAM_ERR, HAM_ERR, 48, 47, HAM_ERR, 46, HAM_ERR, HAM_ERR, HAM_ERR, 69, HAM_ERR, HAM_ERR, 45, HAM_ERR, 44, 43, HAM_ERR, HAM_ERR, 42, 41, HAM_ERR, 40, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 39, 38,
+	HAM_ERR, 37, HAM_ERR, HAM_ERR, HAM_ERR, 36, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 70, HAM_ERR, HAM_ERR, 35, HAM_ERR, 34, 33, HAM_ERR, HAM_ERR, 32, 31, HAM_ERR, 30,
+	HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 29, 28, HAM_ERR, 27, HAM_ERR, HAM_ERR, HAM_ERR, 26, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 25, 24, HAM_ERR, 23, HAM_ERR,
+	HAM_ERR, HAM_ERR, 22, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 21, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR,
+	HAM_ERR, HAM_ERR, HAM_ERR, 71, HAM_ERR, HAM_ERR, 20, HAM_ERR, 19, 18, HAM_ERR, HAM_ERR, 17, 16, HAM_ERR, 15, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 14, 13, HAM_ERR, 12, HAM_ERR, HAM_ERR, HAM_ERR, 11,
+	HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 10, 9, HAM_ERR, 8, HAM_ERR, HAM_ERR, HAM_ERR, 7, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 6, HAM_ERR,
+	HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 5, 4, HAM_ERR, 3, HAM_ERR, HAM_ERR, HAM_ERR, 2, HAM_ERR,
+	HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 1, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 0,
+	HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 63, HAM_ERR, HAM_ERR, 62, 61, HAM_ERR, 60, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, 59, 58, HAM_ERR, 57, HAM_ERR, HAM_ERR, HAM_ERR, 56, HAM_ERR, HAM_ERR,
+	HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR, HAM_ERR };
+
+// 8x8 bit matrices for gf2p8affineqb that map byte i of a Hamming(72, 64) code's data to its share of the check byte.
+static const uint64_t check_affine_72_64[ 8 ] = { 0x2010088442C13FFF, 0x44229188780700FF, 0x1A158C4320E0E01F, 0x229148C43C03FF00, 0x8D4A2611F0F00F00, 0x34AA59C7C03F0000, 0xEDDAB6710F000000,
+	0x48A492710FFFFFFF };
+
+// The backend requested with ham_set_backend.
+static HAM_BACKEND requested_backend = HAM_BACKEND_AUTO;
+
+// The codes of each byte's nibbles as they're laid out in memory, so a byte is encoded with one store. Built by build_pair_tables.
+static uint16_t encode_pair_lookup[ 256 ];
+
+// The decoded byte of each pair of codes as it's laid out in memory, or 0 if either is uncorrectable, with its HAM_BLOCK_* status bits above it. Built by build_pair_tables.
+static uint16_t decode_pair_lookup[ 65536 ];
+
+// Makes sure build_pair_tables runs once.
+static pthread_once_t pair_tables_once = PTHREAD_ONCE_INIT;
 
 // Description:
 // Encodes a 4-bit message into a Hamming(8, 4) code.
@@ -11,8 +69,6 @@
 // Returns:
 // uint8_t - The Hamming(8, 4) code.
 uint8_t ham_encode( uint8_t msg ) {
-	static const uint8_t encode_lookup[ 16 ] = { 0, 225, 210, 51, 180, 85, 102, 135, 120, 153, 170, 75, 204, 45, 30, 255 };
-
 	return encode_lookup[ msg & 0xF ];
 }
 
@@ -55,3 +111,1614 @@ HAM_STATUS ham_decode( uint8_t code, uint8_t *msg ) {
 
 	return correctness[ code ];
 }
+
+// Description:
+// Checks whether the CPU supports a backend.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to check.
+//
+// Returns:
+// bool - Whether the backend can be used.
+bool ham_backend_supported( HAM_BACKEND backend ) {
+	switch ( backend ) {
+	case HAM_BACKEND_AUTO:
+	case HAM_BACKEND_SCALAR:
+	case HAM_BACKEND_BITSLICE:
+	case HAM_BACKEND_PAIR: return true;
+#ifdef HAM_X86
+	case HAM_BACKEND_SSSE3: return __builtin_cpu_supports( "ssse3" );
+	case HAM_BACKEND_AVX2: return __builtin_cpu_supports( "avx2" );
+	case HAM_BACKEND_AVX512: return __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" );
+#endif
+	default: return false;
+	}
+}
+
+// Description:
+// Selects the backend used by the block functions.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to use. HAM_BACKEND_AUTO picks the fastest one the CPU supports.
+//
+// Returns:
+// bool - Whether the backend is supported. The previous backend is kept upon failure.
+bool ham_set_backend( HAM_BACKEND backend ) {
+	if ( !ham_backend_supported( backend ) ) {
+		return false;
+	}
+
+	requested_backend = backend;
+
+	return true;
+}
+
+// Description:
+// Gets the backend used by the block functions, resolving HAM_BACKEND_AUTO to the one it picks.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// HAM_BACKEND - The backend in use.
+HAM_BACKEND ham_get_backend( ) {
+	return ham_resolve_backend( requested_backend );
+}
+
+// Description:
+// Resolves HAM_BACKEND_AUTO to the fastest backend the CPU supports.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to resolve.
+//
+// Returns:
+// HAM_BACKEND - The fastest supported backend for HAM_BACKEND_AUTO, otherwise backend itself.
+HAM_BACKEND ham_resolve_backend( HAM_BACKEND backend ) {
+	if ( backend != HAM_BACKEND_AUTO ) {
+		return backend;
+	}
+
+	static const HAM_BACKEND preference[] = { HAM_BACKEND_AVX512, HAM_BACKEND_AVX2, HAM_BACKEND_SSSE3 };
+
+	for ( size_t i = 0; i < sizeof( preference ) / sizeof( *preference ); i++ ) {
+		if ( ham_backend_supported( preference[ i ] ) ) {
+			return preference[ i ];
+		}
+	}
+
+	return HAM_BACKEND_SCALAR;
+}
+
+// Description:
+// Reads a little-endian 64-bit word.
+//
+// Parameters:
+// const uint8_t *in - The bytes to read.
+//
+// Returns:
+// uint64_t - The word.
+static inline uint64_t load_64( const uint8_t *in ) {
+	uint64_t word = 0;
+	memcpy( &word, in, sizeof( word ) );
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	word = __builtin_bswap64( word );
+#endif
+
+	return word;
+}
+
+// Description:
+// Writes a little-endian 64-bit word.
+//
+// Parameters:
+// uint8_t *out - Where to write the word.
+// uint64_t word - The word.
+//
+// Returns:
+// Nothing.
+static inline void store_64( uint8_t *out, uint64_t word ) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	word = __builtin_bswap64( word );
+#endif
+
+	memcpy( out, &word, sizeof( word ) );
+}
+
+// Description:
+// Encodes bytes one at a time, outputting the lower nibble's code followed by the upper nibble's code for each byte.
+//
+// Parameters:
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes. Must hold 2 * n bytes.
+// size_t n - The number of bytes to encode.
+//
+// Returns:
+// Nothing.
+static void encode_block_scalar( const uint8_t *in, uint8_t *out, size_t n ) {
+	for ( size_t i = 0; i < n; i++ ) {
+		out[ 2 * i ] = encode_lookup[ in[ i ] & 0xF ];
+		out[ 2 * i + 1 ] = encode_lookup[ in[ i ] >> 4 ];
+	}
+}
+
+// Description:
+// Checks 8 codes for errors at once. Each parity bit of a code is the parity of its data bits other than the one 4 bits
+// below it, which is the parity of all of them XORed with that one.
+//
+// Parameters:
+// uint64_t codes - The 8 codes, read little-endian.
+//
+// Returns:
+// bool - Whether every code was error-free.
+static inline bool codes_clean_64( uint64_t codes ) {
+	uint64_t data = codes & 0x0F0F0F0F0F0F0F0F;
+	uint64_t parity = ( data ^ ( data >> 1 ) ^ ( data >> 2 ) ^ ( data >> 3 ) ) & 0x0101010101010101;
+
+	return ( ( codes >> 4 ) & 0x0F0F0F0F0F0F0F0F ) == ( data ^ ( parity * 0xF ) );
+}
+
+// Description:
+// Checks 4 code byte pairs for errors at once and decodes them if there are none.
+//
+// Parameters:
+// uint64_t codes - The 4 code byte pairs, read little-endian.
+// uint8_t *out - Where to put the 4 decoded bytes. Untouched if any code has an error.
+//
+// Returns:
+// bool - Whether every code was error-free.
+static inline bool decode_clean_64( uint64_t codes, uint8_t *out ) {
+	if ( !codes_clean_64( codes ) ) {
+		return false;
+	}
+
+	uint64_t data = codes & 0x0F0F0F0F0F0F0F0F;
+	uint64_t bytes = data | ( data >> 4 );
+
+	for ( uint32_t i = 0; i < 4; i++ ) {
+		out[ i ] = bytes >> ( 16 * i );
+	}
+
+	return true;
+}
+
+// Description:
+// Decodes code byte pairs one at a time with ham_decode.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode, the lower nibble's code followed by the upper nibble's code for each byte.
+// uint8_t *out - Where to put the decoded bytes. Must hold n bytes. Bytes with an uncorrectable nibble are set to 0.
+// size_t n - The number of bytes to decode.
+// uint8_t *status - Where to put the HAM_BLOCK_* bits of each byte. Must hold n bytes, or be NULL.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+static void decode_block_scalar( const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	size_t i = 0;
+
+	while ( i < n ) {
+		// Most codes have no errors, so only decode pairs one at a time when a group of 4 has one.
+		if ( i + 4 <= n && decode_clean_64( load_64( in + 2 * i ), out + i ) ) {
+			if ( status ) {
+				memset( status + i, 0, 4 );
+			}
+
+			i += 4;
+			continue;
+		}
+
+		uint8_t lower_nibble = 0;
+		uint8_t upper_nibble = 0;
+		HAM_STATUS lower_nibble_status = ham_decode( in[ 2 * i ], &lower_nibble );
+		HAM_STATUS upper_nibble_status = ham_decode( in[ 2 * i + 1 ], &upper_nibble );
+		*uncorrectable_errors += ( lower_nibble_status == HAM_ERR ) + ( upper_nibble_status == HAM_ERR );
+		*corrected_errors += ( lower_nibble_status == HAM_CORRECT ) + ( upper_nibble_status == HAM_CORRECT );
+
+		if ( status ) {
+			status[ i ] = ( lower_nibble_status == HAM_CORRECT ? HAM_BLOCK_LOWER_CORRECTED : 0 ) | ( lower_nibble_status == HAM_ERR ? HAM_BLOCK_LOWER_ERR : 0 )
+			    | ( upper_nibble_status == HAM_CORRECT ? HAM_BLOCK_UPPER_CORRECTED : 0 ) | ( upper_nibble_status == HAM_ERR ? HAM_BLOCK_UPPER_ERR : 0 );
+		}
+
+		// Output 0 upon failure.
+		out[ i ] = lower_nibble_status == HAM_ERR || upper_nibble_status == HAM_ERR ? 0 : ( upper_nibble << 4 ) | lower_nibble;
+		i++;
+	}
+}
+
+// Description:
+// Builds the pair tables from the Hamming(8, 4) tables. Called once through pair_tables_once.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// Nothing.
+static void build_pair_tables( ) {
+	uint8_t pair[ 2 ];
+
+	for ( uint32_t byte = 0; byte < 256; byte++ ) {
+		uint8_t msg = byte;
+		encode_block_scalar( &msg, pair, 1 );
+		memcpy( &encode_pair_lookup[ byte ], pair, sizeof( pair ) );
+	}
+
+	for ( uint32_t codes = 0; codes < 65536; codes++ ) {
+		uint8_t msg = 0;
+		uint8_t status = 0;
+		uint64_t corrected_errors = 0;
+		uint64_t uncorrectable_errors = 0;
+		pair[ 0 ] = codes & 0xFF;
+		pair[ 1 ] = codes >> 8;
+		decode_block_scalar( pair, &msg, 1, &status, &corrected_errors, &uncorrectable_errors );
+
+		uint16_t index = 0;
+		memcpy( &index, pair, sizeof( pair ) );
+		decode_pair_lookup[ index ] = ( uint16_t ) ( status << 8 | msg );
+	}
+}
+
+// Description:
+// Encodes bytes one at a time, storing both codes of each with one lookup in a 256-entry table.
+//
+// Parameters:
+// Same as encode_block_scalar.
+//
+// Returns:
+// Nothing.
+static void encode_block_pair( const uint8_t *in, uint8_t *out, size_t n ) {
+	pthread_once( &pair_tables_once, build_pair_tables );
+
+	for ( size_t i = 0; i < n; i++ ) {
+		memcpy( out + 2 * i, &encode_pair_lookup[ in[ i ] ], sizeof( uint16_t ) );
+	}
+}
+
+// Description:
+// Decodes code byte pairs one at a time, looking up the byte and status of both codes at once in a 65536-entry table.
+//
+// Parameters:
+// Same as decode_block_scalar.
+//
+// Returns:
+// Nothing.
+static void decode_block_pair( const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	pthread_once( &pair_tables_once, build_pair_tables );
+	uint64_t corrected = 0;
+	uint64_t uncorrectable = 0;
+
+	for ( size_t i = 0; i < n; i++ ) {
+		uint16_t codes = 0;
+		memcpy( &codes, in + 2 * i, sizeof( codes ) );
+		uint16_t entry = decode_pair_lookup[ codes ];
+		uint8_t flags = entry >> 8;
+		out[ i ] = entry & 0xFF;
+		corrected += ( flags & HAM_BLOCK_LOWER_CORRECTED ) + ( ( flags & HAM_BLOCK_UPPER_CORRECTED ) >> 2 );
+		uncorrectable += ( ( flags & HAM_BLOCK_LOWER_ERR ) >> 1 ) + ( ( flags & HAM_BLOCK_UPPER_ERR ) >> 3 );
+
+		if ( status ) {
+			status[ i ] = flags;
+		}
+	}
+
+	*corrected_errors += corrected;
+	*uncorrectable_errors += uncorrectable;
+}
+
+// Description:
+// Transposes an 8 x 8 block of bits by swapping ever smaller off-diagonal blocks, 4 x 4 down to 1 x 1.
+//
+// Parameters:
+// uint64_t block - The block. Row i is byte i, and column j of a row is bit j of the byte.
+//
+// Returns:
+// uint64_t - The transposed block.
+static inline uint64_t transpose_bits_8( uint64_t block ) {
+	uint64_t swapped = ( block ^ ( block >> 7 ) ) & 0x00AA00AA00AA00AA;
+	block ^= swapped ^ ( swapped << 7 );
+	swapped = ( block ^ ( block >> 14 ) ) & 0x0000CCCC0000CCCC;
+	block ^= swapped ^ ( swapped << 14 );
+	swapped = ( block ^ ( block >> 28 ) ) & 0x00000000F0F0F0F0;
+	block ^= swapped ^ ( swapped << 28 );
+
+	return block;
+}
+
+// Description:
+// Swaps the bytes of one row under a mask, shifted, with the bytes of another row under the mask.
+//
+// Parameters:
+// uint64_t *upper - The row whose bytes are shifted down.
+// uint64_t *lower - The other row.
+// uint64_t mask - The bytes of lower to swap.
+// uint32_t shift - The distance between the swapped bytes in bits.
+//
+// Returns:
+// Nothing.
+static inline void swap_bytes( uint64_t *upper, uint64_t *lower, uint64_t mask, uint32_t shift ) {
+	uint64_t swapped = ( ( *upper >> shift ) ^ *lower ) & mask;
+	*upper ^= swapped << shift;
+	*lower ^= swapped;
+}
+
+// Description:
+// Transposes an 8 x 8 block of bytes in place the same way transpose_bits_8 transposes bits.
+//
+// Parameters:
+// uint64_t *words - The 8 rows of the block. Column j of a row is byte j of the word.
+//
+// Returns:
+// Nothing.
+static inline void transpose_bytes_8( uint64_t *words ) {
+	for ( uint32_t row = 0; row < 4; row++ ) {
+		swap_bytes( &words[ row ], &words[ row + 4 ], 0x00000000FFFFFFFF, 32 );
+	}
+
+	for ( uint32_t row = 0; row < 8; row += row % 2 == 1 ? 3 : 1 ) {
+		swap_bytes( &words[ row ], &words[ row + 2 ], 0x0000FFFF0000FFFF, 16 );
+	}
+
+	for ( uint32_t row = 0; row < 8; row += 2 ) {
+		swap_bytes( &words[ row ], &words[ row + 1 ], 0x00FF00FF00FF00FF, 8 );
+	}
+}
+
+// Description:
+// Turns 64 bytes into 8 bit-planes, where bit i of plane j is bit j of byte i.
+//
+// Parameters:
+// const uint8_t *in - The 64 bytes.
+// uint64_t *planes - Where to put the 8 planes.
+//
+// Returns:
+// Nothing.
+static inline void bitslice_64( const uint8_t *in, uint64_t *planes ) {
+	for ( uint32_t i = 0; i < 8; i++ ) {
+		planes[ i ] = transpose_bits_8( load_64( in + 8 * i ) );
+	}
+
+	transpose_bytes_8( planes );
+}
+
+// Description:
+// Turns 8 bit-planes back into 64 bytes, undoing bitslice_64.
+//
+// Parameters:
+// uint64_t *planes - The 8 planes. Overwritten.
+// uint8_t *out - Where to put the 64 bytes.
+//
+// Returns:
+// Nothing.
+static inline void unbitslice_64( uint64_t *planes, uint8_t *out ) {
+	transpose_bytes_8( planes );
+
+	for ( uint32_t i = 0; i < 8; i++ ) {
+		store_64( out + 8 * i, transpose_bits_8( planes[ i ] ) );
+	}
+}
+
+// Description:
+// Gathers the even bits of a 64-bit word into a 32-bit word.
+//
+// Parameters:
+// uint64_t bits - The bits to gather.
+//
+// Returns:
+// uint64_t - The gathered bits.
+static inline uint64_t gather_32( uint64_t bits ) {
+	bits &= 0x5555555555555555;
+	bits = ( bits | ( bits >> 1 ) ) & 0x3333333333333333;
+	bits = ( bits | ( bits >> 2 ) ) & 0x0F0F0F0F0F0F0F0F;
+	bits = ( bits | ( bits >> 4 ) ) & 0x00FF00FF00FF00FF;
+	bits = ( bits | ( bits >> 8 ) ) & 0x0000FFFF0000FFFF;
+
+	return ( bits | ( bits >> 16 ) ) & 0x00000000FFFFFFFF;
+}
+
+// Description:
+// Decodes 64 bytes at a time by bit-slicing their 128 codes, 64 at a time. The syndrome planes take three XORs each, a
+// single bit error has an odd-weight syndrome, and the flipped data bit is fixed by matching its syndrome with masks.
+// The even and odd bits of the fixed data planes are then the lower and upper nibbles of the output. Only needs 64-bit
+// integer operations.
+//
+// Parameters:
+// Same as decode_block_scalar.
+//
+// Returns:
+// Nothing.
+static void decode_block_bitslice( const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	size_t i = 0;
+
+	for ( ; i + 64 <= n; i += 64 ) {
+		uint64_t msg[ 8 ] = { 0 };
+		uint64_t flags[ 8 ] = { 0 };
+
+		for ( uint32_t half = 0; half < 2; half++ ) {
+			uint64_t c[ 8 ];
+			bitslice_64( in + 2 * i + 64 * half, c );
+			uint64_t s0 = c[ 4 ] ^ c[ 1 ] ^ c[ 2 ] ^ c[ 3 ];
+			uint64_t s1 = c[ 5 ] ^ c[ 0 ] ^ c[ 2 ] ^ c[ 3 ];
+			uint64_t s2 = c[ 6 ] ^ c[ 0 ] ^ c[ 1 ] ^ c[ 3 ];
+			uint64_t s3 = c[ 7 ] ^ c[ 0 ] ^ c[ 1 ] ^ c[ 2 ];
+			uint64_t correctable = s0 ^ s1 ^ s2 ^ s3;
+			uint64_t uncorrectable = ( s0 | s1 | s2 | s3 ) & ~correctable;
+			*corrected_errors += __builtin_popcountll( correctable );
+			*uncorrectable_errors += __builtin_popcountll( uncorrectable );
+
+			// Data bit i's syndrome has every bit but bit i set.
+			uint64_t d[ 4 ] = { c[ 0 ] ^ ( ~s0 & s1 & s2 & s3 ), c[ 1 ] ^ ( s0 & ~s1 & s2 & s3 ), c[ 2 ] ^ ( s0 & s1 & ~s2 & s3 ), c[ 3 ] ^ ( s0 & s1 & s2 & ~s3 ) };
+
+			// Output 0 upon failure.
+			uint64_t keep = ~gather_32( uncorrectable | ( uncorrectable >> 1 ) ) << ( 32 * half );
+
+			for ( uint32_t bit = 0; bit < 4; bit++ ) {
+				msg[ bit ] |= ( gather_32( d[ bit ] ) << ( 32 * half ) ) & keep;
+				msg[ bit + 4 ] |= ( gather_32( d[ bit ] >> 1 ) << ( 32 * half ) ) & keep;
+			}
+
+			flags[ 0 ] |= gather_32( correctable ) << ( 32 * half );
+			flags[ 1 ] |= gather_32( uncorrectable ) << ( 32 * half );
+			flags[ 2 ] |= gather_32( correctable >> 1 ) << ( 32 * half );
+			flags[ 3 ] |= gather_32( uncorrectable >> 1 ) << ( 32 * half );
+		}
+
+		unbitslice_64( msg, out + i );
+
+		if ( status ) {
+			unbitslice_64( flags, status + i );
+		}
+	}
+
+	decode_block_scalar( in + 2 * i, out + i, n - i, status ? status + i : NULL, corrected_errors, uncorrectable_errors );
+}
+
+#ifdef HAM_X86
+// Description:
+// Encodes 16 bytes at a time by looking up both nibbles with pshufb and interleaving the codes.
+//
+// Parameters:
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes. Must hold 2 * n bytes.
+// size_t n - The number of bytes to encode.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "ssse3" ) ) ) static void encode_block_ssse3( const uint8_t *in, uint8_t *out, size_t n ) {
+	const __m128i table = _mm_loadu_si128( ( const __m128i * ) encode_lookup );
+	const __m128i nibble_mask = _mm_set1_epi8( 0xF );
+	size_t i = 0;
+
+	for ( ; i + 16 <= n; i += 16 ) {
+		__m128i bytes = _mm_loadu_si128( ( const __m128i * ) ( in + i ) );
+		__m128i lower_codes = _mm_shuffle_epi8( table, _mm_and_si128( bytes, nibble_mask ) );
+		__m128i upper_codes = _mm_shuffle_epi8( table, _mm_and_si128( _mm_srli_epi16( bytes, 4 ), nibble_mask ) );
+		_mm_storeu_si128( ( __m128i * ) ( out + 2 * i ), _mm_unpacklo_epi8( lower_codes, upper_codes ) );
+		_mm_storeu_si128( ( __m128i * ) ( out + 2 * i + 16 ), _mm_unpackhi_epi8( lower_codes, upper_codes ) );
+	}
+
+	encode_block_scalar( in + i, out + 2 * i, n - i );
+}
+
+// Description:
+// Encodes 32 bytes at a time by looking up both nibbles with vpshufb and interleaving the codes.
+//
+// Parameters:
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes. Must hold 2 * n bytes.
+// size_t n - The number of bytes to encode.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx2" ) ) ) static void encode_block_avx2( const uint8_t *in, uint8_t *out, size_t n ) {
+	const __m256i table = _mm256_broadcastsi128_si256( _mm_loadu_si128( ( const __m128i * ) encode_lookup ) );
+	const __m256i nibble_mask = _mm256_set1_epi8( 0xF );
+	size_t i = 0;
+
+	for ( ; i + 32 <= n; i += 32 ) {
+		__m256i bytes = _mm256_loadu_si256( ( const __m256i * ) ( in + i ) );
+		__m256i lower_codes = _mm256_shuffle_epi8( table, _mm256_and_si256( bytes, nibble_mask ) );
+		__m256i upper_codes = _mm256_shuffle_epi8( table, _mm256_and_si256( _mm256_srli_epi16( bytes, 4 ), nibble_mask ) );
+		// Unpacking works within 128-bit lanes, so swap the middle lanes back into order.
+		__m256i low_half = _mm256_unpacklo_epi8( lower_codes, upper_codes );
+		__m256i high_half = _mm256_unpackhi_epi8( lower_codes, upper_codes );
+		_mm256_storeu_si256( ( __m256i * ) ( out + 2 * i ), _mm256_permute2x128_si256( low_half, high_half, 0x20 ) );
+		_mm256_storeu_si256( ( __m256i * ) ( out + 2 * i + 32 ), _mm256_permute2x128_si256( low_half, high_half, 0x31 ) );
+	}
+
+	encode_block_ssse3( in + i, out + 2 * i, n - i );
+}
+
+// Description:
+// Encodes 64 bytes at a time by looking up both nibbles with vpshufb and interleaving the codes.
+//
+// Parameters:
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes. Must hold 2 * n bytes.
+// size_t n - The number of bytes to encode.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx512f,avx512bw" ) ) ) static void encode_block_avx512( const uint8_t *in, uint8_t *out, size_t n ) {
+	const __m512i table = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i * ) encode_lookup ) );
+	const __m512i nibble_mask = _mm512_set1_epi8( 0xF );
+	// Unpacking works within 128-bit lanes, so interleave the lanes of both halves back into order.
+	const __m512i first_order = _mm512_set_epi64( 11, 10, 3, 2, 9, 8, 1, 0 );
+	const __m512i second_order = _mm512_set_epi64( 15, 14, 7, 6, 13, 12, 5, 4 );
+	size_t i = 0;
+
+	for ( ; i + 64 <= n; i += 64 ) {
+		__m512i bytes = _mm512_loadu_si512( ( const void * ) ( in + i ) );
+		__m512i lower_codes = _mm512_shuffle_epi8( table, _mm512_and_si512( bytes, nibble_mask ) );
+		__m512i upper_codes = _mm512_shuffle_epi8( table, _mm512_and_si512( _mm512_srli_epi16( bytes, 4 ), nibble_mask ) );
+		__m512i low_half = _mm512_unpacklo_epi8( lower_codes, upper_codes );
+		__m512i high_half = _mm512_unpackhi_epi8( lower_codes, upper_codes );
+		_mm512_storeu_si512( ( void * ) ( out + 2 * i ), _mm512_permutex2var_epi64( low_half, first_order, high_half ) );
+		_mm512_storeu_si512( ( void * ) ( out + 2 * i + 64 ), _mm512_permutex2var_epi64( low_half, second_order, high_half ) );
+	}
+
+	encode_block_avx2( in + i, out + 2 * i, n - i );
+}
+#endif
+
+// Description:
+// Encodes a block of bytes into Hamming(8, 4) codes using a backend.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to use. Must be resolved and supported by the CPU.
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes, the lower nibble's code followed by the upper nibble's code for each byte. Must hold 2 * n bytes.
+// size_t n - The number of bytes to encode.
+//
+// Returns:
+// Nothing.
+void ham_encode_block_with( HAM_BACKEND backend, const uint8_t *in, uint8_t *out, size_t n ) {
+	switch ( backend ) {
+#ifdef HAM_X86
+	case HAM_BACKEND_SSSE3: encode_block_ssse3( in, out, n ); break;
+	case HAM_BACKEND_AVX2: encode_block_avx2( in, out, n ); break;
+	case HAM_BACKEND_AVX512: encode_block_avx512( in, out, n ); break;
+#endif
+	case HAM_BACKEND_PAIR: encode_block_pair( in, out, n ); break;
+	default: encode_block_scalar( in, out, n ); break;
+	}
+}
+
+// Description:
+// Encodes a block of bytes into Hamming(8, 4) codes using the selected backend.
+//
+// Parameters:
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes, the lower nibble's code followed by the upper nibble's code for each byte. Must hold 2 * n bytes.
+// size_t n - The number of bytes to encode.
+//
+// Returns:
+// Nothing.
+void ham_encode_block( const uint8_t *in, uint8_t *out, size_t n ) {
+	ham_encode_block_with( ham_get_backend( ), in, out, n );
+}
+
+#ifdef HAM_X86
+// Description:
+// Computes the syndromes of 16 codes with pshufb. The syndrome is the lower nibble's syndrome XORed with the upper nibble.
+//
+// Parameters:
+// __m128i codes - The codes.
+//
+// Returns:
+// __m128i - The syndrome of each code.
+__attribute__( ( target( "ssse3" ) ) ) static inline __m128i syndromes_ssse3( __m128i codes ) {
+	const __m128i nibble_mask = _mm_set1_epi8( 0xF );
+
+	return _mm_xor_si128( _mm_shuffle_epi8( _mm_loadu_si128( ( const __m128i * ) syndrome_lookup ), _mm_and_si128( codes, nibble_mask ) ), _mm_and_si128( _mm_srli_epi16( codes, 4 ), nibble_mask ) );
+}
+
+// Description:
+// Joins the data nibbles of 8 code byte pairs with no errors.
+//
+// Parameters:
+// __m128i codes - The codes.
+//
+// Returns:
+// __m128i - Each pair's decoded byte in its low byte.
+__attribute__( ( target( "ssse3" ) ) ) static inline __m128i clean_bytes_ssse3( __m128i codes ) {
+	const __m128i nibbles = _mm_and_si128( codes, _mm_set1_epi8( 0xF ) );
+
+	return _mm_and_si128( _mm_or_si128( nibbles, _mm_srli_epi16( nibbles, 4 ) ), _mm_set1_epi16( 0xFF ) );
+}
+
+// Description:
+// Decodes 16 codes with pshufb, fixing the flipped data bit with a lookup by syndrome.
+//
+// Parameters:
+// __m128i codes - The codes, with each pair of bytes holding the lower nibble's code followed by the upper nibble's code.
+// __m128i syndromes - The syndrome of each code.
+// __m128i *status - Where to put each pair's HAM_BLOCK_* bits in its low byte.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// __m128i - Each pair's decoded byte in its low byte, or 0 if either code was uncorrectable.
+__attribute__( ( target( "ssse3" ) ) ) static inline __m128i decode_vector_ssse3( __m128i codes, __m128i syndromes, __m128i *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	const __m128i lower_nibbles = _mm_and_si128( codes, _mm_set1_epi8( 0xF ) );
+	const __m128i nibbles = _mm_xor_si128( lower_nibbles, _mm_shuffle_epi8( _mm_loadu_si128( ( const __m128i * ) syndrome_data_flip ), syndromes ) );
+	const __m128i correctable = _mm_shuffle_epi8( _mm_loadu_si128( ( const __m128i * ) syndrome_correctable ), syndromes );
+	const __m128i uncorrectable = _mm_shuffle_epi8( _mm_loadu_si128( ( const __m128i * ) syndrome_uncorrectable ), syndromes );
+	*corrected_errors += __builtin_popcount( _mm_movemask_epi8( correctable ) );
+	*uncorrectable_errors += __builtin_popcount( _mm_movemask_epi8( uncorrectable ) );
+
+	if ( status ) {
+		__m128i code_status = _mm_or_si128( _mm_and_si128( correctable, _mm_set1_epi8( HAM_BLOCK_LOWER_CORRECTED ) ), _mm_and_si128( uncorrectable, _mm_set1_epi8( HAM_BLOCK_LOWER_ERR ) ) );
+		*status = _mm_and_si128( _mm_or_si128( code_status, _mm_srli_epi16( code_status, 6 ) ), _mm_set1_epi16( 0xF ) );
+	}
+
+	// Join the nibbles of each pair, zeroing pairs where either code was uncorrectable.
+	__m128i bytes = _mm_and_si128( _mm_or_si128( nibbles, _mm_srli_epi16( nibbles, 4 ) ), _mm_set1_epi16( 0xFF ) );
+
+	return _mm_andnot_si128( _mm_cmpeq_epi16( _mm_cmpeq_epi16( uncorrectable, _mm_setzero_si128( ) ), _mm_setzero_si128( ) ), bytes );
+}
+
+// Description:
+// Decodes 16 bytes at a time with pshufb.
+//
+// Parameters:
+// Same as decode_block_scalar.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "ssse3" ) ) ) static void decode_block_ssse3( const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	size_t i = 0;
+
+	for ( ; i + 16 <= n; i += 16 ) {
+		__m128i first_codes = _mm_loadu_si128( ( const __m128i * ) ( in + 2 * i ) );
+		__m128i second_codes = _mm_loadu_si128( ( const __m128i * ) ( in + 2 * i + 16 ) );
+		__m128i first_syndromes = syndromes_ssse3( first_codes );
+		__m128i second_syndromes = syndromes_ssse3( second_codes );
+
+		// Most blocks have no errors, so skip the correction and counting when every syndrome is zero.
+		if ( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_or_si128( first_syndromes, second_syndromes ), _mm_setzero_si128( ) ) ) == 0xFFFF ) {
+			_mm_storeu_si128( ( __m128i * ) ( out + i ), _mm_packus_epi16( clean_bytes_ssse3( first_codes ), clean_bytes_ssse3( second_codes ) ) );
+
+			if ( status ) {
+				_mm_storeu_si128( ( __m128i * ) ( status + i ), _mm_setzero_si128( ) );
+			}
+
+			continue;
+		}
+
+		__m128i first_status = _mm_setzero_si128( );
+		__m128i second_status = _mm_setzero_si128( );
+		__m128i first = decode_vector_ssse3( first_codes, first_syndromes, status ? &first_status : NULL, corrected_errors, uncorrectable_errors );
+		__m128i second = decode_vector_ssse3( second_codes, second_syndromes, status ? &second_status : NULL, corrected_errors, uncorrectable_errors );
+		_mm_storeu_si128( ( __m128i * ) ( out + i ), _mm_packus_epi16( first, second ) );
+
+		if ( status ) {
+			_mm_storeu_si128( ( __m128i * ) ( status + i ), _mm_packus_epi16( first_status, second_status ) );
+		}
+	}
+
+	decode_block_scalar( in + 2 * i, out + i, n - i, status ? status + i : NULL, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Computes the syndromes of 32 codes with vpshufb. Works the same way as syndromes_ssse3.
+//
+// Parameters:
+// __m256i codes - The codes.
+//
+// Returns:
+// __m256i - The syndrome of each code.
+__attribute__( ( target( "avx2" ) ) ) static inline __m256i syndromes_avx2( __m256i codes ) {
+	const __m256i nibble_mask = _mm256_set1_epi8( 0xF );
+
+	return _mm256_xor_si256( _mm256_shuffle_epi8( _mm256_broadcastsi128_si256( _mm_loadu_si128( ( const __m128i * ) syndrome_lookup ) ), _mm256_and_si256( codes, nibble_mask ) ),
+	    _mm256_and_si256( _mm256_srli_epi16( codes, 4 ), nibble_mask ) );
+}
+
+// Description:
+// Joins the data nibbles of 16 code byte pairs with no errors.
+//
+// Parameters:
+// __m256i codes - The codes.
+//
+// Returns:
+// __m256i - Each pair's decoded byte in its low byte.
+__attribute__( ( target( "avx2" ) ) ) static inline __m256i clean_bytes_avx2( __m256i codes ) {
+	const __m256i nibbles = _mm256_and_si256( codes, _mm256_set1_epi8( 0xF ) );
+
+	return _mm256_and_si256( _mm256_or_si256( nibbles, _mm256_srli_epi16( nibbles, 4 ) ), _mm256_set1_epi16( 0xFF ) );
+}
+
+// Description:
+// Decodes 32 codes with vpshufb. Works the same way as decode_vector_ssse3.
+//
+// Parameters:
+// Same as decode_vector_ssse3.
+//
+// Returns:
+// __m256i - Each pair's decoded byte in its low byte, or 0 if either code was uncorrectable.
+__attribute__( ( target( "avx2" ) ) ) static inline __m256i decode_vector_avx2( __m256i codes, __m256i syndromes, __m256i *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	const __m256i lower_nibbles = _mm256_and_si256( codes, _mm256_set1_epi8( 0xF ) );
+	const __m256i nibbles = _mm256_xor_si256( lower_nibbles, _mm256_shuffle_epi8( _mm256_broadcastsi128_si256( _mm_loadu_si128( ( const __m128i * ) syndrome_data_flip ) ), syndromes ) );
+	const __m256i correctable = _mm256_shuffle_epi8( _mm256_broadcastsi128_si256( _mm_loadu_si128( ( const __m128i * ) syndrome_correctable ) ), syndromes );
+	const __m256i uncorrectable = _mm256_shuffle_epi8( _mm256_broadcastsi128_si256( _mm_loadu_si128( ( const __m128i * ) syndrome_uncorrectable ) ), syndromes );
+	*corrected_errors += __builtin_popcount( _mm256_movemask_epi8( correctable ) );
+	*uncorrectable_errors += __builtin_popcount( _mm256_movemask_epi8( uncorrectable ) );
+
+	if ( status ) {
+		__m256i code_status = _mm256_or_si256( _mm256_and_si256( correctable, _mm256_set1_epi8( HAM_BLOCK_LOWER_CORRECTED ) ), _mm256_and_si256( uncorrectable, _mm256_set1_epi8( HAM_BLOCK_LOWER_ERR ) ) );
+		*status = _mm256_and_si256( _mm256_or_si256( code_status, _mm256_srli_epi16( code_status, 6 ) ), _mm256_set1_epi16( 0xF ) );
+	}
+
+	__m256i bytes = _mm256_and_si256( _mm256_or_si256( nibbles, _mm256_srli_epi16( nibbles, 4 ) ), _mm256_set1_epi16( 0xFF ) );
+
+	return _mm256_andnot_si256( _mm256_cmpeq_epi16( _mm256_cmpeq_epi16( uncorrectable, _mm256_setzero_si256( ) ), _mm256_setzero_si256( ) ), bytes );
+}
+
+// Description:
+// Decodes 32 bytes at a time with vpshufb.
+//
+// Parameters:
+// Same as decode_block_scalar.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx2" ) ) ) static void decode_block_avx2( const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	size_t i = 0;
+
+	for ( ; i + 32 <= n; i += 32 ) {
+		__m256i first_codes = _mm256_loadu_si256( ( const __m256i * ) ( in + 2 * i ) );
+		__m256i second_codes = _mm256_loadu_si256( ( const __m256i * ) ( in + 2 * i + 32 ) );
+		__m256i first_syndromes = syndromes_avx2( first_codes );
+		__m256i second_syndromes = syndromes_avx2( second_codes );
+		__m256i syndromes = _mm256_or_si256( first_syndromes, second_syndromes );
+
+		// Most blocks have no errors, so skip the correction and counting when every syndrome is zero.
+		if ( _mm256_testz_si256( syndromes, syndromes ) ) {
+			_mm256_storeu_si256( ( __m256i * ) ( out + i ), _mm256_permute4x64_epi64( _mm256_packus_epi16( clean_bytes_avx2( first_codes ), clean_bytes_avx2( second_codes ) ), 0xD8 ) );
+
+			if ( status ) {
+				_mm256_storeu_si256( ( __m256i * ) ( status + i ), _mm256_setzero_si256( ) );
+			}
+
+			continue;
+		}
+
+		__m256i first_status = _mm256_setzero_si256( );
+		__m256i second_status = _mm256_setzero_si256( );
+		__m256i first = decode_vector_avx2( first_codes, first_syndromes, status ? &first_status : NULL, corrected_errors, uncorrectable_errors );
+		__m256i second = decode_vector_avx2( second_codes, second_syndromes, status ? &second_status : NULL, corrected_errors, uncorrectable_errors );
+		// Packing works within 128-bit lanes, so swap the middle quarters back into order.
+		_mm256_storeu_si256( ( __m256i * ) ( out + i ), _mm256_permute4x64_epi64( _mm256_packus_epi16( first, second ), 0xD8 ) );
+
+		if ( status ) {
+			_mm256_storeu_si256( ( __m256i * ) ( status + i ), _mm256_permute4x64_epi64( _mm256_packus_epi16( first_status, second_status ), 0xD8 ) );
+		}
+	}
+
+	decode_block_ssse3( in + 2 * i, out + i, n - i, status ? status + i : NULL, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Decodes 32 bytes at a time with vpshufb and mask registers.
+//
+// Parameters:
+// Same as decode_block_scalar.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx512f,avx512bw" ) ) ) static void decode_block_avx512( const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	const __m512i nibble_mask = _mm512_set1_epi8( 0xF );
+	const __m512i syndrome_table = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i * ) syndrome_lookup ) );
+	const __m512i flip_table = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i * ) syndrome_data_flip ) );
+	const __m512i correctable_table = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i * ) syndrome_correctable ) );
+	const __m512i uncorrectable_table = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i * ) syndrome_uncorrectable ) );
+	size_t i = 0;
+
+	for ( ; i + 32 <= n; i += 32 ) {
+		__m512i codes = _mm512_loadu_si512( ( const void * ) ( in + 2 * i ) );
+		__m512i lower_nibbles = _mm512_and_si512( codes, nibble_mask );
+		__m512i syndromes = _mm512_xor_si512( _mm512_shuffle_epi8( syndrome_table, lower_nibbles ), _mm512_and_si512( _mm512_srli_epi16( codes, 4 ), nibble_mask ) );
+
+		// Most blocks have no errors, so skip the correction and counting when every syndrome is zero.
+		if ( !_mm512_test_epi8_mask( syndromes, syndromes ) ) {
+			_mm256_storeu_si256( ( __m256i * ) ( out + i ), _mm512_cvtepi16_epi8( _mm512_or_si512( lower_nibbles, _mm512_srli_epi16( lower_nibbles, 4 ) ) ) );
+
+			if ( status ) {
+				_mm256_storeu_si256( ( __m256i * ) ( status + i ), _mm256_setzero_si256( ) );
+			}
+
+			continue;
+		}
+
+		__m512i nibbles = _mm512_xor_si512( lower_nibbles, _mm512_shuffle_epi8( flip_table, syndromes ) );
+		__m512i correctable = _mm512_shuffle_epi8( correctable_table, syndromes );
+		__m512i uncorrectable = _mm512_shuffle_epi8( uncorrectable_table, syndromes );
+		*corrected_errors += __builtin_popcountll( _mm512_movepi8_mask( correctable ) );
+		*uncorrectable_errors += __builtin_popcountll( _mm512_movepi8_mask( uncorrectable ) );
+
+		if ( status ) {
+			__m512i code_status = _mm512_or_si512( _mm512_and_si512( correctable, _mm512_set1_epi8( HAM_BLOCK_LOWER_CORRECTED ) ), _mm512_and_si512( uncorrectable, _mm512_set1_epi8( HAM_BLOCK_LOWER_ERR ) ) );
+			__m512i pair_status = _mm512_or_si512( code_status, _mm512_srli_epi16( code_status, 6 ) );
+			_mm256_storeu_si256( ( __m256i * ) ( status + i ), _mm512_cvtepi16_epi8( _mm512_and_si512( pair_status, _mm512_set1_epi16( 0xF ) ) ) );
+		}
+
+		// Join the nibbles of each pair, zeroing pairs where either code was uncorrectable.
+		__mmask32 valid_pairs = _mm512_testn_epi16_mask( uncorrectable, uncorrectable );
+		__m512i bytes = _mm512_maskz_mov_epi16( valid_pairs, _mm512_or_si512( nibbles, _mm512_srli_epi16( nibbles, 4 ) ) );
+		_mm256_storeu_si256( ( __m256i * ) ( out + i ), _mm512_cvtepi16_epi8( bytes ) );
+	}
+
+	decode_block_avx2( in + 2 * i, out + i, n - i, status ? status + i : NULL, corrected_errors, uncorrectable_errors );
+}
+#endif
+
+// Description:
+// Decodes a block of Hamming(8, 4) code pairs using a backend.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to use. Must be resolved and supported by the CPU.
+// const uint8_t *in - The codes to decode, the lower nibble's code followed by the upper nibble's code for each byte. Must hold 2 * n bytes.
+// uint8_t *out - Where to put the decoded bytes. Must hold n bytes. Bytes with an uncorrectable nibble are set to 0.
+// size_t n - The number of bytes to decode.
+// uint8_t *status - Where to put the HAM_BLOCK_* bits of each byte. Must hold n bytes, or be NULL if not needed.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_decode_block_with( HAM_BACKEND backend, const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	switch ( backend ) {
+#ifdef HAM_X86
+	case HAM_BACKEND_SSSE3: decode_block_ssse3( in, out, n, status, corrected_errors, uncorrectable_errors ); break;
+	case HAM_BACKEND_AVX2: decode_block_avx2( in, out, n, status, corrected_errors, uncorrectable_errors ); break;
+	case HAM_BACKEND_AVX512: decode_block_avx512( in, out, n, status, corrected_errors, uncorrectable_errors ); break;
+#endif
+	case HAM_BACKEND_PAIR: decode_block_pair( in, out, n, status, corrected_errors, uncorrectable_errors ); break;
+	case HAM_BACKEND_BITSLICE: decode_block_bitslice( in, out, n, status, corrected_errors, uncorrectable_errors ); break;
+	default: decode_block_scalar( in, out, n, status, corrected_errors, uncorrectable_errors ); break;
+	}
+}
+
+// Description:
+// Decodes a block of Hamming(8, 4) code pairs using the selected backend.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode, the lower nibble's code followed by the upper nibble's code for each byte. Must hold 2 * n bytes.
+// uint8_t *out - Where to put the decoded bytes. Must hold n bytes. Bytes with an uncorrectable nibble are set to 0.
+// size_t n - The number of bytes to decode.
+// uint8_t *status - Where to put the HAM_BLOCK_* bits of each byte. Must hold n bytes, or be NULL if not needed.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_decode_block( const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	ham_decode_block_with( ham_get_backend( ), in, out, n, status, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Counts the corrected and uncorrectable codes in a block without decoding it. Groups of 8 codes are checked at once,
+// and only groups with an error are looked at one code at a time.
+//
+// Parameters:
+// const uint8_t *in - The codes to check.
+// size_t n - The number of codes to check.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+static void verify_block_scalar( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	uint64_t corrected = 0;
+	uint64_t uncorrectable = 0;
+	size_t i = 0;
+
+	while ( i < n ) {
+		if ( i + 8 <= n && codes_clean_64( load_64( in + i ) ) ) {
+			i += 8;
+			continue;
+		}
+
+		for ( size_t end = i + 8 <= n ? i + 8 : n; i < end; i++ ) {
+			uint8_t syndrome = syndrome_lookup[ in[ i ] & 0xF ] ^ ( in[ i ] >> 4 );
+			corrected += syndrome_correctable[ syndrome ] & 1;
+			uncorrectable += syndrome_uncorrectable[ syndrome ] & 1;
+		}
+	}
+
+	*corrected_errors += corrected;
+	*uncorrectable_errors += uncorrectable;
+}
+
+#ifdef HAM_X86
+// Description:
+// Counts the corrected and uncorrectable codes among 16 syndromes with pshufb.
+//
+// Parameters:
+// __m128i syndromes - The syndromes.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "ssse3" ) ) ) static inline void count_errors_ssse3( __m128i syndromes, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	*corrected_errors += __builtin_popcount( _mm_movemask_epi8( _mm_shuffle_epi8( _mm_loadu_si128( ( const __m128i * ) syndrome_correctable ), syndromes ) ) );
+	*uncorrectable_errors += __builtin_popcount( _mm_movemask_epi8( _mm_shuffle_epi8( _mm_loadu_si128( ( const __m128i * ) syndrome_uncorrectable ), syndromes ) ) );
+}
+
+// Description:
+// Counts the corrected and uncorrectable codes in a block 64 codes at a time with pshufb.
+//
+// Parameters:
+// Same as verify_block_scalar.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "ssse3" ) ) ) static void verify_block_ssse3( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	size_t i = 0;
+
+	for ( ; i + 64 <= n; i += 64 ) {
+		__m128i syndromes[ 4 ];
+
+		for ( uint32_t j = 0; j < 4; j++ ) {
+			syndromes[ j ] = syndromes_ssse3( _mm_loadu_si128( ( const __m128i * ) ( in + i + 16 * j ) ) );
+		}
+
+		__m128i any = _mm_or_si128( _mm_or_si128( syndromes[ 0 ], syndromes[ 1 ] ), _mm_or_si128( syndromes[ 2 ], syndromes[ 3 ] ) );
+
+		if ( _mm_movemask_epi8( _mm_cmpeq_epi8( any, _mm_setzero_si128( ) ) ) == 0xFFFF ) {
+			continue;
+		}
+
+		for ( uint32_t j = 0; j < 4; j++ ) {
+			count_errors_ssse3( syndromes[ j ], corrected_errors, uncorrectable_errors );
+		}
+	}
+
+	verify_block_scalar( in + i, n - i, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Counts the corrected and uncorrectable codes in a block 128 codes at a time with vpshufb.
+//
+// Parameters:
+// Same as verify_block_scalar.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx2" ) ) ) static void verify_block_avx2( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	const __m256i correctable_table = _mm256_broadcastsi128_si256( _mm_loadu_si128( ( const __m128i * ) syndrome_correctable ) );
+	const __m256i uncorrectable_table = _mm256_broadcastsi128_si256( _mm_loadu_si128( ( const __m128i * ) syndrome_uncorrectable ) );
+	size_t i = 0;
+
+	for ( ; i + 128 <= n; i += 128 ) {
+		__m256i syndromes[ 4 ];
+
+		for ( uint32_t j = 0; j < 4; j++ ) {
+			syndromes[ j ] = syndromes_avx2( _mm256_loadu_si256( ( const __m256i * ) ( in + i + 32 * j ) ) );
+		}
+
+		__m256i any = _mm256_or_si256( _mm256_or_si256( syndromes[ 0 ], syndromes[ 1 ] ), _mm256_or_si256( syndromes[ 2 ], syndromes[ 3 ] ) );
+
+		if ( _mm256_testz_si256( any, any ) ) {
+			continue;
+		}
+
+		for ( uint32_t j = 0; j < 4; j++ ) {
+			*corrected_errors += __builtin_popcount( _mm256_movemask_epi8( _mm256_shuffle_epi8( correctable_table, syndromes[ j ] ) ) );
+			*uncorrectable_errors += __builtin_popcount( _mm256_movemask_epi8( _mm256_shuffle_epi8( uncorrectable_table, syndromes[ j ] ) ) );
+		}
+	}
+
+	verify_block_ssse3( in + i, n - i, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Counts the corrected and uncorrectable codes in a block 256 codes at a time with vpshufb and mask registers.
+//
+// Parameters:
+// Same as verify_block_scalar.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx512f,avx512bw" ) ) ) static void verify_block_avx512( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	const __m512i nibble_mask = _mm512_set1_epi8( 0xF );
+	const __m512i syndrome_table = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i * ) syndrome_lookup ) );
+	const __m512i correctable_table = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i * ) syndrome_correctable ) );
+	const __m512i uncorrectable_table = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i * ) syndrome_uncorrectable ) );
+	size_t i = 0;
+
+	for ( ; i + 256 <= n; i += 256 ) {
+		__m512i syndromes[ 4 ];
+
+		for ( uint32_t j = 0; j < 4; j++ ) {
+			__m512i codes = _mm512_loadu_si512( ( const void * ) ( in + i + 64 * j ) );
+			syndromes[ j ] = _mm512_xor_si512( _mm512_shuffle_epi8( syndrome_table, _mm512_and_si512( codes, nibble_mask ) ), _mm512_and_si512( _mm512_srli_epi16( codes, 4 ), nibble_mask ) );
+		}
+
+		__m512i any = _mm512_or_si512( _mm512_or_si512( syndromes[ 0 ], syndromes[ 1 ] ), _mm512_or_si512( syndromes[ 2 ], syndromes[ 3 ] ) );
+
+		if ( !_mm512_test_epi8_mask( any, any ) ) {
+			continue;
+		}
+
+		for ( uint32_t j = 0; j < 4; j++ ) {
+			*corrected_errors += __builtin_popcountll( _mm512_movepi8_mask( _mm512_shuffle_epi8( correctable_table, syndromes[ j ] ) ) );
+			*uncorrectable_errors += __builtin_popcountll( _mm512_movepi8_mask( _mm512_shuffle_epi8( uncorrectable_table, syndromes[ j ] ) ) );
+		}
+	}
+
+	verify_block_avx2( in + i, n - i, corrected_errors, uncorrectable_errors );
+}
+#endif
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(8, 4) codes in a block without decoding it, using a backend. The
+// bit-sliced and pair-table backends check codes like the scalar one, since there's nothing to decode.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to use. Must be resolved and supported by the CPU.
+// const uint8_t *in - The codes to check.
+// size_t n - The number of codes to check, which is twice the number of bytes they decode to.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_verify_block_with( HAM_BACKEND backend, const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	switch ( backend ) {
+#ifdef HAM_X86
+	case HAM_BACKEND_SSSE3: verify_block_ssse3( in, n, corrected_errors, uncorrectable_errors ); break;
+	case HAM_BACKEND_AVX2: verify_block_avx2( in, n, corrected_errors, uncorrectable_errors ); break;
+	case HAM_BACKEND_AVX512: verify_block_avx512( in, n, corrected_errors, uncorrectable_errors ); break;
+#endif
+	default: verify_block_scalar( in, n, corrected_errors, uncorrectable_errors ); break;
+	}
+}
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(8, 4) codes in a block without decoding it, using the selected backend.
+//
+// Parameters:
+// const uint8_t *in - The codes to check.
+// size_t n - The number of codes to check, which is twice the number of bytes they decode to.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_verify_block( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	ham_verify_block_with( ham_get_backend( ), in, n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Rewrites the Hamming(8, 4) codes in a block that have a correctable error with the code of their corrected nibble.
+// Uncorrectable codes are left as they are. Groups of 8 codes are checked at once, so blocks with few errors are fast.
+//
+// Parameters:
+// uint8_t *codes - The codes to repair in place.
+// size_t n - The number of codes.
+//
+// Returns:
+// size_t - The number of codes that were rewritten.
+size_t ham_repair_block( uint8_t *codes, size_t n ) {
+	size_t repaired = 0;
+	size_t i = 0;
+
+	while ( i < n ) {
+		if ( i + 8 <= n && codes_clean_64( load_64( codes + i ) ) ) {
+			i += 8;
+			continue;
+		}
+
+		for ( size_t end = i + 8 <= n ? i + 8 : n; i < end; i++ ) {
+			uint8_t msg = 0;
+
+			if ( ham_decode( codes[ i ], &msg ) == HAM_CORRECT ) {
+				codes[ i ] = encode_lookup[ msg ];
+				repaired++;
+			}
+		}
+	}
+
+	return repaired;
+}
+
+// Description:
+// Computes the check byte of a Hamming(72, 64) code.
+//
+// Parameters:
+// uint64_t data - The data bits.
+//
+// Returns:
+// uint8_t - The check byte.
+static inline uint8_t check_byte_72_64( uint64_t data ) {
+	uint8_t check = 0;
+
+	for ( uint32_t i = 0; i < 8; i++ ) {
+		check |= ( __builtin_popcountll( data & check_masks_72_64[ i ] ) & 1 ) << i;
+	}
+
+	return check;
+}
+
+// Description:
+// Encodes a 64-bit message into the check byte of a Hamming(72, 64) code. The code is the message's 8 bytes, least
+// significant first, followed by the check byte, which matches the matrix multiplication codec's Hamming(72, 64) code.
+//
+// Parameters:
+// uint64_t msg - The message to encode.
+//
+// Returns:
+// uint8_t - The check byte.
+uint8_t ham_encode_72_64( uint64_t msg ) {
+	return check_byte_72_64( msg );
+}
+
+// Description:
+// Decodes a Hamming(72, 64) code to a 64-bit message.
+//
+// Parameters:
+// uint64_t data - The data bits of the code.
+// uint8_t check - The check byte of the code.
+// uint64_t *msg - Where to put the decoded message. Will be unmodified upon failure.
+//
+// Returns:
+// HAM_STATUS - Whether the hamming code could be successfully decoded.
+HAM_STATUS ham_decode_72_64( uint64_t data, uint8_t check, uint64_t *msg ) {
+	int8_t bit = syndrome_bit_72_64[ check_byte_72_64( data ) ^ check ];
+
+	if ( bit == HAM_ERR ) {
+		return HAM_ERR;
+	}
+
+	if ( bit == HAM_OK ) {
+		*msg = data;
+
+		return HAM_OK;
+	}
+
+	*msg = bit < 64 ? data ^ ( ( uint64_t ) 1 << bit ) : data;
+
+	return HAM_CORRECT;
+}
+
+// Description:
+// Encodes 64-bit words into Hamming(72, 64) codes. Inlined into each backend so the popcounts use its instructions.
+//
+// Parameters:
+// const uint8_t *in - The words to encode. Must hold 8 * n bytes.
+// uint8_t *out - Where to put the codes. Must hold 9 * n bytes.
+// size_t n - The number of words to encode.
+//
+// Returns:
+// Nothing.
+static inline __attribute__( ( always_inline ) ) void encode_72_64_words( const uint8_t *in, uint8_t *out, size_t n ) {
+	for ( size_t i = 0; i < n; i++ ) {
+		uint64_t data = load_64( in + HAM_72_64_DATA_SIZE * i );
+		store_64( out + HAM_72_64_CODE_SIZE * i, data );
+		out[ HAM_72_64_CODE_SIZE * i + HAM_72_64_DATA_SIZE ] = check_byte_72_64( data );
+	}
+}
+
+// Description:
+// Decodes Hamming(72, 64) codes into 64-bit words. Inlined into each backend so the popcounts use its instructions.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode. Must hold 9 * n bytes.
+// uint8_t *out - Where to put the decoded words. Must hold 8 * n bytes. Words of uncorrectable codes are set to 0.
+// size_t n - The number of words to decode.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+static inline __attribute__( ( always_inline ) ) void decode_72_64_words( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	for ( size_t i = 0; i < n; i++ ) {
+		uint64_t data = load_64( in + HAM_72_64_CODE_SIZE * i );
+		uint8_t syndrome = check_byte_72_64( data ) ^ in[ HAM_72_64_CODE_SIZE * i + HAM_72_64_DATA_SIZE ];
+
+		if ( syndrome ) {
+			int8_t bit = syndrome_bit_72_64[ syndrome ];
+
+			if ( bit == HAM_ERR ) {
+				// Output 0 upon failure.
+				data = 0;
+				( *uncorrectable_errors )++;
+			} else {
+				data ^= bit < 64 ? ( uint64_t ) 1 << bit : 0;
+				( *corrected_errors )++;
+			}
+		}
+
+		store_64( out + HAM_72_64_DATA_SIZE * i, data );
+	}
+}
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(72, 64) codes without decoding them. Inlined into each backend so the
+// popcounts use its instructions.
+//
+// Parameters:
+// const uint8_t *in - The codes to check. Must hold 9 * n bytes.
+// size_t n - The number of codes to check.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+static inline __attribute__( ( always_inline ) ) void verify_72_64_words( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	for ( size_t i = 0; i < n; i++ ) {
+		uint8_t syndrome = check_byte_72_64( load_64( in + HAM_72_64_CODE_SIZE * i ) ) ^ in[ HAM_72_64_CODE_SIZE * i + HAM_72_64_DATA_SIZE ];
+
+		if ( syndrome ) {
+			if ( syndrome_bit_72_64[ syndrome ] == HAM_ERR ) {
+				( *uncorrectable_errors )++;
+			} else {
+				( *corrected_errors )++;
+			}
+		}
+	}
+}
+
+// Description:
+// Encodes 64-bit words into Hamming(72, 64) codes with portable popcounts.
+//
+// Parameters:
+// Same as encode_72_64_words.
+//
+// Returns:
+// Nothing.
+static void encode_72_64_block_scalar( const uint8_t *in, uint8_t *out, size_t n ) {
+	encode_72_64_words( in, out, n );
+}
+
+// Description:
+// Decodes Hamming(72, 64) codes into 64-bit words with portable popcounts.
+//
+// Parameters:
+// Same as decode_72_64_words.
+//
+// Returns:
+// Nothing.
+static void decode_72_64_block_scalar( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	decode_72_64_words( in, out, n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(72, 64) codes with portable popcounts.
+//
+// Parameters:
+// Same as verify_72_64_words.
+//
+// Returns:
+// Nothing.
+static void verify_72_64_block_scalar( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	verify_72_64_words( in, n, corrected_errors, uncorrectable_errors );
+}
+
+#ifdef HAM_X86
+// Description:
+// Encodes 64-bit words into Hamming(72, 64) codes with the popcnt instruction.
+//
+// Parameters:
+// Same as encode_72_64_words.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "popcnt" ) ) ) static void encode_72_64_block_popcnt( const uint8_t *in, uint8_t *out, size_t n ) {
+	encode_72_64_words( in, out, n );
+}
+
+// Description:
+// Decodes Hamming(72, 64) codes into 64-bit words with the popcnt instruction.
+//
+// Parameters:
+// Same as decode_72_64_words.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "popcnt" ) ) ) static void decode_72_64_block_popcnt( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	decode_72_64_words( in, out, n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(72, 64) codes with the popcnt instruction.
+//
+// Parameters:
+// Same as verify_72_64_words.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "popcnt" ) ) ) static void verify_72_64_block_popcnt( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	verify_72_64_words( in, n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Computes the check bytes of 8 words at once with gf2p8affineqb.
+//
+// Parameters:
+// __m512i data - The data of 8 Hamming(72, 64) codes.
+//
+// Returns:
+// __m512i - The check byte of each word in the lowest byte of its lane. The other bytes are garbage.
+__attribute__( ( target( "avx512f,avx512bw,gfni" ) ) ) static inline __m512i check_bytes_72_64_gfni( __m512i data ) {
+	__m512i check = _mm512_setzero_si512( );
+
+	// Each byte of a word only gets the matrix of its own position, then the bytes of each word are XORed together.
+	for ( uint32_t i = 0; i < 8; i++ ) {
+		__m512i product = _mm512_maskz_gf2p8affine_epi64_epi8( 0x0101010101010101ULL << i, data, _mm512_set1_epi64( check_affine_72_64[ i ] ), 0 );
+		check = _mm512_xor_si512( check, product );
+	}
+
+	check = _mm512_xor_si512( check, _mm512_srli_epi64( check, 32 ) );
+	check = _mm512_xor_si512( check, _mm512_srli_epi64( check, 16 ) );
+
+	return _mm512_xor_si512( check, _mm512_srli_epi64( check, 8 ) );
+}
+
+// Description:
+// Encodes 64-bit words into Hamming(72, 64) codes 8 at a time with gf2p8affineqb, and the rest with popcnt.
+//
+// Parameters:
+// Same as encode_72_64_words.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx512f,avx512bw,avx512vbmi,gfni" ) ) ) static void encode_72_64_block_gfni( const uint8_t *in, uint8_t *out, size_t n ) {
+	// Where each code byte comes from, indexing the data followed by the check bytes.
+	static const uint8_t code_index[ 128 ] = { 0, 1, 2, 3, 4, 5, 6, 7, 64, 8, 9, 10, 11, 12, 13, 14, 15, 72, 16, 17, 18, 19, 20, 21, 22, 23, 80, 24, 25, 26, 27, 28, 29, 30, 31, 88, 32, 33, 34, 35,
+		36, 37, 38, 39, 96, 40, 41, 42, 43, 44, 45, 46, 47, 104, 48, 49, 50, 51, 52, 53, 54, 55, 112, 56, 57, 58, 59, 60, 61, 62, 63, 120 };
+	const __m512i head_index = _mm512_loadu_si512( code_index );
+	const __m512i tail_index = _mm512_loadu_si512( code_index + 64 );
+	size_t i = 0;
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m512i data = _mm512_loadu_si512( in + HAM_72_64_DATA_SIZE * i );
+		__m512i check = check_bytes_72_64_gfni( data );
+		_mm512_storeu_si512( out + HAM_72_64_CODE_SIZE * i, _mm512_permutex2var_epi8( data, head_index, check ) );
+		_mm512_mask_storeu_epi8( out + HAM_72_64_CODE_SIZE * i + 64, 0xFF, _mm512_permutex2var_epi8( data, tail_index, check ) );
+	}
+
+	encode_72_64_block_popcnt( in + HAM_72_64_DATA_SIZE * i, out + HAM_72_64_CODE_SIZE * i, n - i );
+}
+
+// Description:
+// Decodes Hamming(72, 64) codes into 64-bit words 8 at a time with gf2p8affineqb, and the rest with popcnt. Only words
+// with a nonzero syndrome go through the syndrome table.
+//
+// Parameters:
+// Same as decode_72_64_words.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx512f,avx512bw,avx512vbmi,gfni,popcnt" ) ) ) static void decode_72_64_block_gfni( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	// Where each data byte comes from, indexing the first 64 code bytes followed by the last 8.
+	static const uint8_t data_index[ 64 ] = { 0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 13, 14, 15, 16, 18, 19, 20, 21, 22, 23, 24, 25, 27, 28, 29, 30, 31, 32, 33, 34, 36, 37, 38, 39, 40, 41, 42, 43,
+		45, 46, 47, 48, 49, 50, 51, 52, 54, 55, 56, 57, 58, 59, 60, 61, 63, 64, 65, 66, 67, 68, 69, 70 };
+	// Where each check byte comes from, put in the lowest byte of its word's lane.
+	static const uint8_t check_index[ 64 ] = { 8, 0, 0, 0, 0, 0, 0, 0, 17, 0, 0, 0, 0, 0, 0, 0, 26, 0, 0, 0, 0, 0, 0, 0, 35, 0, 0, 0, 0, 0, 0, 0, 44, 0, 0, 0, 0, 0, 0, 0, 53, 0, 0, 0, 0, 0, 0, 0, 62,
+		0, 0, 0, 0, 0, 0, 0, 71, 0, 0, 0, 0, 0, 0, 0 };
+	const __m512i data_permute = _mm512_loadu_si512( data_index );
+	const __m512i check_permute = _mm512_loadu_si512( check_index );
+	const __m512i low_byte = _mm512_set1_epi64( 0xFF );
+	size_t i = 0;
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		const uint8_t *codes = in + HAM_72_64_CODE_SIZE * i;
+		__m512i head = _mm512_loadu_si512( codes );
+		__m512i tail = _mm512_maskz_loadu_epi8( 0xFF, codes + 64 );
+		__m512i data = _mm512_permutex2var_epi8( head, data_permute, tail );
+		__m512i check = _mm512_permutex2var_epi8( head, check_permute, tail );
+		__mmask8 dirty = _mm512_test_epi64_mask( _mm512_xor_si512( check_bytes_72_64_gfni( data ), check ), low_byte );
+		_mm512_storeu_si512( out + HAM_72_64_DATA_SIZE * i, data );
+
+		while ( dirty ) {
+			uint32_t word = __builtin_ctz( dirty );
+			decode_72_64_words( codes + HAM_72_64_CODE_SIZE * word, out + HAM_72_64_DATA_SIZE * ( i + word ), 1, corrected_errors, uncorrectable_errors );
+			dirty &= dirty - 1;
+		}
+	}
+
+	decode_72_64_block_popcnt( in + HAM_72_64_CODE_SIZE * i, out + HAM_72_64_DATA_SIZE * i, n - i, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(72, 64) codes 8 at a time with gf2p8affineqb, and the rest with
+// popcnt. Only codes with a nonzero syndrome go through the syndrome table.
+//
+// Parameters:
+// Same as verify_72_64_words.
+//
+// Returns:
+// Nothing.
+__attribute__( ( target( "avx512f,avx512bw,avx512vbmi,gfni,popcnt" ) ) ) static void verify_72_64_block_gfni( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	// Same as in decode_72_64_block_gfni.
+	static const uint8_t data_index[ 64 ] = { 0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 13, 14, 15, 16, 18, 19, 20, 21, 22, 23, 24, 25, 27, 28, 29, 30, 31, 32, 33, 34, 36, 37, 38, 39, 40, 41, 42, 43,
+		45, 46, 47, 48, 49, 50, 51, 52, 54, 55, 56, 57, 58, 59, 60, 61, 63, 64, 65, 66, 67, 68, 69, 70 };
+	static const uint8_t check_index[ 64 ] = { 8, 0, 0, 0, 0, 0, 0, 0, 17, 0, 0, 0, 0, 0, 0, 0, 26, 0, 0, 0, 0, 0, 0, 0, 35, 0, 0, 0, 0, 0, 0, 0, 44, 0, 0, 0, 0, 0, 0, 0, 53, 0, 0, 0, 0, 0, 0, 0, 62,
+		0, 0, 0, 0, 0, 0, 0, 71, 0, 0, 0, 0, 0, 0, 0 };
+	const __m512i data_permute = _mm512_loadu_si512( data_index );
+	const __m512i check_permute = _mm512_loadu_si512( check_index );
+	const __m512i low_byte = _mm512_set1_epi64( 0xFF );
+	size_t i = 0;
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		const uint8_t *codes = in + HAM_72_64_CODE_SIZE * i;
+		__m512i head = _mm512_loadu_si512( codes );
+		__m512i tail = _mm512_maskz_loadu_epi8( 0xFF, codes + 64 );
+		__m512i data = _mm512_permutex2var_epi8( head, data_permute, tail );
+		__m512i check = _mm512_permutex2var_epi8( head, check_permute, tail );
+		__mmask8 dirty = _mm512_test_epi64_mask( _mm512_xor_si512( check_bytes_72_64_gfni( data ), check ), low_byte );
+
+		while ( dirty ) {
+			verify_72_64_words( codes + HAM_72_64_CODE_SIZE * __builtin_ctz( dirty ), 1, corrected_errors, uncorrectable_errors );
+			dirty &= dirty - 1;
+		}
+	}
+
+	verify_72_64_block_popcnt( in + HAM_72_64_CODE_SIZE * i, n - i, corrected_errors, uncorrectable_errors );
+}
+#endif
+
+// Description:
+// Picks the Hamming(72, 64) kernel for a backend. The AVX-512 backend uses gf2p8affineqb when the CPU has
+// GFNI and VBMI, and every other backend but the scalar one uses popcnt when the CPU has it.
+//
+// Parameters:
+// HAM_BACKEND backend - The resolved backend.
+//
+// Returns:
+// int - 2 for gf2p8affineqb, 1 for popcnt, or 0 for portable popcounts.
+static int kernel_72_64( HAM_BACKEND backend ) {
+#ifdef HAM_X86
+	if ( backend == HAM_BACKEND_AVX512 && __builtin_cpu_supports( "gfni" ) && __builtin_cpu_supports( "avx512vbmi" ) && __builtin_cpu_supports( "popcnt" ) ) {
+		return 2;
+	}
+
+	if ( backend != HAM_BACKEND_SCALAR && __builtin_cpu_supports( "popcnt" ) ) {
+		return 1;
+	}
+#endif
+
+	return 0;
+}
+
+// Description:
+// Encodes 64-bit words into Hamming(72, 64) codes, each the word's 8 bytes, least significant first, followed by its check byte. Uses the given backend instead of the selected one.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to use. Must be resolved and supported by the CPU.
+// const uint8_t *in - The words to encode. Must hold 8 * n bytes.
+// uint8_t *out - Where to put the codes. Must hold 9 * n bytes.
+// size_t n - The number of words to encode.
+//
+// Returns:
+// Nothing.
+void ham_encode_72_64_block_with( HAM_BACKEND backend, const uint8_t *in, uint8_t *out, size_t n ) {
+	switch ( kernel_72_64( backend ) ) {
+#ifdef HAM_X86
+	case 2: encode_72_64_block_gfni( in, out, n ); break;
+	case 1: encode_72_64_block_popcnt( in, out, n ); break;
+#endif
+	default: encode_72_64_block_scalar( in, out, n ); break;
+	}
+}
+
+// Description:
+// Encodes 64-bit words into Hamming(72, 64) codes, each the word's 8 bytes, least significant first, followed by its check byte.
+//
+// Parameters:
+// const uint8_t *in - The words to encode. Must hold 8 * n bytes.
+// uint8_t *out - Where to put the codes. Must hold 9 * n bytes.
+// size_t n - The number of words to encode.
+//
+// Returns:
+// Nothing.
+void ham_encode_72_64_block( const uint8_t *in, uint8_t *out, size_t n ) {
+	ham_encode_72_64_block_with( ham_get_backend( ), in, out, n );
+}
+
+// Description:
+// Decodes Hamming(72, 64) codes into 64-bit words. Uses the given backend instead of the selected one.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to use. Must be resolved and supported by the CPU.
+// const uint8_t *in - The codes to decode. Must hold 9 * n bytes.
+// uint8_t *out - Where to put the decoded words. Must hold 8 * n bytes. Words of uncorrectable codes are set to 0.
+// size_t n - The number of words to decode.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_decode_72_64_block_with( HAM_BACKEND backend, const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	switch ( kernel_72_64( backend ) ) {
+#ifdef HAM_X86
+	case 2: decode_72_64_block_gfni( in, out, n, corrected_errors, uncorrectable_errors ); break;
+	case 1: decode_72_64_block_popcnt( in, out, n, corrected_errors, uncorrectable_errors ); break;
+#endif
+	default: decode_72_64_block_scalar( in, out, n, corrected_errors, uncorrectable_errors ); break;
+	}
+}
+
+// Description:
+// Decodes Hamming(72, 64) codes into 64-bit words.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode. Must hold 9 * n bytes.
+// uint8_t *out - Where to put the decoded words. Must hold 8 * n bytes. Words of uncorrectable codes are set to 0.
+// size_t n - The number of words to decode.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_decode_72_64_block( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	ham_decode_72_64_block_with( ham_get_backend( ), in, out, n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(72, 64) codes without decoding them. Uses the given backend instead of the selected one.
+//
+// Parameters:
+// HAM_BACKEND backend - The backend to use. Must be resolved and supported by the CPU.
+// const uint8_t *in - The codes to check. Must hold 9 * n bytes.
+// size_t n - The number of codes to check.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_verify_72_64_block_with( HAM_BACKEND backend, const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	switch ( kernel_72_64( backend ) ) {
+#ifdef HAM_X86
+	case 2: verify_72_64_block_gfni( in, n, corrected_errors, uncorrectable_errors ); break;
+	case 1: verify_72_64_block_popcnt( in, n, corrected_errors, uncorrectable_errors ); break;
+#endif
+	default: verify_72_64_block_scalar( in, n, corrected_errors, uncorrectable_errors ); break;
+	}
+}
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(72, 64) codes without decoding them.
+//
+// Parameters:
+// const uint8_t *in - The codes to check. Must hold 9 * n bytes.
+// size_t n - The number of codes to check.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_verify_72_64_block( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	ham_verify_72_64_block_with( ham_get_backend( ), in, n, corrected_errors, uncorrectable_errors );
+}
+
+// Description:
+// Rewrites the Hamming(72, 64) codes that have a correctable error with their corrected data and check byte.
+// Uncorrectable codes are left as they are.
+//
+// Parameters:
+// uint8_t *codes - The codes to repair in place. Must hold 9 * n bytes.
+// size_t n - The number of codes.
+//
+// Returns:
+// size_t - The number of codes that were rewritten.
+size_t ham_repair_72_64_block( uint8_t *codes, size_t n ) {
+	size_t repaired = 0;
+
+	for ( size_t i = 0; i < n; i++ ) {
+		uint8_t *code = codes + HAM_72_64_CODE_SIZE * i;
+		uint64_t msg = 0;
+
+		if ( ham_decode_72_64( load_64( code ), code[ HAM_72_64_DATA_SIZE ], &msg ) == HAM_CORRECT ) {
+			store_64( code, msg );
+			code[ HAM_72_64_DATA_SIZE ] = check_byte_72_64( msg );
+			repaired++;
+		}
+	}
+
+	return repaired;
+}
@@ -1,6 +1,8 @@
 #ifndef __HAMMING_H__
 #define __HAMMING_H__
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef enum HAM_STATUS {
@@ -9,8 +11,67 @@ typedef enum HAM_STATUS {
 	HAM_CORRECT = -1, // Detected error and corrected.
 } HAM_STATUS;
 
+// Status bits ham_decode_block reports for each decoded byte.
+#define HAM_BLOCK_LOWER_CORRECTED 0x1 // The lower nibble's code had an error that was corrected.
+#define HAM_BLOCK_LOWER_ERR       0x2 // The lower nibble's code was uncorrectable.
+#define HAM_BLOCK_UPPER_CORRECTED 0x4 // The upper nibble's code had an error that was corrected.
+#define HAM_BLOCK_UPPER_ERR       0x8 // The upper nibble's code was uncorrectable.
+
+#define HAM_72_64_DATA_SIZE 8 // Bytes of data in a Hamming(72, 64) code.
+#define HAM_72_64_CODE_SIZE 9 // Bytes in a Hamming(72, 64) code, the data followed by the check byte.
+
+typedef enum HAM_BACKEND {
+	HAM_BACKEND_AUTO, // Fastest backend supported by the CPU.
+	HAM_BACKEND_SCALAR, // Portable table lookups.
+	HAM_BACKEND_SSSE3, // 16 bytes at a time with pshufb.
+	HAM_BACKEND_AVX2, // 32 bytes at a time with vpshufb.
+	HAM_BACKEND_AVX512, // 64 bytes at a time with vpshufb.
+	HAM_BACKEND_BITSLICE, // Portable, decodes 64 codes at a time as bit-planes in 64-bit words and encodes like SCALAR.
+	HAM_BACKEND_PAIR, // Portable, one lookup per byte in a 256-entry table of code pairs and a 65536-entry table of decoded bytes.
+} HAM_BACKEND;
+
 uint8_t ham_encode( uint8_t msg );
 
 HAM_STATUS ham_decode( uint8_t code, uint8_t *msg );
 
+bool ham_set_backend( HAM_BACKEND backend );
+
+HAM_BACKEND ham_get_backend( );
+
+bool ham_backend_supported( HAM_BACKEND backend );
+
+HAM_BACKEND ham_resolve_backend( HAM_BACKEND backend );
+
+void ham_encode_block( const uint8_t *in, uint8_t *out, size_t n );
+
+void ham_encode_block_with( HAM_BACKEND backend, const uint8_t *in, uint8_t *out, size_t n );
+
+void ham_decode_block( const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+void ham_decode_block_with( HAM_BACKEND backend, const uint8_t *in, uint8_t *out, size_t n, uint8_t *status, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+void ham_verify_block( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+void ham_verify_block_with( HAM_BACKEND backend, const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+size_t ham_repair_block( uint8_t *codes, size_t n );
+
+uint8_t ham_encode_72_64( uint64_t msg );
+
+HAM_STATUS ham_decode_72_64( uint64_t data, uint8_t check, uint64_t *msg );
+
+void ham_encode_72_64_block( const uint8_t *in, uint8_t *out, size_t n );
+
+void ham_encode_72_64_block_with( HAM_BACKEND backend, const uint8_t *in, uint8_t *out, size_t n );
+
+void ham_decode_72_64_block( const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+void ham_decode_72_64_block_with( HAM_BACKEND backend, const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+void ham_verify_72_64_block( const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+void ham_verify_72_64_block_with( HAM_BACKEND backend, const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+size_t ham_repair_72_64_block( uint8_t *codes, size_t n );
+
 #endif
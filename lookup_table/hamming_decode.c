@@ -1,16 +1,42 @@
+#include "block_io.h"
+#include "error_map.h"
+#include "frame_io.h"
 #include "hamming.h"
+#include "io_engine.h"
+#include "parallel_io.h"
+#include "range_io.h"
+#include "verify_io.h"
 
 #include <getopt.h>
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 
-#define OPTIONS "hvi:o:" // Valid options for the program.
+#define OPTIONS "hvc:b:j:mpui:o:" // Valid options for the program.
+
+// Values getopt_long returns for the options with only a long name.
+enum { OPTION_VERIFY = 256, OPTION_REPAIR, OPTION_BWLIMIT, OPTION_FRAMED, OPTION_OFFSET, OPTION_LENGTH, OPTION_ERROR_MAP };
+
+// Long names of the options.
+static const struct option long_options[] = {
+	{ "verify", no_argument, NULL, OPTION_VERIFY },
+	{ "repair", no_argument, NULL, OPTION_REPAIR },
+	{ "bwlimit", required_argument, NULL, OPTION_BWLIMIT },
+	{ "framed", no_argument, NULL, OPTION_FRAMED },
+	{ "offset", required_argument, NULL, OPTION_OFFSET },
+	{ "length", required_argument, NULL, OPTION_LENGTH },
+	{ "error-map", required_argument, NULL, OPTION_ERROR_MAP },
+	{ NULL, 0, NULL, 0 },
+};
 
 static FILE *input_file = NULL;
 static FILE *output_file = NULL;
+static bool hamming_72_64 = false; // Whether to use the Hamming(72, 64) code instead of Hamming(8, 4).
+static bool framed = false; // Whether the input is a container with a file header and chunk headers instead of raw codes.
+static char *error_map_file_name = NULL; // File to write the ranges of bytes with uncorrectable errors to, if any.
 
 // Description:
 // Prints the help message to stderr.
@@ -22,8 +48,17 @@ static FILE *output_file = NULL;
 // Nothing.
 static void print_help( char *program_path ) {
 	fprintf( stderr,
-	    "SYNOPSIS\n   A Hamming(8, 4) code decoder using a lookup table.\n\nUSAGE\n   %s [-hv] [-i infile] [-o outfile]\n\nOPTIONS\n   -h             Program usage and help.\n   -v             Print "
-	    "decoding statistics to stderr.\n   -i infile      Input file to decode.\n   -o outfile     File to output decoded data to.\n",
+	    "SYNOPSIS\n   A Hamming(8, 4) or Hamming(72, 64) code decoder using a lookup table.\n\nUSAGE\n   %s [-hv] [-c n,k] [-b size] [-j threads] [-m] [-p] [-u] [--framed] [--verify | --repair] "
+	    "[--bwlimit rate] [--offset n] [--length n] [--error-map f] [-i infile] [-o outfile]\n\nOPTIONS\n   -h             Program usage and help.\n   -v             Print decoding statistics to "
+	    "stderr.\n   -c n,k         Code the input was encoded with, either 8,4 or 72,64 (default 8,4).\n   -b size        Input buffer size in bytes, optionally suffixed with K, M, or G (default "
+	    "1M).\n   -j threads     Number of threads to decode with (default 1).\n   -m             Memory-map the input and output files when both are regular files.\n   -p             Splice the "
+	    "output into the output pipe instead of copying it, when it is a pipe whose reader copies the data out.\n   -u             Overlap reading and writing with processing using io_uring, if the "
+	    "kernel supports it.\n   --framed       Decode a container written with --framed, using the code in its header instead of -c.\n   --verify       Only check the input and print decoding "
+	    "statistics to stderr, without decoding it or writing output.\n   --repair       Like --verify, but also rewrite the codes with correctable errors in the infile, only writing the pieces of "
+	    "it that have one.\n   --bwlimit rate Most bytes to read per second with --verify or --repair, optionally suffixed with K, M, or G (default no limit).\n   --offset n     Offset in the "
+	    "decoded data to start decoding at, optionally suffixed with K, M, or G. Only the codes of the range are read, so the infile must be seekable.\n   --length n     Number of decoded bytes to "
+	    "output from the offset (default to the end).\n   --error-map f  File f to write the offset and length of each range of decoded bytes with uncorrectable errors to, one range per line. "
+	    "Decodes on one thread.\n   -i infile      Input file to decode.\n   -o outfile     File to output decoded data to.\n",
 	    program_path );
 }
 
@@ -36,6 +71,8 @@ static void print_help( char *program_path ) {
 // Returns:
 // Nothing.
 static void cleanup_memory( ) {
+	error_map_close( );
+
 	if ( output_file ) {
 		fclose( output_file );
 		output_file = NULL;
@@ -53,17 +90,19 @@ static void cleanup_memory( ) {
 // Parameters:
 // char *input_file_name - The input file name given by the user.
 // char *output_file_name - The output file name given by the user.
+// bool memory_map - Whether the output file will be memory-mapped, which needs it opened for reading as well.
+// bool repair - Whether the input file will be repaired in place, which needs it opened for writing as well.
 //
 // Returns:
 // bool - Whether processing was successful.
-static bool process_input_output_files( char *input_file_name, char *output_file_name ) {
-	if ( input_file_name && !( input_file = fopen( input_file_name, "rb" ) ) ) {
+static bool process_input_output_files( char *input_file_name, char *output_file_name, bool memory_map, bool repair ) {
+	if ( input_file_name && !( input_file = fopen( input_file_name, repair ? "r+b" : "rb" ) ) ) {
 		fprintf( stderr, "Error: failed to open infile.\n" );
 
 		return false;
 	}
 
-	if ( output_file_name && !( output_file = fopen( output_file_name, "wb" ) ) ) {
+	if ( output_file_name && !( output_file = fopen( output_file_name, memory_map ? "w+b" : "wb" ) ) ) {
 		fprintf( stderr, "Error: failed to open outfile.\n" );
 		cleanup_memory( );
 
@@ -80,7 +119,7 @@ static bool process_input_output_files( char *input_file_name, char *output_file
 }
 
 // Description:
-// Decodes input file two characters at a time and outputs the decoded data to the output file.
+// Decodes input file two characters at a time and outputs the decoded data to the output file. Only used for small inputs.
 //
 // Parameters:
 // uint64_t *total_bytes_processed - A pointer to the counter for total number of bytes processed.
@@ -89,7 +128,7 @@ static bool process_input_output_files( char *input_file_name, char *output_file
 //
 // Returns:
 // bool - Whether the data could be read, decoded, and written to the output file.
-static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t *uncorrectable_errors, uint64_t *corrected_errors ) {
+static bool decode_and_write_to_file_bytewise( uint64_t *total_bytes_processed, uint64_t *uncorrectable_errors, uint64_t *corrected_errors ) {
 	uint8_t lower_nibble = 0;
 	uint8_t upper_nibble = 0;
 	uint32_t last_scan = 1;
@@ -136,6 +175,7 @@ static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t
 			if ( lower_nibble_status == HAM_ERR || upper_nibble_status == HAM_ERR ) {
 				lower_nibble = 0;
 				upper_nibble = 0;
+				error_map_add( *total_bytes_processed / 2 - 1, 1 );
 			}
 
 			uint8_t reconstructed_byte = ( upper_nibble << 4 ) | lower_nibble;
@@ -153,6 +193,206 @@ static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t
 	return true;
 }
 
+// Description:
+// Decodes a block of code byte pairs with the vectorized decoder.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode.
+// uint8_t *out - Where to put the decoded bytes. Must hold units bytes.
+// size_t units - The number of code byte pairs to decode.
+// CodecStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void decode_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	ham_decode_block( in, out, units, NULL, &stats->corrected_errors, &stats->uncorrectable_errors );
+}
+
+// Description:
+// Decodes a block of Hamming(72, 64) codes into 8-byte words.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode.
+// uint8_t *out - Where to put the decoded words. Must hold 8 * units bytes.
+// size_t units - The number of codes to decode.
+// CodecStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void decode_72_64_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	ham_decode_72_64_block( in, out, units, &stats->corrected_errors, &stats->uncorrectable_errors );
+}
+
+// Description:
+// Reads the file header of a container and switches to the code it gives, instead of the one given on the command line.
+//
+// Parameters:
+// FrameHeader *header - Where to put the header's fields.
+//
+// Returns:
+// bool - Whether a valid header with a supported code could be read.
+static bool read_frame_header( FrameHeader *header ) {
+	if ( !frame_io_read_header( input_file, header ) ) {
+		return false;
+	}
+
+	if ( ( header->code_length != 8 || header->message_length != 4 ) && ( header->code_length != 72 || header->message_length != 64 ) ) {
+		fprintf( stderr, "Error: unsupported code in container.\n" );
+
+		return false;
+	}
+
+	hamming_72_64 = header->code_length == 72;
+
+	return true;
+}
+
+// Description:
+// Decodes the input file in large blocks and outputs the decoded data to the output file. When only a range of the data
+// is asked for, only the codes of that range are read, at their offset.
+//
+// Parameters:
+// const IoOptions *options - The I/O options given on the command line.
+// uint64_t offset - The offset in the decoded data to start at, or 0 for the whole file.
+// uint64_t length - The number of decoded bytes to output, or RANGE_IO_TO_END for the whole file.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, decoded, and written to the output file.
+static bool decode_and_write_to_file( const IoOptions *options, uint64_t offset, uint64_t length, CodecStats *stats ) {
+	static const BlockCodec nibble_codec = { 2, 1, false, decode_block };
+	static const BlockCodec word_codec = { HAM_72_64_CODE_SIZE, HAM_72_64_DATA_SIZE, false, decode_72_64_block };
+	bool range = offset != 0 || length != RANGE_IO_TO_END;
+	FrameHeader header;
+
+	if ( framed && !read_frame_header( &header ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	const BlockCodec *codec = hamming_72_64 ? &word_codec : &nibble_codec;
+	BlockCodec mapped_codec;
+
+	if ( error_map_file_name ) {
+		if ( !error_map_open( error_map_file_name, codec, offset - offset % codec->out_unit, &mapped_codec ) ) {
+			cleanup_memory( );
+
+			return false;
+		}
+
+		codec = &mapped_codec;
+	}
+
+	if ( framed ) {
+		bool success = range ? frame_io_decode_range( input_file, output_file, codec, &header, offset, length, stats ) : frame_io_decode( input_file, output_file, codec, &header, options->threads, stats );
+
+		if ( !success ) {
+			cleanup_memory( );
+
+			return false;
+		}
+
+		return true;
+	}
+
+	if ( !hamming_72_64 && !range && block_io_is_small_input( input_file ) ) {
+		return decode_and_write_to_file_bytewise( &stats->total_bytes_processed, &stats->uncorrectable_errors, &stats->corrected_errors );
+	}
+
+	if ( range ? !range_io_process( input_file, output_file, codec, offset, length, options->buffer_size, stats ) : !io_engine_process( input_file, output_file, codec, options, stats ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	return true;
+}
+
+// Description:
+// Checks a block of code byte pairs with the vectorized syndrome check, without decoding them.
+//
+// Parameters:
+// const uint8_t *in - The codes to check.
+// uint8_t *out - Unused, since nothing is decoded.
+// size_t units - The number of code byte pairs to check.
+// CodecStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void verify_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	( void ) out;
+	ham_verify_block( in, 2 * units, &stats->corrected_errors, &stats->uncorrectable_errors );
+}
+
+// Description:
+// Checks a block of Hamming(72, 64) codes without decoding them.
+//
+// Parameters:
+// const uint8_t *in - The codes to check.
+// uint8_t *out - Unused, since nothing is decoded.
+// size_t units - The number of codes to check.
+// CodecStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void verify_72_64_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	( void ) out;
+	ham_verify_72_64_block( in, units, &stats->corrected_errors, &stats->uncorrectable_errors );
+}
+
+// Description:
+// Repairs the code byte pairs with correctable errors in place.
+//
+// Parameters:
+// uint8_t *codes - The codes to repair.
+// size_t units - The number of code byte pairs.
+//
+// Returns:
+// size_t - The number of codes that were rewritten.
+static size_t repair_block( uint8_t *codes, size_t units ) {
+	return ham_repair_block( codes, 2 * units );
+}
+
+// Description:
+// Repairs the Hamming(72, 64) codes with correctable errors in place.
+//
+// Parameters:
+// uint8_t *codes - The codes to repair.
+// size_t units - The number of codes.
+//
+// Returns:
+// size_t - The number of codes that were rewritten.
+static size_t repair_72_64_block( uint8_t *codes, size_t units ) {
+	return ham_repair_72_64_block( codes, units );
+}
+
+// Description:
+// Checks the input file in large blocks without decoding it, only counting the errors, and optionally repairs it in place.
+//
+// Parameters:
+// const IoOptions *options - The I/O options given on the command line.
+// bool repair - Whether to rewrite the codes with correctable errors in the input file.
+// size_t max_rate - The most bytes to read per second, or 0 for no limit.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, and repaired if asked to.
+static bool verify_file( const IoOptions *options, bool repair, size_t max_rate, CodecStats *stats ) {
+	static const BlockCodec nibble_codec = { 2, 0, false, verify_block };
+	static const BlockCodec word_codec = { HAM_72_64_CODE_SIZE, 0, false, verify_72_64_block };
+
+	RepairFunction repair_function = hamming_72_64 ? repair_72_64_block : repair_block;
+
+	if ( !verify_io_process( input_file, hamming_72_64 ? &word_codec : &nibble_codec, repair ? repair_function : NULL, options->buffer_size, max_rate, stats ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	return true;
+}
+
 // Description:
 // The entry point of the program.
 //
@@ -165,43 +405,157 @@ static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t
 int main( int argc, char **argv ) {
 	int opt = 0;
 	bool verbose = false;
+	bool verify = false;
+	bool repair = false;
+	size_t max_rate = 0;
+	uint64_t offset = 0;
+	uint64_t length = RANGE_IO_TO_END;
 	char *input_file_name = NULL;
 	char *output_file_name = NULL;
+	IoOptions options;
+	io_engine_default_options( &options );
 
-	while ( ( opt = getopt( argc, argv, OPTIONS ) ) != -1 ) { // Process each option specified.
+	while ( ( opt = getopt_long( argc, argv, OPTIONS, long_options, NULL ) ) != -1 ) { // Process each option specified.
 		switch ( opt ) {
 		case 'h': print_help( *argv ); return 0; // Help.
 		case 'v': verbose = true; break; // Verbose.
+		case 'c': // Code.
+			if ( strcmp( optarg, "72,64" ) == 0 ) {
+				hamming_72_64 = true;
+			} else if ( strcmp( optarg, "8,4" ) != 0 ) {
+				fprintf( stderr, "Error: unsupported code.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'b': // Buffer size.
+			if ( !block_io_parse_size( optarg, &options.buffer_size ) ) {
+				fprintf( stderr, "Error: invalid buffer size.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'j': // Thread count.
+			if ( !parallel_io_parse_threads( optarg, &options.threads ) ) {
+				fprintf( stderr, "Error: invalid thread count.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'm': options.memory_map = true; break; // Memory-map files.
+		case 'p': options.splice = true; break; // Splice into the output pipe.
+		case 'u': options.io_uring = true; break; // Use io_uring.
 		case 'i': input_file_name = optarg; break; // Input file.
 		case 'o': output_file_name = optarg; break; // Output file.
+		case OPTION_VERIFY: verify = true; break; // Only check the input.
+		case OPTION_REPAIR: verify = repair = true; break; // Check the input and repair it in place.
+		case OPTION_FRAMED: framed = true; break; // Read a container.
+		case OPTION_OFFSET: // Start of the range to decode.
+			if ( !block_io_parse_offset( optarg, &offset ) ) {
+				fprintf( stderr, "Error: invalid offset.\n" );
+
+				return 1;
+			}
+
+			break;
+		case OPTION_LENGTH: // Length of the range to decode.
+			if ( !block_io_parse_offset( optarg, &length ) ) {
+				fprintf( stderr, "Error: invalid length.\n" );
+
+				return 1;
+			}
+
+			break;
+		case OPTION_ERROR_MAP: error_map_file_name = optarg; break; // Error map file.
+		case OPTION_BWLIMIT: // Read rate limit.
+			if ( !block_io_parse_size( optarg, &max_rate ) ) {
+				fprintf( stderr, "Error: invalid bandwidth limit.\n" );
+
+				return 1;
+			}
+
+			break;
 		default: print_help( *argv ); return 1; // Invalid flag.
 		}
 	}
 
+	if ( verify && output_file_name ) {
+		fprintf( stderr, "Error: --verify and --repair don't write an outfile.\n" );
+
+		return 1;
+	}
+
+	if ( verify && ( offset != 0 || length != RANGE_IO_TO_END ) ) {
+		fprintf( stderr, "Error: --offset and --length only apply to decoding.\n" );
+
+		return 1;
+	}
+
+	if ( ( offset != 0 || length != RANGE_IO_TO_END ) && ( options.threads > 1 || options.memory_map || options.splice || options.io_uring ) ) {
+		fprintf( stderr, "Error: -j, -m, -p, and -u don't apply to --offset and --length.\n" );
+
+		return 1;
+	}
+
+	if ( verify && error_map_file_name ) {
+		fprintf( stderr, "Error: --error-map only applies to decoding.\n" );
+
+		return 1;
+	}
+
+	if ( verify && framed ) {
+		fprintf( stderr, "Error: --verify and --repair don't read containers.\n" );
+
+		return 1;
+	}
+
+	if ( !verify && max_rate != 0 ) {
+		fprintf( stderr, "Error: --bwlimit only applies to --verify and --repair.\n" );
+
+		return 1;
+	}
+
+	if ( error_map_file_name ) {
+		options.threads = 1; // The error map needs the blocks decoded in order.
+	}
+
+	if ( repair && !input_file_name ) {
+		fprintf( stderr, "Error: --repair needs an infile.\n" );
+
+		return 1;
+	}
+
 	input_file = stdin;
 	output_file = stdout;
 
-	if ( !process_input_output_files( input_file_name, output_file_name ) ) {
+	if ( !process_input_output_files( input_file_name, output_file_name, options.memory_map, repair ) ) {
 		return 1;
 	}
 
-	uint64_t total_bytes_processed = 0;
-	uint64_t uncorrectable_errors = 0;
-	uint64_t corrected_errors = 0;
+	CodecStats stats = { 0, 0, 0, 0 };
+
+	if ( verify ? !verify_file( &options, repair, max_rate, &stats ) : !decode_and_write_to_file( &options, offset, length, &stats ) ) {
+		return 1;
+	}
+
+	if ( !error_map_close( ) ) {
+		cleanup_memory( );
 
-	if ( !decode_and_write_to_file( &total_bytes_processed, &uncorrectable_errors, &corrected_errors ) ) {
 		return 1;
 	}
 
-	if ( verbose ) {
-		double error_rate = ( double ) uncorrectable_errors / total_bytes_processed;
-		fprintf( stderr, "Total bytes processed: %" PRIu64 "\n", total_bytes_processed );
-		fprintf( stderr, "Uncorrectable errors: %" PRIu64 "\n", uncorrectable_errors );
-		fprintf( stderr, "Corrected errors: %" PRIu64 "\n", corrected_errors );
+	if ( verbose || verify ) {
+		double error_rate = ( double ) stats.uncorrectable_errors / stats.total_bytes_processed;
+		fprintf( stderr, "Total bytes processed: %" PRIu64 "\n", stats.total_bytes_processed );
+		fprintf( stderr, "Uncorrectable errors: %" PRIu64 "\n", stats.uncorrectable_errors );
+		fprintf( stderr, "Corrected errors: %" PRIu64 "\n", stats.corrected_errors );
 		fprintf( stderr, "Error rate: %f\n", error_rate );
 	}
 
 	cleanup_memory( );
 
-	return 0;
+	return stats.checksum_failures > 0 ? 1 : 0; // The data was written, but some of it didn't match its checksum.
 }
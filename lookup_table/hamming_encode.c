@@ -1,16 +1,34 @@
+#include "block_io.h"
+#include "frame_io.h"
 #include "hamming.h"
+#include "io_engine.h"
+#include "parallel_io.h"
 
 #include <getopt.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 
-#define OPTIONS "hi:o:" // Valid options for the program.
+#define OPTIONS "hc:b:j:mpui:o:" // Valid options for the program.
+
+// Values getopt_long returns for the options with only a long name.
+enum { OPTION_FRAMED = 256, OPTION_CRC32C };
+
+// Long names of the options.
+static const struct option long_options[] = {
+	{ "framed", no_argument, NULL, OPTION_FRAMED },
+	{ "crc32c", no_argument, NULL, OPTION_CRC32C },
+	{ NULL, 0, NULL, 0 },
+};
 
 static FILE *input_file = NULL;
 static FILE *output_file = NULL;
+static bool hamming_72_64 = false; // Whether to use the Hamming(72, 64) code instead of Hamming(8, 4).
+static bool framed = false; // Whether to write a container with a file header and chunk headers instead of raw codes.
+static bool checksum = false; // Whether to follow each chunk of the container with the CRC-32C of its data.
 
 // Description:
 // Prints the help message to stderr.
@@ -22,8 +40,13 @@ static FILE *output_file = NULL;
 // Nothing.
 static void print_help( char *program_path ) {
 	fprintf( stderr,
-	    "SYNOPSIS\n   A Hamming(8, 4) code generator using a lookup table.\n\nUSAGE\n   %s [-h] [-i infile] [-o outfile]\n\nOPTIONS\n   -h             Program usage and help.\n   -i infile      "
-	    "Input file to encode.\n   -o outfile     File to output encoded data to.\n",
+	    "SYNOPSIS\n   A Hamming(8, 4) or Hamming(72, 64) code generator using a lookup table.\n\nUSAGE\n   %s [-h] [-c n,k] [-b size] [-j threads] [-m] [-p] [-u] [--framed] [--crc32c] [-i infile] "
+	    "[-o outfile]\n\nOPTIONS\n   -h             Program usage and help.\n   -c n,k         Code to use, either 8,4 or 72,64 (default 8,4). Hamming(72, 64) pads a partial last word with "
+	    "zeros.\n   -b size        Input buffer size in bytes, optionally suffixed with K, M, or G (default 1M).\n   -j threads     Number of threads to encode with (default 1).\n   -m             "
+	    "Memory-map the input and output files when both are regular files.\n   -p             Splice the output into the output pipe instead of copying it, when it is a pipe whose reader copies the "
+	    "data out.\n   -u             Overlap reading and writing with processing using io_uring, if the kernel supports it.\n   --framed       Write a container with the code, the input length, and "
+	    "a header in front of each chunk of the buffer size, instead of raw codes.\n   --crc32c       Like --framed, but also follow each chunk with the CRC-32C of its data, which the decoder "
+	    "checks.\n   -i infile      Input file to encode.\n   -o outfile     File to output encoded data to.\n",
 	    program_path );
 }
 
@@ -53,17 +76,18 @@ static void cleanup_memory( ) {
 // Parameters:
 // char *input_file_name - The input file name given by the user.
 // char *output_file_name - The output file name given by the user.
+// bool memory_map - Whether the output file will be memory-mapped, which needs it opened for reading as well.
 //
 // Returns:
 // bool - Whether processing was successful.
-static bool process_input_output_files( char *input_file_name, char *output_file_name ) {
+static bool process_input_output_files( char *input_file_name, char *output_file_name, bool memory_map ) {
 	if ( input_file_name && !( input_file = fopen( input_file_name, "rb" ) ) ) {
 		fprintf( stderr, "Error: failed to open infile.\n" );
 
 		return false;
 	}
 
-	if ( output_file_name && !( output_file = fopen( output_file_name, "wb" ) ) ) {
+	if ( output_file_name && !( output_file = fopen( output_file_name, memory_map ? "w+b" : "wb" ) ) ) {
 		fprintf( stderr, "Error: failed to open outfile.\n" );
 		cleanup_memory( );
 
@@ -80,14 +104,14 @@ static bool process_input_output_files( char *input_file_name, char *output_file
 }
 
 // Description:
-// Encodes input file character-by-character and outputs the code to the output file.
+// Encodes input file character-by-character and outputs the code to the output file. Only used for small inputs.
 //
 // Parameters:
 // Nothing.
 //
 // Returns:
 // bool - Whether the data could be read, encoded, and written to the output file.
-static bool encode_and_write_to_file( ) {
+static bool encode_and_write_to_file_bytewise( ) {
 	uint32_t last_scan = 1;
 
 	while ( last_scan == 1 ) {
@@ -120,6 +144,77 @@ static bool encode_and_write_to_file( ) {
 	return true;
 }
 
+// Description:
+// Encodes a block of bytes with the vectorized encoder.
+//
+// Parameters:
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes. Must hold 2 * units bytes.
+// size_t units - The number of bytes to encode.
+// CodecStats *stats - Unused.
+//
+// Returns:
+// Nothing.
+static void encode_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	( void ) stats;
+	ham_encode_block( in, out, units );
+}
+
+// Description:
+// Encodes a block of 8-byte words into Hamming(72, 64) codes.
+//
+// Parameters:
+// const uint8_t *in - The words to encode.
+// uint8_t *out - Where to put the codes. Must hold 9 * units bytes.
+// size_t units - The number of words to encode.
+// CodecStats *stats - Unused.
+//
+// Returns:
+// Nothing.
+static void encode_72_64_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	( void ) stats;
+	ham_encode_72_64_block( in, out, units );
+}
+
+// Description:
+// Encodes the input file in large blocks and outputs the code to the output file.
+//
+// Parameters:
+// const IoOptions *options - The I/O options given on the command line.
+//
+// Returns:
+// bool - Whether the data could be read, encoded, and written to the output file.
+static bool encode_and_write_to_file( const IoOptions *options ) {
+	static const BlockCodec nibble_codec = { 1, 2, false, encode_block };
+	static const BlockCodec word_codec = { HAM_72_64_DATA_SIZE, HAM_72_64_CODE_SIZE, true, encode_72_64_block };
+	const BlockCodec *codec = hamming_72_64 ? &word_codec : &nibble_codec;
+	CodecStats stats = { 0, 0, 0, 0 };
+
+	if ( framed ) {
+		FrameHeader header = { hamming_72_64 ? 72 : 8, hamming_72_64 ? 64 : 4, frame_io_chunk_size( options->buffer_size, codec->in_unit ), checksum ? FRAME_IO_FLAG_CRC32C : 0, 0 };
+
+		if ( !frame_io_encode( input_file, output_file, codec, &header, options->threads, &stats ) ) {
+			cleanup_memory( );
+
+			return false;
+		}
+
+		return true;
+	}
+
+	if ( !hamming_72_64 && block_io_is_small_input( input_file ) ) {
+		return encode_and_write_to_file_bytewise( );
+	}
+
+	if ( !io_engine_process( input_file, output_file, codec, options, &stats ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	return true;
+}
+
 // Description:
 // The entry point of the program.
 //
@@ -133,12 +228,45 @@ int main( int argc, char **argv ) {
 	int opt = 0;
 	char *input_file_name = NULL;
 	char *output_file_name = NULL;
+	IoOptions options;
+	io_engine_default_options( &options );
 
-	while ( ( opt = getopt( argc, argv, OPTIONS ) ) != -1 ) { // Process each option specified.
+	while ( ( opt = getopt_long( argc, argv, OPTIONS, long_options, NULL ) ) != -1 ) { // Process each option specified.
 		switch ( opt ) {
 		case 'h': print_help( *argv ); return 0; // Help.
+		case 'c': // Code.
+			if ( strcmp( optarg, "72,64" ) == 0 ) {
+				hamming_72_64 = true;
+			} else if ( strcmp( optarg, "8,4" ) != 0 ) {
+				fprintf( stderr, "Error: unsupported code.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'b': // Buffer size.
+			if ( !block_io_parse_size( optarg, &options.buffer_size ) ) {
+				fprintf( stderr, "Error: invalid buffer size.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'j': // Thread count.
+			if ( !parallel_io_parse_threads( optarg, &options.threads ) ) {
+				fprintf( stderr, "Error: invalid thread count.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'm': options.memory_map = true; break; // Memory-map files.
+		case 'p': options.splice = true; break; // Splice into the output pipe.
+		case 'u': options.io_uring = true; break; // Use io_uring.
 		case 'i': input_file_name = optarg; break; // Input file.
 		case 'o': output_file_name = optarg; break; // Output file.
+		case OPTION_FRAMED: framed = true; break; // Write a container.
+		case OPTION_CRC32C: framed = checksum = true; break; // Write a container with checksums.
 		default: print_help( *argv ); return 1; // Invalid flag.
 		}
 	}
@@ -146,11 +274,11 @@ int main( int argc, char **argv ) {
 	input_file = stdin;
 	output_file = stdout;
 
-	if ( !process_input_output_files( input_file_name, output_file_name ) ) {
+	if ( !process_input_output_files( input_file_name, output_file_name, options.memory_map ) ) {
 		return 1;
 	}
 
-	if ( !encode_and_write_to_file( ) ) {
+	if ( !encode_and_write_to_file( &options ) ) {
 		return 1;
 	}
 
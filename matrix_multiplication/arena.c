@@ -0,0 +1,54 @@
+#include "arena.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Description:
+// Sets up an arena over some memory, such as a buffer on the stack. The arena never allocates or frees the memory itself.
+//
+// Parameters:
+// Arena *arena - The arena to set up.
+// void *memory - The memory allocations are carved from.
+// size_t size - The size of the memory in bytes.
+//
+// Returns:
+// Nothing.
+void arena_init( Arena *arena, void *memory, size_t size ) {
+	arena->memory = memory;
+	arena->size = size;
+	arena->used = 0;
+}
+
+// Description:
+// Allocates memory from an arena. The memory stays valid until the arena is reset and isn't freed on its own.
+//
+// Parameters:
+// Arena *arena - The arena.
+// size_t size - The number of bytes to allocate.
+//
+// Returns:
+// void * - The allocated memory, aligned to ARENA_ALIGNMENT bytes, or NULL if the arena doesn't have enough space left.
+void *arena_alloc( Arena *arena, size_t size ) {
+	uintptr_t start = ( uintptr_t ) arena->memory + arena->used;
+	size_t padding = ( ARENA_ALIGNMENT - start % ARENA_ALIGNMENT ) % ARENA_ALIGNMENT;
+
+	if ( padding > arena->size - arena->used || size > arena->size - arena->used - padding ) {
+		return NULL;
+	}
+
+	arena->used += padding + size;
+
+	return ( void * ) ( start + padding );
+}
+
+// Description:
+// Frees everything allocated from an arena at once, so its memory can be reused.
+//
+// Parameters:
+// Arena *arena - The arena.
+//
+// Returns:
+// Nothing.
+void arena_reset( Arena *arena ) {
+	arena->used = 0;
+}
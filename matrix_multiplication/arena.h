@@ -0,0 +1,21 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_ALIGNMENT 16 // Alignment of every allocation in bytes.
+
+typedef struct Arena {
+	uint8_t *memory; // The memory allocations are carved from. Owned by the caller.
+	size_t size; // Size of the memory in bytes.
+	size_t used; // Number of bytes handed out since the last reset, including alignment padding.
+} Arena;
+
+void arena_init( Arena *arena, void *memory, size_t size );
+
+void *arena_alloc( Arena *arena, size_t size );
+
+void arena_reset( Arena *arena );
+
+#endif
@@ -1,51 +1,109 @@
 #include "bm.h"
 
+#include "arena.h"
 #include "bv.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+#define M4RM_GROUP_BITS 8 // Number of rows of b the Method of Four Russians tables are built from.
+
 // Description:
 // A struct for the bit matrix ADT.
 //
 // Members:
 // uint32_t rows - The number of rows in the bit matrix.
 // uint32_t cols - The number of columns in the bit matrix.
-// BitVector *vector - The bit vector that backs the bit matrix.
+// uint32_t row_words - The number of words in each row. Rows are padded with zeros to whole words.
+// BitVector *vector - The bit vector that backs the bit matrix. Allocated right after the struct.
 struct BitMatrix {
 	uint32_t rows;
 	uint32_t cols;
+	uint32_t row_words;
 	BitVector *vector;
 };
 
 // Description:
-// Creates a bit matrix.
+// Gets the number of words in each row of a bit matrix.
+//
+// Parameters:
+// uint32_t cols - The number of columns in the bit matrix.
+//
+// Returns:
+// uint32_t - The number of words in a row.
+static uint32_t row_words( uint32_t cols ) {
+	return cols % 64 == 0 ? cols / 64 : cols / 64 + 1;
+}
+
+// Description:
+// Gets the number of bytes a bit matrix takes up, including the bit vector that backs it.
+//
+// Parameters:
+// uint32_t rows - The number of rows in the bit matrix.
+// uint32_t cols - The number of columns in the bit matrix.
+//
+// Returns:
+// size_t - The size of the bit matrix in bytes.
+size_t bm_size( uint32_t rows, uint32_t cols ) {
+	return sizeof( BitMatrix ) + bv_size( rows * row_words( cols ) * 64 );
+}
+
+// Description:
+// Creates a bit matrix in memory the caller allocated. The matrix is deleted by freeing or resetting that memory, not
+// with bm_delete.
+//
+// Parameters:
+// void *memory - Where to create the bit matrix. Must hold bm_size( rows, cols ) bytes and be aligned for a uint64_t.
+// uint32_t rows - The number of rows in the bit matrix.
+// uint32_t cols - The number of columns in the bit matrix.
+//
+// Returns:
+// BitMatrix * - The created bit matrix, with all bits clear.
+static BitMatrix *init_matrix( void *memory, uint32_t rows, uint32_t cols ) {
+	BitMatrix *m = memory;
+	m->rows = rows;
+	m->cols = cols;
+	m->row_words = row_words( cols );
+	m->vector = bv_init( m + 1, rows * m->row_words * 64 );
+
+	return m;
+}
+
+// Description:
+// Creates a bit matrix with a single allocation for the struct, its bit vector, and the bits.
 //
 // Parameters:
 // uint32_t rows - The number of rows in the bit matrix.
 // uint32_t cols - The number of columns in the bit matrix.
 //
 // Returns:
-// BitMatrix * - The created bit matrix.
+// BitMatrix * - The created bit matrix, or NULL if it couldn't be allocated.
 BitMatrix *bm_create( uint32_t rows, uint32_t cols ) {
-	BitMatrix *m = malloc( sizeof( BitMatrix ) );
+	void *memory = malloc( bm_size( rows, cols ) );
 
-	if ( m ) { // Make sure m was allocated successfully.
-		m->rows = rows;
-		m->cols = cols;
-		m->vector = bv_create( rows * cols );
+	return memory ? init_matrix( memory, rows, cols ) : NULL;
+}
 
-		if ( !m->vector ) {
-			free( m );
-			m = NULL;
-		}
-	}
+// Description:
+// Creates a bit matrix in an arena, which avoids the heap entirely. The matrix lives until the arena is reset and must
+// not be passed to bm_delete.
+//
+// Parameters:
+// Arena *arena - The arena to allocate from.
+// uint32_t rows - The number of rows in the bit matrix.
+// uint32_t cols - The number of columns in the bit matrix.
+//
+// Returns:
+// BitMatrix * - The created bit matrix, or NULL if the arena is full.
+BitMatrix *bm_create_in( Arena *arena, uint32_t rows, uint32_t cols ) {
+	void *memory = arena_alloc( arena, bm_size( rows, cols ) );
 
-	return m;
+	return memory ? init_matrix( memory, rows, cols ) : NULL;
 }
 
 // Description:
-// Deletes a bit matrix.
+// Deletes a bit matrix made by bm_create.
 //
 // Parameters:
 // BitMatrix **m - A pointer to a pointer to a bit matrix.
@@ -53,8 +111,7 @@ BitMatrix *bm_create( uint32_t rows, uint32_t cols ) {
 // Returns:
 // Nothing.
 void bm_delete( BitMatrix **m ) {
-	if ( *m && ( *m )->vector ) {
-		bv_delete( &( *m )->vector );
+	if ( *m ) {
 		free( *m );
 		*m = NULL;
 	}
@@ -71,7 +128,7 @@ void bm_delete( BitMatrix **m ) {
 // Returns:
 // uint8_t - The bit retrieved.
 uint8_t bm_get_bit( BitMatrix *m, uint32_t row, uint32_t col ) {
-	return bv_get_bit( m->vector, row * m->cols + col );
+	return bv_get_bit( m->vector, row * m->row_words * 64 + col );
 }
 
 // Description:
@@ -85,7 +142,45 @@ uint8_t bm_get_bit( BitMatrix *m, uint32_t row, uint32_t col ) {
 // Returns:
 // Nothing.
 void bm_set_bit( BitMatrix *m, uint32_t row, uint32_t col ) {
-	bv_set_bit( m->vector, row * m->cols + col );
+	bv_set_bit( m->vector, row * m->row_words * 64 + col );
+}
+
+// Description:
+// Gets the number of rows in a bit matrix.
+//
+// Parameters:
+// BitMatrix *m - A pointer to a bit matrix.
+//
+// Returns:
+// uint32_t - The number of rows.
+uint32_t bm_rows( BitMatrix *m ) {
+	return m->rows;
+}
+
+// Description:
+// Gets the number of columns in a bit matrix.
+//
+// Parameters:
+// BitMatrix *m - A pointer to a bit matrix.
+//
+// Returns:
+// uint32_t - The number of columns.
+uint32_t bm_cols( BitMatrix *m ) {
+	return m->cols;
+}
+
+// Description:
+// Gets the words of a row of a bit matrix. Column col is bit col % 64 of word col / 64, and the bits past the last
+// column are always 0.
+//
+// Parameters:
+// BitMatrix *m - A pointer to a bit matrix.
+// uint32_t row - The row to get.
+//
+// Returns:
+// uint64_t * - The words of the row. There are ( cols + 63 ) / 64 of them.
+uint64_t *bm_row( BitMatrix *m, uint32_t row ) {
+	return bv_words( m->vector ) + ( size_t ) row * m->row_words;
 }
 
 // Description:
@@ -117,31 +212,280 @@ uint8_t bm_to_data( BitMatrix *m ) {
 }
 
 // Description:
-// Multiplies two bit matrices together.
+// Multiplies two bit matrices together over GF(2) into a cleared matrix. Each row of the result is the XOR of the rows
+// of b selected by the set bits of the same row of a, so the work is done a word at a time.
 //
 // Parameters:
 // BitMatrix *a - A pointer to the first bit matrix.
-// BitMatrix *b - A pointer to the second bit matrix.
+// BitMatrix *b - A pointer to the second bit matrix. Must have as many rows as a has columns.
+// BitMatrix *m - Where to put the result. Must be a->rows x b->cols with all bits clear.
 //
 // Returns:
-// BitMatrix * - The result of the matrices being multiplied.
+// BitMatrix * - m.
+static BitMatrix *multiply_into( BitMatrix *a, BitMatrix *b, BitMatrix *m ) {
+	for ( uint32_t row = 0; row < a->rows; row++ ) {
+		const uint64_t *a_row = bm_row( a, row );
+		uint64_t *m_row = bm_row( m, row );
+
+		for ( uint32_t word = 0; word < a->row_words; word++ ) {
+			// ^ = add % 2, & = multiply % 2, so each set bit adds its row of b.
+			for ( uint64_t bits = a_row[ word ]; bits; bits &= bits - 1 ) {
+				const uint64_t *b_row = bm_row( b, 64 * word + __builtin_ctzll( bits ) );
+
+				for ( uint32_t i = 0; i < m->row_words; i++ ) {
+					m_row[ i ] ^= b_row[ i ];
+				}
+			}
+		}
+	}
+
+	return m;
+}
+
+// Description:
+// Multiplies two bit matrices together over GF(2).
+//
+// Parameters:
+// BitMatrix *a - A pointer to the first bit matrix.
+// BitMatrix *b - A pointer to the second bit matrix. Must have as many rows as a has columns.
+//
+// Returns:
+// BitMatrix * - The result of the matrices being multiplied, or NULL if it couldn't be allocated.
 BitMatrix *bm_multiply( BitMatrix *a, BitMatrix *b ) {
 	BitMatrix *m = bm_create( a->rows, b->cols );
 
-	for ( uint32_t row = 0; row < m->rows; row++ ) {
-		for ( uint32_t col = 0; col < m->cols; col++ ) {
-			uint8_t result = 0;
+	return m ? multiply_into( a, b, m ) : NULL;
+}
+
+// Description:
+// Multiplies two bit matrices together over GF(2), putting the result in an arena.
+//
+// Parameters:
+// Arena *arena - The arena to allocate the result from.
+// BitMatrix *a - A pointer to the first bit matrix.
+// BitMatrix *b - A pointer to the second bit matrix. Must have as many rows as a has columns.
+//
+// Returns:
+// BitMatrix * - The result of the matrices being multiplied, or NULL if the arena is full. Lives until the arena is
+// reset.
+BitMatrix *bm_multiply_in( Arena *arena, BitMatrix *a, BitMatrix *b ) {
+	BitMatrix *m = bm_create_in( arena, a->rows, b->cols );
+
+	return m ? multiply_into( a, b, m ) : NULL;
+}
+
+// Description:
+// Gets the number of bytes of the gray code table bm_multiply_m4rm uses for a group of rows of b.
+//
+// Parameters:
+// uint32_t cols - The number of columns in b.
+//
+// Returns:
+// size_t - The size of the table in bytes.
+static size_t m4rm_table_size( uint32_t cols ) {
+	return ( size_t ) ( 1 << M4RM_GROUP_BITS ) * row_words( cols ) * sizeof( uint64_t );
+}
+
+// Description:
+// Multiplies two bit matrices together over GF(2) into a cleared matrix with the Method of Four Russians. The rows of b
+// are taken M4RM_GROUP_BITS at a time, and every sum of a group's rows is put in a table in gray code order, so each
+// entry is one XOR away from the one before. Each row of a then adds one table entry per group instead of one row of b
+// per set bit.
+//
+// Parameters:
+// BitMatrix *a - A pointer to the first bit matrix.
+// BitMatrix *b - A pointer to the second bit matrix. Must have as many rows as a has columns.
+// BitMatrix *m - Where to put the result. Must be a->rows x b->cols with all bits clear.
+// uint64_t *table - Where to build the tables. Must hold m4rm_table_size( b->cols ) bytes.
+//
+// Returns:
+// BitMatrix * - m.
+static BitMatrix *multiply_m4rm_into( BitMatrix *a, BitMatrix *b, BitMatrix *m, uint64_t *table ) {
+	uint32_t words = m->row_words;
+
+	for ( uint32_t group = 0; group * M4RM_GROUP_BITS < b->rows; group++ ) {
+		uint32_t first_row = group * M4RM_GROUP_BITS;
+		uint32_t group_bits = b->rows - first_row < M4RM_GROUP_BITS ? b->rows - first_row : M4RM_GROUP_BITS;
+
+		for ( uint32_t i = 0; i < words; i++ ) {
+			table[ i ] = 0;
+		}
 
-			for ( uint32_t a_col = 0; a_col < a->cols; a_col++ ) {
-				// ^ = add % 2, & = multiply % 2.
-				result ^= ( bm_get_bit( a, row, a_col ) & bm_get_bit( b, a_col, col ) );
+		for ( uint32_t i = 1; i < ( 1u << group_bits ); i++ ) {
+			// Entry gray( i ) is entry gray( i - 1 ) plus the row of the one bit they differ in.
+			const uint64_t *previous = table + ( size_t ) ( ( i - 1 ) ^ ( ( i - 1 ) >> 1 ) ) * words;
+			const uint64_t *b_row = bm_row( b, first_row + __builtin_ctz( i ) );
+			uint64_t *entry = table + ( size_t ) ( i ^ ( i >> 1 ) ) * words;
+
+			for ( uint32_t w = 0; w < words; w++ ) {
+				entry[ w ] = previous[ w ] ^ b_row[ w ];
 			}
+		}
+
+		for ( uint32_t row = 0; row < a->rows; row++ ) {
+			uint64_t bits = bm_row( a, row )[ first_row / 64 ] >> ( first_row % 64 );
+			const uint64_t *entry = table + ( size_t ) ( bits & ( ( 1u << group_bits ) - 1 ) ) * words;
+			uint64_t *m_row = bm_row( m, row );
 
-			if ( result ) {
-				bm_set_bit( m, row, col );
+			for ( uint32_t w = 0; w < words; w++ ) {
+				m_row[ w ] ^= entry[ w ];
 			}
 		}
 	}
 
 	return m;
 }
+
+// Description:
+// Multiplies two bit matrices together over GF(2) with the Method of Four Russians, which is faster than bm_multiply
+// when a has many rows, such as one message per row.
+//
+// Parameters:
+// BitMatrix *a - A pointer to the first bit matrix.
+// BitMatrix *b - A pointer to the second bit matrix. Must have as many rows as a has columns.
+//
+// Returns:
+// BitMatrix * - The result of the matrices being multiplied, or NULL if it or the tables couldn't be allocated.
+BitMatrix *bm_multiply_m4rm( BitMatrix *a, BitMatrix *b ) {
+	BitMatrix *m = bm_create( a->rows, b->cols );
+	uint64_t *table = malloc( m4rm_table_size( b->cols ) );
+
+	if ( !m || !table ) {
+		free( table );
+		bm_delete( &m );
+
+		return NULL;
+	}
+
+	multiply_m4rm_into( a, b, m, table );
+	free( table );
+
+	return m;
+}
+
+// Description:
+// Gets the number of bytes bm_multiply_m4rm_in allocates from an arena, not counting alignment.
+//
+// Parameters:
+// uint32_t rows - The number of rows in a.
+// uint32_t cols - The number of columns in b.
+//
+// Returns:
+// size_t - The number of bytes.
+size_t bm_multiply_m4rm_size( uint32_t rows, uint32_t cols ) {
+	return bm_size( rows, cols ) + m4rm_table_size( cols );
+}
+
+// Description:
+// Multiplies two bit matrices together over GF(2) with the Method of Four Russians, putting the result and the tables
+// in an arena.
+//
+// Parameters:
+// Arena *arena - The arena to allocate from.
+// BitMatrix *a - A pointer to the first bit matrix.
+// BitMatrix *b - A pointer to the second bit matrix. Must have as many rows as a has columns.
+//
+// Returns:
+// BitMatrix * - The result of the matrices being multiplied, or NULL if the arena is full. Lives until the arena is
+// reset.
+BitMatrix *bm_multiply_m4rm_in( Arena *arena, BitMatrix *a, BitMatrix *b ) {
+	BitMatrix *m = bm_create_in( arena, a->rows, b->cols );
+	uint64_t *table = arena_alloc( arena, m4rm_table_size( b->cols ) );
+
+	return m && table ? multiply_m4rm_into( a, b, m, table ) : NULL;
+}
+
+// Description:
+// Transposes an 8 x 8 block of bits by swapping ever smaller off-diagonal blocks, 4 x 4 down to 1 x 1.
+//
+// Parameters:
+// uint64_t block - The block. Row row is byte row, and column col of a row is bit col of the byte.
+//
+// Returns:
+// uint64_t - The transposed block.
+static uint64_t transpose_8( uint64_t block ) {
+	uint64_t swapped = ( block ^ ( block >> 7 ) ) & 0x00AA00AA00AA00AA;
+	block ^= swapped ^ ( swapped << 7 );
+	swapped = ( block ^ ( block >> 14 ) ) & 0x0000CCCC0000CCCC;
+	block ^= swapped ^ ( swapped << 14 );
+	swapped = ( block ^ ( block >> 28 ) ) & 0x00000000F0F0F0F0;
+	block ^= swapped ^ ( swapped << 28 );
+
+	return block;
+}
+
+// Description:
+// Transposes a 64 x 64 block of bits in place by swapping ever smaller off-diagonal blocks, 32 x 32 down to 1 x 1.
+//
+// Parameters:
+// uint64_t *block - The 64 rows of the block. Column col of a row is bit col.
+//
+// Returns:
+// Nothing.
+static void transpose_64( uint64_t *block ) {
+	uint64_t mask = 0x00000000FFFFFFFF;
+
+	for ( uint32_t width = 32; width; width >>= 1, mask ^= mask << width ) {
+		// Swap the upper width bits of each row with the lower width bits of the row width below it.
+		for ( uint32_t row = 0; row < 64; row = ( ( row | width ) + 1 ) & ~width ) {
+			uint64_t swapped = ( ( block[ row ] >> width ) ^ block[ row | width ] ) & mask;
+			block[ row ] ^= swapped << width;
+			block[ row | width ] ^= swapped;
+		}
+	}
+}
+
+// Description:
+// Transposes a bit matrix 64 x 64 bits at a time, or in one 8 x 8 block if it fits in one.
+//
+// Parameters:
+// BitMatrix *m - A pointer to a bit matrix.
+//
+// Returns:
+// BitMatrix * - The transpose of the bit matrix, or NULL if it couldn't be allocated.
+BitMatrix *bm_transpose( BitMatrix *m ) {
+	BitMatrix *t = bm_create( m->cols, m->rows );
+
+	if ( !t ) {
+		return NULL;
+	}
+
+	if ( m->rows <= 8 && m->cols <= 8 ) {
+		uint64_t small_block = 0;
+
+		for ( uint32_t row = 0; row < m->rows; row++ ) {
+			small_block |= bm_row( m, row )[ 0 ] << ( 8 * row );
+		}
+
+		small_block = transpose_8( small_block );
+
+		for ( uint32_t col = 0; col < m->cols; col++ ) {
+			bm_row( t, col )[ 0 ] = ( small_block >> ( 8 * col ) ) & 0xFF;
+		}
+
+		return t;
+	}
+
+	uint64_t block[ 64 ];
+
+	for ( uint32_t block_row = 0; block_row < m->rows; block_row += 64 ) {
+		uint32_t rows = m->rows - block_row < 64 ? m->rows - block_row : 64;
+
+		for ( uint32_t word = 0; word < m->row_words; word++ ) {
+			uint32_t cols = m->cols - 64 * word < 64 ? m->cols - 64 * word : 64;
+
+			// Rows past the end of the matrix are zeros, and so are the columns past its end after the transpose.
+			for ( uint32_t row = 0; row < 64; row++ ) {
+				block[ row ] = row < rows ? bm_row( m, block_row + row )[ word ] : 0;
+			}
+
+			transpose_64( block );
+
+			for ( uint32_t col = 0; col < cols; col++ ) {
+				bm_row( t, 64 * word + col )[ block_row / 64 ] = block[ col ];
+			}
+		}
+	}
+
+	return t;
+}
@@ -1,22 +1,45 @@
 #ifndef __BM_H__
 #define __BM_H__
 
+#include "arena.h"
+
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct BitMatrix BitMatrix;
 
+size_t bm_size( uint32_t rows, uint32_t cols );
+
 BitMatrix *bm_create( uint32_t rows, uint32_t cols );
 
+BitMatrix *bm_create_in( Arena *arena, uint32_t rows, uint32_t cols );
+
 void bm_delete( BitMatrix **m );
 
 uint8_t bm_get_bit( BitMatrix *m, uint32_t row, uint32_t col );
 
 void bm_set_bit( BitMatrix *m, uint32_t row, uint32_t col );
 
+uint32_t bm_rows( BitMatrix *m );
+
+uint32_t bm_cols( BitMatrix *m );
+
+uint64_t *bm_row( BitMatrix *m, uint32_t row );
+
 BitMatrix *bm_from_data( uint8_t byte, uint32_t length );
 
 uint8_t bm_to_data( BitMatrix *m );
 
 BitMatrix *bm_multiply( BitMatrix *a, BitMatrix *b );
 
+BitMatrix *bm_multiply_in( Arena *arena, BitMatrix *a, BitMatrix *b );
+
+BitMatrix *bm_multiply_m4rm( BitMatrix *a, BitMatrix *b );
+
+size_t bm_multiply_m4rm_size( uint32_t rows, uint32_t cols );
+
+BitMatrix *bm_multiply_m4rm_in( Arena *arena, BitMatrix *a, BitMatrix *b );
+
+BitMatrix *bm_transpose( BitMatrix *m );
+
 #endif
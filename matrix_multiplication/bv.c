@@ -1,43 +1,66 @@
 #include "bv.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Description:
 // A struct for the bit vector ADT.
 //
 // Members:
 // uint32_t length - The number of bits in the bit vector.
-// uint8_t *vector - The array of bytes that will hold the bits.
+// uint64_t vector[] - The array of words that will hold the bits, least significant bit first. Allocated along with
+// the struct.
 struct BitVector {
 	uint32_t length;
-	uint8_t *vector;
+	uint64_t vector[];
 };
 
 // Description:
-// Creates a bit vector.
+// Gets the number of bytes a bit vector takes up, including its bits.
 //
 // Parameters:
 // uint32_t length - The length of the bit vector in bits.
 //
 // Returns:
-// BitVector * - The created bit vector.
-BitVector *bv_create( uint32_t length ) {
-	BitVector *v = malloc( sizeof( BitVector ) );
-
-	if ( v ) { // Make sure v was allocated successfully.
-		v->length = length;
-		v->vector = calloc( 1, length % 8 == 0 ? length / 8 : length / 8 + 1 );
+// size_t - The size of the bit vector in bytes.
+size_t bv_size( uint32_t length ) {
+	return sizeof( BitVector ) + ( length % 64 == 0 ? length / 64 : length / 64 + 1 ) * sizeof( uint64_t );
+}
 
-		if ( !v->vector ) {
-			free( v );
-			v = NULL;
-		}
-	}
+// Description:
+// Creates a bit vector in memory the caller allocated, such as from an arena. The vector is deleted by freeing or
+// resetting that memory, not with bv_delete.
+//
+// Parameters:
+// void *memory - Where to create the bit vector. Must hold bv_size( length ) bytes and be aligned for a uint64_t.
+// uint32_t length - The length of the bit vector in bits.
+//
+// Returns:
+// BitVector * - The created bit vector, with all bits clear.
+BitVector *bv_init( void *memory, uint32_t length ) {
+	BitVector *v = memory;
+	memset( v, 0, bv_size( length ) );
+	v->length = length;
 
 	return v;
 }
 
+// Description:
+// Creates a bit vector with a single allocation for the struct and its bits.
+//
+// Parameters:
+// uint32_t length - The length of the bit vector in bits.
+//
+// Returns:
+// BitVector * - The created bit vector, or NULL if it couldn't be allocated.
+BitVector *bv_create( uint32_t length ) {
+	void *memory = malloc( bv_size( length ) );
+
+	return memory ? bv_init( memory, length ) : NULL;
+}
+
 // Description:
 // Deletes a bit vector.
 //
@@ -47,13 +70,24 @@ BitVector *bv_create( uint32_t length ) {
 // Returns:
 // Nothing.
 void bv_delete( BitVector **v ) {
-	if ( *v && ( *v )->vector ) {
-		free( ( *v )->vector );
+	if ( *v ) {
 		free( *v );
 		*v = NULL;
 	}
 }
 
+// Description:
+// Gets the length of a bit vector.
+//
+// Parameters:
+// BitVector *v - A pointer to a bit vector.
+//
+// Returns:
+// uint32_t - The length of the bit vector in bits.
+uint32_t bv_length( BitVector *v ) {
+	return v->length;
+}
+
 // Description:
 // Gets a bit in a bit vector.
 //
@@ -64,7 +98,7 @@ void bv_delete( BitVector **v ) {
 // Returns:
 // uint8_t - The bit in the bit position specified.
 uint8_t bv_get_bit( BitVector *v, uint32_t i ) {
-	return 1 & ( v->vector[ i / 8 ] >> ( i % 8 ) );
+	return 1 & ( v->vector[ i / 64 ] >> ( i % 64 ) );
 }
 
 // Description:
@@ -77,7 +111,7 @@ uint8_t bv_get_bit( BitVector *v, uint32_t i ) {
 // Returns:
 // Nothing.
 void bv_set_bit( BitVector *v, uint32_t i ) {
-	v->vector[ i / 8 ] |= ( 1 << ( i % 8 ) );
+	v->vector[ i / 64 ] |= ( uint64_t ) 1 << ( i % 64 );
 }
 
 // Description:
@@ -90,7 +124,7 @@ void bv_set_bit( BitVector *v, uint32_t i ) {
 // Returns:
 // uint8_t - The byte in the byte position specified.
 uint8_t bv_get_byte( BitVector *v, uint32_t i ) {
-	return v->vector[ i ];
+	return v->vector[ i / 8 ] >> ( 8 * ( i % 8 ) );
 }
 
 // Description:
@@ -104,5 +138,19 @@ uint8_t bv_get_byte( BitVector *v, uint32_t i ) {
 // Returns:
 // Nothing.
 void bv_set_byte( BitVector *v, uint32_t i, uint8_t byte ) {
-	v->vector[ i ] = byte;
+	uint32_t shift = 8 * ( i % 8 );
+	v->vector[ i / 8 ] = ( v->vector[ i / 8 ] & ~( ( uint64_t ) 0xFF << shift ) ) | ( uint64_t ) byte << shift;
+}
+
+// Description:
+// Gets the words that hold the bits of a bit vector, so whole words can be read and written at once. Bit i is bit
+// i % 64 of word i / 64.
+//
+// Parameters:
+// BitVector *v - A pointer to a bit vector.
+//
+// Returns:
+// uint64_t * - The words of the bit vector.
+uint64_t *bv_words( BitVector *v ) {
+	return v->vector;
 }
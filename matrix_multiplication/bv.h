@@ -1,14 +1,21 @@
 #ifndef __BV_H__
 #define __BV_H__
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct BitVector BitVector;
 
+size_t bv_size( uint32_t length );
+
+BitVector *bv_init( void *memory, uint32_t length );
+
 BitVector *bv_create( uint32_t length );
 
 void bv_delete( BitVector **v );
 
+uint32_t bv_length( BitVector *v );
+
 uint8_t bv_get_bit( BitVector *v, uint32_t i );
 
 void bv_set_bit( BitVector *v, uint32_t i );
@@ -17,4 +24,6 @@ uint8_t bv_get_byte( BitVector *v, uint32_t i );
 
 void bv_set_byte( BitVector *v, uint32_t i, uint8_t byte );
 
+uint64_t *bv_words( BitVector *v );
+
 #endif
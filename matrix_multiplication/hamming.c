@@ -1,11 +1,47 @@
 #include "hamming.h"
 
+#include "arena.h"
 #include "bm.h"
 
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HAM_CODE_BATCH_CODES 1024 // Number of codewords the wide-code functions encode or decode at once.
+#define NIBBLE_SCRATCH_WORDS 16 // Size in words of the scratch arena for the two 1-row matrices of a Hamming(8, 4) product.
 
 // Description:
-// Encodes a 4-bit message into a Hamming(8, 4) code.
+// A struct for an extended Hamming(n, k) code, built so each data bit's column of H has an odd weight of at least 3.
+// This makes every single-bit error's syndrome distinct and odd, and every double-bit error's syndrome even.
+//
+// Members:
+// uint32_t n - The number of bits in a code.
+// uint32_t k - The number of message bits in a code.
+// uint32_t codes_per_unit - The number of codes needed for both the messages and the codes to fill whole bytes.
+// BitMatrix *g - The k x n generator matrix, the identity followed by the parity bits of each message bit.
+// BitMatrix *ht - The n x (n - k) transpose of the parity-checker matrix, the parity bits followed by the identity.
+// int32_t *corrections - For each syndrome, the position of the bit to flip, or HAM_OK or HAM_ERR.
+// uint8_t encode_lookup[ 16 ] - For Hamming(8, 4), the code of each message.
+// uint8_t decode_lookup[ 256 ] - For Hamming(8, 4), the corrected message of each code, or 0 if uncorrectable.
+// int8_t decode_status[ 256 ] - For Hamming(8, 4), the HAM_STATUS of each code.
+struct HammingCode {
+	uint32_t n;
+	uint32_t k;
+	uint32_t codes_per_unit;
+	BitMatrix *g;
+	BitMatrix *ht;
+	int32_t *corrections;
+	uint8_t encode_lookup[ 16 ];
+	uint8_t decode_lookup[ 256 ];
+	int8_t decode_status[ 256 ];
+};
+
+// Description:
+// Encodes a 4-bit message into a Hamming(8, 4) code by multiplying it with the generator matrix. Doesn't touch any shared
+// state or the heap, but loops should still use the faster tables built by ham_code_create instead.
 //
 // Parameters:
 // BitMatrix *g - The generator matrix.
@@ -14,27 +50,19 @@
 // Returns:
 // uint8_t - The Hamming(8, 4) code.
 uint8_t ham_encode( BitMatrix *g, uint8_t msg ) {
-	// Array used to cache encode results.
-	static uint8_t encode_lookup[ 16 ] = { 0 };
-	uint8_t lower_nibble = msg & 0xF;
-	uint8_t result = 0;
+	uint64_t scratch_memory[ NIBBLE_SCRATCH_WORDS ];
+	Arena scratch;
+	arena_init( &scratch, scratch_memory, sizeof( scratch_memory ) );
+	BitMatrix *msg_matrix = bm_create_in( &scratch, 1, 4 );
+	bm_row( msg_matrix, 0 )[ 0 ] = msg & 0xF;
 
-	if ( lower_nibble != 0 && encode_lookup[ lower_nibble ] == 0 ) { // Not in cache.
-		BitMatrix *msg_matrix = bm_from_data( lower_nibble, 4 );
-		BitMatrix *result_matrix = bm_multiply( msg_matrix, g );
-		result = bm_to_data( result_matrix );
-		encode_lookup[ lower_nibble ] = result; // Add to cache.
-		bm_delete( &result_matrix );
-		bm_delete( &msg_matrix );
-	} else { // Found in cache.
-		result = encode_lookup[ lower_nibble ];
-	}
-
-	return result;
+	return bm_to_data( bm_multiply_in( &scratch, msg_matrix, g ) );
 }
 
 // Description:
-// Decodes a Hamming(8, 4) code to a 4-bit message.
+// Decodes a Hamming(8, 4) code to a 4-bit message by multiplying it with the transpose of the parity checker matrix.
+// Doesn't touch any shared state or the heap, but loops should still use the faster tables built by ham_code_create
+// instead.
 //
 // Parameters:
 // BitMatrix *ht - The transpose of the parity checker matrix.
@@ -44,24 +72,14 @@ uint8_t ham_encode( BitMatrix *g, uint8_t msg ) {
 // Returns:
 // HAM_STATUS - Whether the hamming code could be successfully decoded.
 HAM_STATUS ham_decode( BitMatrix *ht, uint8_t code, uint8_t *msg ) {
-	// Array used to cache error syndrome calculations.
-	static uint8_t error_syndrome_calculate_lookup[ 256 ] = { 0 };
 	// Lookup table for corrections to make with a certain error syndrome.
 	static const int8_t error_syndrome_corrections[] = { HAM_OK, 4, 5, HAM_ERR, 6, HAM_ERR, HAM_ERR, 3, 7, HAM_ERR, HAM_ERR, 2, HAM_ERR, 1, 0, HAM_ERR };
-	uint8_t error_syndrome = 0;
-
-	if ( error_syndrome_calculate_lookup[ code ] == 0 ) { // Not in cache.
-		BitMatrix *code_matrix = bm_from_data( code, 8 );
-		BitMatrix *error_syndrome_matrix = bm_multiply( code_matrix, ht );
-		error_syndrome = bm_to_data( error_syndrome_matrix );
-		// Bias the error syndrome in the cache, so 0 is reserved for "no value found".
-		error_syndrome_calculate_lookup[ code ] = error_syndrome + 1; // Add to cache.
-		bm_delete( &error_syndrome_matrix );
-		bm_delete( &code_matrix );
-	} else { // Found in cache.
-		// Reverse the bias in the cache for the error syndrome.
-		error_syndrome = error_syndrome_calculate_lookup[ code ] - 1;
-	}
+	uint64_t scratch_memory[ NIBBLE_SCRATCH_WORDS ];
+	Arena scratch;
+	arena_init( &scratch, scratch_memory, sizeof( scratch_memory ) );
+	BitMatrix *code_matrix = bm_create_in( &scratch, 1, 8 );
+	bm_row( code_matrix, 0 )[ 0 ] = code;
+	uint8_t error_syndrome = bm_to_data( bm_multiply_in( &scratch, code_matrix, ht ) );
 
 	int8_t correct = error_syndrome_corrections[ error_syndrome ];
 
@@ -82,3 +100,651 @@ HAM_STATUS ham_decode( BitMatrix *ht, uint8_t code, uint8_t *msg ) {
 		return HAM_CORRECT;
 	}
 }
+
+// Description:
+// Parses a code given on the command line as "n,k".
+//
+// Parameters:
+// const char *str - The string to parse.
+// uint32_t *n - Where to put the code length. Will be unmodified upon failure.
+// uint32_t *k - Where to put the message length. Will be unmodified upon failure.
+//
+// Returns:
+// bool - Whether the string was two numbers separated by a comma.
+bool ham_code_parse( const char *str, uint32_t *n, uint32_t *k ) {
+	char *end = NULL;
+	errno = 0;
+	unsigned long parsed_n = strtoul( str, &end, 10 );
+
+	if ( errno || end == str || *end != ',' || parsed_n > HAM_CODE_MAX_LENGTH ) {
+		return false;
+	}
+
+	const char *k_str = end + 1;
+	unsigned long parsed_k = strtoul( k_str, &end, 10 );
+
+	if ( errno || end == k_str || *end != '\0' || parsed_k > HAM_CODE_MAX_LENGTH ) {
+		return false;
+	}
+
+	*n = parsed_n;
+	*k = parsed_k;
+
+	return true;
+}
+
+// Description:
+// Computes the greatest common divisor of two numbers.
+//
+// Parameters:
+// uint32_t a - The first number.
+// uint32_t b - The second number.
+//
+// Returns:
+// uint32_t - The greatest common divisor.
+static uint32_t gcd( uint32_t a, uint32_t b ) {
+	while ( b ) {
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+// Description:
+// Counts the set bits of a number.
+//
+// Parameters:
+// uint32_t x - The number.
+//
+// Returns:
+// uint32_t - The number of set bits.
+static uint32_t weight( uint32_t x ) {
+	uint32_t count = 0;
+
+	for ( ; x; x &= x - 1 ) {
+		count++;
+	}
+
+	return count;
+}
+
+// Description:
+// Builds the Hamming(8, 4) tables of a code from its matrices, so encoding and decoding never multiply matrices again.
+//
+// Parameters:
+// HammingCode *code - The Hamming(8, 4) code.
+//
+// Returns:
+// Nothing.
+static void build_nibble_tables( HammingCode *code ) {
+	for ( uint32_t msg = 0; msg < 16; msg++ ) {
+		code->encode_lookup[ msg ] = ham_encode( code->g, msg );
+	}
+
+	for ( uint32_t codeword = 0; codeword < 256; codeword++ ) {
+		uint8_t msg = 0;
+		code->decode_status[ codeword ] = ham_decode( code->ht, codeword, &msg );
+		code->decode_lookup[ codeword ] = msg;
+	}
+}
+
+// Description:
+// Creates an extended Hamming(n, k) code. Each message bit gets a distinct column of H with an odd weight of at least 3,
+// taking the lowest weights first and higher values first within a weight, so Hamming(8, 4) matches the original matrices.
+// Any k up to 2^(n - k - 1) - (n - k) works, which covers (2^r, 2^r - r - 1) codes like (16, 11) and (128, 120) and
+// shortened codes like (72, 64).
+//
+// Parameters:
+// uint32_t n - The number of bits in a code.
+// uint32_t k - The number of message bits in a code.
+//
+// Returns:
+// HammingCode * - The created code, or NULL if the code isn't supported or allocation failed.
+HammingCode *ham_code_create( uint32_t n, uint32_t k ) {
+	uint32_t check_bits = n - k;
+
+	if ( k == 0 || n <= k || n > HAM_CODE_MAX_LENGTH || check_bits > HAM_CODE_MAX_CHECK || k > ( 1u << ( check_bits - 1 ) ) - check_bits ) {
+		return NULL;
+	}
+
+	HammingCode *code = calloc( 1, sizeof( HammingCode ) );
+
+	if ( !code ) {
+		return NULL;
+	}
+
+	code->n = n;
+	code->k = k;
+	code->codes_per_unit = 8 / gcd( 8, gcd( n, k ) );
+	code->g = bm_create( k, n );
+	code->ht = bm_create( n, check_bits );
+	code->corrections = malloc( sizeof( int32_t ) << check_bits );
+
+	if ( !code->g || !code->ht || !code->corrections ) {
+		ham_code_delete( &code );
+
+		return NULL;
+	}
+
+	for ( uint32_t syndrome = 0; syndrome < ( 1u << check_bits ); syndrome++ ) {
+		code->corrections[ syndrome ] = syndrome == 0 ? HAM_OK : HAM_ERR;
+	}
+
+	uint32_t row = 0;
+
+	for ( uint32_t column_weight = 3; column_weight <= check_bits && row < k; column_weight += 2 ) {
+		for ( uint32_t column = 1u << check_bits; column-- > 0 && row < k; ) {
+			if ( weight( column ) != column_weight ) {
+				continue;
+			}
+
+			bm_set_bit( code->g, row, row );
+
+			for ( uint32_t bit = 0; bit < check_bits; bit++ ) {
+				if ( ( column >> bit ) & 1 ) {
+					bm_set_bit( code->g, row, k + bit );
+					bm_set_bit( code->ht, row, bit );
+				}
+			}
+
+			code->corrections[ column ] = row;
+			row++;
+		}
+	}
+
+	for ( uint32_t bit = 0; bit < check_bits; bit++ ) {
+		bm_set_bit( code->ht, k + bit, bit );
+		code->corrections[ 1u << bit ] = k + bit;
+	}
+
+	if ( n == 8 && k == 4 ) {
+		build_nibble_tables( code );
+	}
+
+	return code;
+}
+
+// Description:
+// Deletes a code.
+//
+// Parameters:
+// HammingCode **code - A pointer to a pointer to a code.
+//
+// Returns:
+// Nothing.
+void ham_code_delete( HammingCode **code ) {
+	if ( *code ) {
+		free( ( *code )->corrections );
+		bm_delete( &( *code )->ht );
+		bm_delete( &( *code )->g );
+		free( *code );
+		*code = NULL;
+	}
+}
+
+// Description:
+// Gets the number of bits in a code.
+//
+// Parameters:
+// HammingCode *code - The code.
+//
+// Returns:
+// uint32_t - n.
+uint32_t ham_code_length( HammingCode *code ) {
+	return code->n;
+}
+
+// Description:
+// Gets the number of message bits in a code.
+//
+// Parameters:
+// HammingCode *code - The code.
+//
+// Returns:
+// uint32_t - k.
+uint32_t ham_code_message_length( HammingCode *code ) {
+	return code->k;
+}
+
+// Description:
+// Gets the generator matrix of a code.
+//
+// Parameters:
+// HammingCode *code - The code.
+//
+// Returns:
+// BitMatrix * - The k x n generator matrix. Owned by the code.
+BitMatrix *ham_code_generator( HammingCode *code ) {
+	return code->g;
+}
+
+// Description:
+// Gets the transpose of the parity-checker matrix of a code.
+//
+// Parameters:
+// HammingCode *code - The code.
+//
+// Returns:
+// BitMatrix * - The n x (n - k) transpose of the parity-checker matrix. Owned by the code.
+BitMatrix *ham_code_h_transpose( HammingCode *code ) {
+	return code->ht;
+}
+
+// Description:
+// Gets the number of data bytes in a unit, the smallest number of whole bytes that holds a whole number of messages.
+//
+// Parameters:
+// HammingCode *code - The code.
+//
+// Returns:
+// size_t - The number of data bytes in a unit.
+size_t ham_code_data_unit( HammingCode *code ) {
+	return code->k * code->codes_per_unit / 8;
+}
+
+// Description:
+// Gets the number of code bytes in a unit, which hold the codes of the messages in a data unit.
+//
+// Parameters:
+// HammingCode *code - The code.
+//
+// Returns:
+// size_t - The number of code bytes in a unit.
+size_t ham_code_code_unit( HammingCode *code ) {
+	return code->n * code->codes_per_unit / 8;
+}
+
+// Description:
+// Gets the number of bytes of scratch memory the wide-code functions need to work on HAM_CODE_BATCH_CODES codewords at
+// once. With less, they work on one codeword at a time.
+//
+// Parameters:
+// HammingCode *code - The code.
+//
+// Returns:
+// size_t - The number of bytes.
+size_t ham_code_scratch_size( HammingCode *code ) {
+	size_t encode_size = bm_size( HAM_CODE_BATCH_CODES, code->k ) + bm_multiply_m4rm_size( HAM_CODE_BATCH_CODES, code->n );
+	size_t decode_size = bm_size( HAM_CODE_BATCH_CODES, code->n ) + bm_multiply_m4rm_size( HAM_CODE_BATCH_CODES, code->n - code->k );
+
+	// Each of the three allocations may need padding to be aligned.
+	return ( encode_size > decode_size ? encode_size : decode_size ) + 3 * ARENA_ALIGNMENT;
+}
+
+// Description:
+// Gets up to 64 bits of a stream of bytes, counting from the lowest bit of the first byte. Only reads the bytes that
+// hold the bits.
+//
+// Parameters:
+// const uint8_t *data - The stream.
+// size_t bit - The position of the first bit to get.
+// uint32_t count - The number of bits to get, from 1 to 64.
+//
+// Returns:
+// uint64_t - The bits, the first one lowest.
+static uint64_t get_stream_bits( const uint8_t *data, size_t bit, uint32_t count ) {
+	const uint8_t *bytes = data + bit / 8;
+	uint32_t shift = bit % 8;
+	uint32_t length = ( shift + count + 7 ) / 8;
+	uint64_t bits = bytes[ 0 ] >> shift;
+
+	for ( uint32_t i = 1; i < length; i++ ) {
+		bits |= ( uint64_t ) bytes[ i ] << ( 8 * i - shift );
+	}
+
+	return count == 64 ? bits : bits & ( ( ( uint64_t ) 1 << count ) - 1 );
+}
+
+// Description:
+// Sets up to 64 bits of a stream of bytes, counting from the lowest bit of the first byte. The bits must be clear.
+//
+// Parameters:
+// uint8_t *data - The stream.
+// size_t bit - The position of the first bit to set.
+// uint64_t bits - The bits, the first one lowest. Bits past count must be 0.
+// uint32_t count - The number of bits to set, from 1 to 64.
+//
+// Returns:
+// Nothing.
+static void put_stream_bits( uint8_t *data, size_t bit, uint64_t bits, uint32_t count ) {
+	uint8_t *bytes = data + bit / 8;
+	uint32_t shift = bit % 8;
+	uint32_t length = ( shift + count + 7 ) / 8;
+	bytes[ 0 ] |= bits << shift;
+
+	for ( uint32_t i = 1; i < length; i++ ) {
+		bytes[ i ] |= bits >> ( 8 * i - shift );
+	}
+}
+
+// Description:
+// Fills the rows of a bit matrix from consecutive pieces of a stream, one row's worth of bits per row.
+//
+// Parameters:
+// BitMatrix *m - The bit matrix.
+// const uint8_t *data - The stream.
+// size_t first_bit - The position in the stream of the first bit of the first row.
+//
+// Returns:
+// Nothing.
+static void load_rows( BitMatrix *m, const uint8_t *data, size_t first_bit ) {
+	uint32_t cols = bm_cols( m );
+
+	for ( uint32_t row = 0; row < bm_rows( m ); row++ ) {
+		uint64_t *words = bm_row( m, row );
+
+		for ( uint32_t col = 0; col < cols; col += 64 ) {
+			words[ col / 64 ] = get_stream_bits( data, first_bit + ( size_t ) row * cols + col, cols - col < 64 ? cols - col : 64 );
+		}
+	}
+}
+
+// Description:
+// Writes the first columns of the rows of a bit matrix to consecutive pieces of a cleared stream.
+//
+// Parameters:
+// BitMatrix *m - The bit matrix.
+// uint8_t *data - The stream.
+// size_t first_bit - The position in the stream of the first bit of the first row.
+// uint32_t cols - The number of columns of each row to write.
+//
+// Returns:
+// Nothing.
+static void store_rows( BitMatrix *m, uint8_t *data, size_t first_bit, uint32_t cols ) {
+	for ( uint32_t row = 0; row < bm_rows( m ); row++ ) {
+		const uint64_t *words = bm_row( m, row );
+
+		for ( uint32_t col = 0; col < cols; col += 64 ) {
+			uint32_t count = cols - col < 64 ? cols - col : 64;
+			uint64_t mask = count == 64 ? UINT64_MAX : ( ( uint64_t ) 1 << count ) - 1;
+			put_stream_bits( data, first_bit + ( size_t ) row * cols + col, words[ col / 64 ] & mask, count );
+		}
+	}
+}
+
+// Description:
+// Encodes units of data. The data is a stream of k-bit messages and the result is a stream of n-bit codes, both
+// starting from the lowest bit of the first byte. The messages are encoded HAM_CODE_BATCH_CODES at a time as the rows of
+// one matrix, which is multiplied by the generator matrix with the Method of Four Russians.
+//
+// Parameters:
+// HammingCode *code - The code.
+// Arena *scratch - The arena the matrices are made in. Is reset for every batch, so nothing is allocated from the heap.
+// Must hold at least HAM_CODE_SCRATCH_SIZE bytes, and messages are encoded one at a time if it holds less than
+// ham_code_scratch_size( code ) bytes.
+// const uint8_t *in - The data to encode. Must hold units * ham_code_data_unit( code ) bytes.
+// uint8_t *out - Where to put the codes. Must hold units * ham_code_code_unit( code ) bytes.
+// size_t units - The number of units to encode.
+//
+// Returns:
+// Nothing.
+void ham_code_encode_units( HammingCode *code, Arena *scratch, const uint8_t *in, uint8_t *out, size_t units ) {
+	bool batched = scratch->size >= ham_code_scratch_size( code );
+	size_t batch_codes = batched ? HAM_CODE_BATCH_CODES : 1;
+	BitMatrix *( *multiply )( Arena *arena, BitMatrix *a, BitMatrix *b ) = batched ? bm_multiply_m4rm_in : bm_multiply_in;
+	size_t codes = units * code->codes_per_unit;
+	memset( out, 0, units * ham_code_code_unit( code ) );
+
+	for ( size_t first = 0; first < codes; first += batch_codes ) {
+		arena_reset( scratch );
+		BitMatrix *messages = bm_create_in( scratch, codes - first < batch_codes ? codes - first : batch_codes, code->k );
+		load_rows( messages, in, first * code->k );
+		store_rows( multiply( scratch, messages, code->g ), out, first * code->n, code->n );
+	}
+}
+
+// Description:
+// Decodes units of codes. Messages of uncorrectable codes are set to 0. The codes are decoded HAM_CODE_BATCH_CODES at a
+// time as the rows of one matrix, whose syndromes are found by multiplying it by the transpose of the parity-checker
+// matrix with the Method of Four Russians.
+//
+// Parameters:
+// HammingCode *code - The code.
+// Arena *scratch - The arena the matrices are made in. Is reset for every batch, so nothing is allocated from the heap.
+// Must hold at least HAM_CODE_SCRATCH_SIZE bytes, and codes are decoded one at a time if it holds less than
+// ham_code_scratch_size( code ) bytes.
+// const uint8_t *in - The codes to decode. Must hold units * ham_code_code_unit( code ) bytes.
+// uint8_t *out - Where to put the data. Must hold units * ham_code_data_unit( code ) bytes.
+// size_t units - The number of units to decode.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_code_decode_units( HammingCode *code, Arena *scratch, const uint8_t *in, uint8_t *out, size_t units, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	bool batched = scratch->size >= ham_code_scratch_size( code );
+	size_t batch_codes = batched ? HAM_CODE_BATCH_CODES : 1;
+	BitMatrix *( *multiply )( Arena *arena, BitMatrix *a, BitMatrix *b ) = batched ? bm_multiply_m4rm_in : bm_multiply_in;
+	size_t codes = units * code->codes_per_unit;
+	memset( out, 0, units * ham_code_data_unit( code ) );
+
+	for ( size_t first = 0; first < codes; first += batch_codes ) {
+		arena_reset( scratch );
+		BitMatrix *received = bm_create_in( scratch, codes - first < batch_codes ? codes - first : batch_codes, code->n );
+		load_rows( received, in, first * code->n );
+		BitMatrix *error_syndromes = multiply( scratch, received, code->ht );
+
+		for ( uint32_t row = 0; row < bm_rows( received ); row++ ) {
+			uint64_t *words = bm_row( received, row );
+			int32_t correct = code->corrections[ bm_row( error_syndromes, row )[ 0 ] ];
+
+			if ( correct == HAM_ERR ) {
+				*uncorrectable_errors += 1;
+
+				for ( uint32_t col = 0; col < code->k; col += 64 ) {
+					words[ col / 64 ] = 0;
+				}
+			} else if ( correct != HAM_OK ) {
+				*corrected_errors += 1;
+				words[ correct / 64 ] ^= ( uint64_t ) 1 << ( correct % 64 ); // Flip the bit to be corrected.
+			}
+		}
+
+		store_rows( received, out, first * code->k, code->k );
+	}
+}
+
+// Description:
+// Counts the corrected and uncorrectable codes in units without decoding them. Codes are checked HAM_CODE_BATCH_CODES at
+// a time like ham_code_decode_units, but only their syndromes are looked at.
+//
+// Parameters:
+// HammingCode *code - The code.
+// Arena *scratch - The arena the matrices are made in. Same as for ham_code_decode_units.
+// const uint8_t *in - The codes to check. Must hold units * ham_code_code_unit( code ) bytes.
+// size_t units - The number of units to check.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_code_verify_units( HammingCode *code, Arena *scratch, const uint8_t *in, size_t units, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	bool batched = scratch->size >= ham_code_scratch_size( code );
+	size_t batch_codes = batched ? HAM_CODE_BATCH_CODES : 1;
+	BitMatrix *( *multiply )( Arena *arena, BitMatrix *a, BitMatrix *b ) = batched ? bm_multiply_m4rm_in : bm_multiply_in;
+	size_t codes = units * code->codes_per_unit;
+
+	for ( size_t first = 0; first < codes; first += batch_codes ) {
+		arena_reset( scratch );
+		BitMatrix *received = bm_create_in( scratch, codes - first < batch_codes ? codes - first : batch_codes, code->n );
+		load_rows( received, in, first * code->n );
+		BitMatrix *error_syndromes = multiply( scratch, received, code->ht );
+
+		for ( uint32_t row = 0; row < bm_rows( error_syndromes ); row++ ) {
+			int32_t correct = code->corrections[ bm_row( error_syndromes, row )[ 0 ] ];
+			*uncorrectable_errors += correct == HAM_ERR;
+			*corrected_errors += correct != HAM_ERR && correct != HAM_OK;
+		}
+	}
+}
+
+// Description:
+// Flips back the wrong bit of every code in units that has a correctable error, so the codes are stored correctly again.
+// Uncorrectable codes are left as they are. Codes are checked HAM_CODE_BATCH_CODES at a time like ham_code_decode_units.
+//
+// Parameters:
+// HammingCode *code - The code.
+// Arena *scratch - The arena the matrices are made in. Same as for ham_code_decode_units.
+// uint8_t *codes - The codes to repair in place. Must hold units * ham_code_code_unit( code ) bytes.
+// size_t units - The number of units to repair.
+//
+// Returns:
+// size_t - The number of codes that were repaired.
+size_t ham_code_repair_units( HammingCode *code, Arena *scratch, uint8_t *codes, size_t units ) {
+	bool batched = scratch->size >= ham_code_scratch_size( code );
+	size_t batch_codes = batched ? HAM_CODE_BATCH_CODES : 1;
+	BitMatrix *( *multiply )( Arena *arena, BitMatrix *a, BitMatrix *b ) = batched ? bm_multiply_m4rm_in : bm_multiply_in;
+	size_t total_codes = units * code->codes_per_unit;
+	size_t repaired = 0;
+
+	for ( size_t first = 0; first < total_codes; first += batch_codes ) {
+		arena_reset( scratch );
+		BitMatrix *received = bm_create_in( scratch, total_codes - first < batch_codes ? total_codes - first : batch_codes, code->n );
+		load_rows( received, codes, first * code->n );
+		BitMatrix *error_syndromes = multiply( scratch, received, code->ht );
+
+		for ( uint32_t row = 0; row < bm_rows( error_syndromes ); row++ ) {
+			int32_t correct = code->corrections[ bm_row( error_syndromes, row )[ 0 ] ];
+
+			if ( correct != HAM_ERR && correct != HAM_OK ) {
+				size_t bit = ( first + row ) * code->n + correct;
+				codes[ bit / 8 ] ^= 1 << ( bit % 8 );
+				repaired++;
+			}
+		}
+	}
+
+	return repaired;
+}
+
+// Description:
+// Encodes a 4-bit message into a Hamming(8, 4) code with the code's tables.
+//
+// Parameters:
+// const HammingCode *code - The Hamming(8, 4) code.
+// uint8_t msg - The message to encode.
+//
+// Returns:
+// uint8_t - The Hamming(8, 4) code.
+uint8_t ham_code_lookup_encode( const HammingCode *code, uint8_t msg ) {
+	return code->encode_lookup[ msg & 0xF ];
+}
+
+// Description:
+// Decodes a Hamming(8, 4) code to a 4-bit message with the code's tables.
+//
+// Parameters:
+// const HammingCode *code - The Hamming(8, 4) code.
+// uint8_t codeword - The code to decode.
+// uint8_t *msg - Where to put the decoded message. Will be unmodified upon failure.
+//
+// Returns:
+// HAM_STATUS - Whether the hamming code could be successfully decoded.
+HAM_STATUS ham_code_lookup_decode( const HammingCode *code, uint8_t codeword, uint8_t *msg ) {
+	if ( code->decode_status[ codeword ] != HAM_ERR ) {
+		*msg = code->decode_lookup[ codeword ];
+	}
+
+	return code->decode_status[ codeword ];
+}
+
+// Description:
+// Encodes bytes into Hamming(8, 4) codes with the code's tables, outputting the lower nibble's code followed by the upper
+// nibble's code for each byte.
+//
+// Parameters:
+// const HammingCode *code - The Hamming(8, 4) code.
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes. Must hold 2 * n bytes.
+// size_t n - The number of bytes to encode.
+//
+// Returns:
+// Nothing.
+void ham_code_encode_bytes( const HammingCode *code, const uint8_t *in, uint8_t *out, size_t n ) {
+	for ( size_t i = 0; i < n; i++ ) {
+		out[ 2 * i ] = code->encode_lookup[ in[ i ] & 0xF ];
+		out[ 2 * i + 1 ] = code->encode_lookup[ in[ i ] >> 4 ];
+	}
+}
+
+// Description:
+// Decodes Hamming(8, 4) code pairs into bytes with the code's tables, without branching on the codes.
+//
+// Parameters:
+// const HammingCode *code - The Hamming(8, 4) code.
+// const uint8_t *in - The codes to decode, the lower nibble's code followed by the upper nibble's code for each byte.
+// uint8_t *out - Where to put the decoded bytes. Must hold n bytes. Bytes with an uncorrectable nibble are set to 0.
+// size_t n - The number of bytes to decode.
+// uint64_t *corrected_errors - The counter to add corrected codes to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_code_decode_bytes( const HammingCode *code, const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	uint64_t corrected = 0;
+	uint64_t uncorrectable = 0;
+
+	for ( size_t i = 0; i < n; i++ ) {
+		int8_t lower_nibble_status = code->decode_status[ in[ 2 * i ] ];
+		int8_t upper_nibble_status = code->decode_status[ in[ 2 * i + 1 ] ];
+		uint8_t failed = ( lower_nibble_status == HAM_ERR ) | ( upper_nibble_status == HAM_ERR );
+		uncorrectable += ( lower_nibble_status == HAM_ERR ) + ( upper_nibble_status == HAM_ERR );
+		corrected += ( lower_nibble_status == HAM_CORRECT ) + ( upper_nibble_status == HAM_CORRECT );
+		// Output 0 upon failure.
+		out[ i ] = ( ( code->decode_lookup[ in[ 2 * i + 1 ] ] << 4 ) | code->decode_lookup[ in[ 2 * i ] ] ) & ( failed - 1 );
+	}
+
+	*corrected_errors += corrected;
+	*uncorrectable_errors += uncorrectable;
+}
+
+// Description:
+// Counts the corrected and uncorrectable Hamming(8, 4) codes with the code's tables, without decoding them.
+//
+// Parameters:
+// const HammingCode *code - The Hamming(8, 4) code.
+// const uint8_t *in - The codes to check.
+// size_t n - The number of codes to check.
+// uint64_t *corrected_errors - The counter to add codes that would be corrected to.
+// uint64_t *uncorrectable_errors - The counter to add uncorrectable codes to.
+//
+// Returns:
+// Nothing.
+void ham_code_verify_bytes( const HammingCode *code, const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors ) {
+	uint64_t corrected = 0;
+	uint64_t uncorrectable = 0;
+
+	for ( size_t i = 0; i < n; i++ ) {
+		uncorrectable += code->decode_status[ in[ i ] ] == HAM_ERR;
+		corrected += code->decode_status[ in[ i ] ] == HAM_CORRECT;
+	}
+
+	*corrected_errors += corrected;
+	*uncorrectable_errors += uncorrectable;
+}
+
+// Description:
+// Rewrites the Hamming(8, 4) codes that have a correctable error with the code of their corrected nibble, using the
+// code's tables. Uncorrectable codes are left as they are.
+//
+// Parameters:
+// const HammingCode *code - The Hamming(8, 4) code.
+// uint8_t *codes - The codes to repair in place.
+// size_t n - The number of codes.
+//
+// Returns:
+// size_t - The number of codes that were rewritten.
+size_t ham_code_repair_bytes( const HammingCode *code, uint8_t *codes, size_t n ) {
+	size_t repaired = 0;
+
+	for ( size_t i = 0; i < n; i++ ) {
+		if ( code->decode_status[ codes[ i ] ] == HAM_CORRECT ) {
+			codes[ i ] = code->encode_lookup[ code->decode_lookup[ codes[ i ] ] ];
+			repaired++;
+		}
+	}
+
+	return repaired;
+}
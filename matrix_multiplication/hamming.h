@@ -1,8 +1,11 @@
 #ifndef __HAMMING_H__
 #define __HAMMING_H__
 
+#include "arena.h"
 #include "bm.h"
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef enum HAM_STATUS {
@@ -11,8 +14,54 @@ typedef enum HAM_STATUS {
 	HAM_CORRECT = -1, // Detected error and corrected.
 } HAM_STATUS;
 
+#define HAM_CODE_MAX_LENGTH   4096 // Maximum code length in bits.
+#define HAM_CODE_MAX_CHECK    16 // Maximum number of check bits.
+#define HAM_CODE_SCRATCH_SIZE ( 2 * ( 64 + HAM_CODE_MAX_LENGTH / 8 ) ) // Minimum size in bytes of the scratch arena the wide-code functions need.
+
+typedef struct HammingCode HammingCode;
+
 uint8_t ham_encode( BitMatrix *g, uint8_t msg );
 
 HAM_STATUS ham_decode( BitMatrix *ht, uint8_t code, uint8_t *msg );
 
+bool ham_code_parse( const char *str, uint32_t *n, uint32_t *k );
+
+HammingCode *ham_code_create( uint32_t n, uint32_t k );
+
+void ham_code_delete( HammingCode **code );
+
+uint32_t ham_code_length( HammingCode *code );
+
+uint32_t ham_code_message_length( HammingCode *code );
+
+BitMatrix *ham_code_generator( HammingCode *code );
+
+BitMatrix *ham_code_h_transpose( HammingCode *code );
+
+size_t ham_code_data_unit( HammingCode *code );
+
+size_t ham_code_code_unit( HammingCode *code );
+
+size_t ham_code_scratch_size( HammingCode *code );
+
+void ham_code_encode_units( HammingCode *code, Arena *scratch, const uint8_t *in, uint8_t *out, size_t units );
+
+void ham_code_decode_units( HammingCode *code, Arena *scratch, const uint8_t *in, uint8_t *out, size_t units, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+void ham_code_verify_units( HammingCode *code, Arena *scratch, const uint8_t *in, size_t units, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+size_t ham_code_repair_units( HammingCode *code, Arena *scratch, uint8_t *codes, size_t units );
+
+uint8_t ham_code_lookup_encode( const HammingCode *code, uint8_t msg );
+
+HAM_STATUS ham_code_lookup_decode( const HammingCode *code, uint8_t codeword, uint8_t *msg );
+
+void ham_code_encode_bytes( const HammingCode *code, const uint8_t *in, uint8_t *out, size_t n );
+
+void ham_code_decode_bytes( const HammingCode *code, const uint8_t *in, uint8_t *out, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+void ham_code_verify_bytes( const HammingCode *code, const uint8_t *in, size_t n, uint64_t *corrected_errors, uint64_t *uncorrectable_errors );
+
+size_t ham_code_repair_bytes( const HammingCode *code, uint8_t *codes, size_t n );
+
 #endif
@@ -1,5 +1,12 @@
+#include "block_io.h"
 #include "bm.h"
+#include "error_map.h"
+#include "frame_io.h"
 #include "hamming.h"
+#include "io_engine.h"
+#include "parallel_io.h"
+#include "range_io.h"
+#include "verify_io.h"
 
 #include <getopt.h>
 #include <inttypes.h>
@@ -8,11 +15,28 @@
 #include <stdlib.h>
 #include <sys/stat.h>
 
-#define OPTIONS "hvi:o:" // Valid options for the program.
+#define OPTIONS "hvc:b:j:mpui:o:" // Valid options for the program.
+
+// Values getopt_long returns for the options with only a long name.
+enum { OPTION_VERIFY = 256, OPTION_REPAIR, OPTION_BWLIMIT, OPTION_FRAMED, OPTION_OFFSET, OPTION_LENGTH, OPTION_ERROR_MAP };
+
+// Long names of the options.
+static const struct option long_options[] = {
+	{ "verify", no_argument, NULL, OPTION_VERIFY },
+	{ "repair", no_argument, NULL, OPTION_REPAIR },
+	{ "bwlimit", required_argument, NULL, OPTION_BWLIMIT },
+	{ "framed", no_argument, NULL, OPTION_FRAMED },
+	{ "offset", required_argument, NULL, OPTION_OFFSET },
+	{ "length", required_argument, NULL, OPTION_LENGTH },
+	{ "error-map", required_argument, NULL, OPTION_ERROR_MAP },
+	{ NULL, 0, NULL, 0 },
+};
 
 static FILE *input_file = NULL;
 static FILE *output_file = NULL;
-static BitMatrix *ht_matrix = NULL;
+static HammingCode *hamming_code = NULL;
+static bool framed = false; // Whether the input is a container with a file header and chunk headers instead of raw codes.
+static char *error_map_file_name = NULL; // File to write the ranges of bytes with uncorrectable errors to, if any.
 
 // Description:
 // Prints the help message to stderr.
@@ -24,8 +48,17 @@ static BitMatrix *ht_matrix = NULL;
 // Nothing.
 static void print_help( char *program_path ) {
 	fprintf( stderr,
-	    "SYNOPSIS\n   A Hamming(8, 4) code decoder using matrix multiplication with memoization.\n\nUSAGE\n   %s [-hv] [-i infile] [-o outfile]\n\nOPTIONS\n   -h             Program usage and "
-	    "help.\n   -v             Print decoding statistics to stderr.\n   -i infile      Input file to decode.\n   -o outfile     File to output decoded data to.\n",
+	    "SYNOPSIS\n   An extended Hamming code decoder using matrix multiplication with precomputed tables.\n\nUSAGE\n   %s [-hv] [-c n,k] [-b size] [-j threads] [-m] [-p] [-u] [--framed] [--verify "
+	    "| --repair] [--bwlimit rate] [--offset n] [--length n] [--error-map f] [-i infile] [-o outfile]\n\nOPTIONS\n   -h             Program usage and help.\n   -v             Print decoding "
+	    "statistics to stderr.\n   -c n,k         Extended Hamming(n, k) code the input was encoded with, such as 8,4, 16,11, 72,64, or 128,120 (default 8,4).\n   -b size        Input buffer size in "
+	    "bytes, optionally suffixed with K, M, or G (default 1M).\n   -j threads     Number of threads to decode with (default 1).\n   -m             Memory-map the input and output files when both "
+	    "are regular files.\n   -p             Splice the output into the output pipe instead of copying it, when it is a pipe whose reader copies the data out.\n   -u             Overlap reading "
+	    "and writing with processing using io_uring, if the kernel supports it.\n   --framed       Decode a container written with --framed, using the code in its header instead of -c.\n   "
+	    "--verify       Only check the input and print decoding statistics to stderr, without decoding it or writing output.\n   --repair       Like --verify, but also rewrite the codes with "
+	    "correctable errors in the infile, only writing the pieces of it that have one.\n   --bwlimit rate Most bytes to read per second with --verify or --repair, optionally suffixed with K, M, or "
+	    "G (default no limit).\n   --offset n     Offset in the decoded data to start decoding at, optionally suffixed with K, M, or G. Only the codes of the range are read, so the infile must be "
+	    "seekable.\n   --length n     Number of decoded bytes to output from the offset (default to the end).\n   --error-map f  File f to write the offset and length of each range of decoded bytes "
+	    "with uncorrectable errors to, one range per line. Decodes on one thread.\n   -i infile      Input file to decode.\n   -o outfile     File to output decoded data to.\n",
 	    program_path );
 }
 
@@ -38,8 +71,10 @@ static void print_help( char *program_path ) {
 // Returns:
 // Nothing.
 static void cleanup_memory( ) {
-	if ( ht_matrix ) {
-		bm_delete( &ht_matrix );
+	error_map_close( );
+
+	if ( hamming_code ) {
+		ham_code_delete( &hamming_code );
 	}
 
 	if ( output_file ) {
@@ -53,23 +88,37 @@ static void cleanup_memory( ) {
 	}
 }
 
+// Description:
+// Checks whether the selected code is Hamming(8, 4), which has its own table-driven path.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// bool - Whether the selected code is Hamming(8, 4).
+static bool is_hamming_8_4( ) {
+	return ham_code_length( hamming_code ) == 8 && ham_code_message_length( hamming_code ) == 4;
+}
+
 // Description:
 // Processes the file names inputted by the user.
 //
 // Parameters:
 // char *input_file_name - The input file name given by the user.
 // char *output_file_name - The output file name given by the user.
+// bool memory_map - Whether the output file will be memory-mapped, which needs it opened for reading as well.
+// bool repair - Whether the input file will be repaired in place, which needs it opened for writing as well.
 //
 // Returns:
 // bool - Whether processing was successful.
-static bool process_input_output_files( char *input_file_name, char *output_file_name ) {
-	if ( input_file_name && !( input_file = fopen( input_file_name, "rb" ) ) ) {
+static bool process_input_output_files( char *input_file_name, char *output_file_name, bool memory_map, bool repair ) {
+	if ( input_file_name && !( input_file = fopen( input_file_name, repair ? "r+b" : "rb" ) ) ) {
 		fprintf( stderr, "Error: failed to open infile.\n" );
 
 		return false;
 	}
 
-	if ( output_file_name && !( output_file = fopen( output_file_name, "wb" ) ) ) {
+	if ( output_file_name && !( output_file = fopen( output_file_name, memory_map ? "w+b" : "wb" ) ) ) {
 		fprintf( stderr, "Error: failed to open outfile.\n" );
 		cleanup_memory( );
 
@@ -86,30 +135,7 @@ static bool process_input_output_files( char *input_file_name, char *output_file
 }
 
 // Description:
-// Initializes the transpose of the parity-checker matrix used to decode Hamming codes.
-//
-// Parameters:
-// Nothing.
-//
-// Returns:
-// Nothing.
-static void initialize_h_transpose_matrix( ) {
-	static const uint8_t h_transpose_matrix_array[ 8 ][ 4 ] = { { 0, 1, 1, 1 }, { 1, 0, 1, 1 }, { 1, 1, 0, 1 }, { 1, 1, 1, 0 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
-	BitMatrix *m = bm_create( 8, 4 );
-
-	for ( uint8_t row = 0; row < 8; row++ ) {
-		for ( uint8_t col = 0; col < 4; col++ ) {
-			if ( h_transpose_matrix_array[ row ][ col ] ) {
-				bm_set_bit( m, row, col );
-			}
-		}
-	}
-
-	ht_matrix = m;
-}
-
-// Description:
-// Decodes input file two characters at a time and outputs the decoded data to the output file.
+// Decodes input file two characters at a time and outputs the decoded data to the output file. Only used for small inputs.
 //
 // Parameters:
 // uint64_t *total_bytes_processed - A pointer to the counter for total number of bytes processed.
@@ -118,7 +144,7 @@ static void initialize_h_transpose_matrix( ) {
 //
 // Returns:
 // bool - Whether the data could be read, decoded, and written to the output file.
-static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t *uncorrectable_errors, uint64_t *corrected_errors ) {
+static bool decode_and_write_to_file_bytewise( uint64_t *total_bytes_processed, uint64_t *uncorrectable_errors, uint64_t *corrected_errors ) {
 	uint8_t lower_nibble = 0;
 	uint8_t upper_nibble = 0;
 	uint32_t last_scan = 1;
@@ -144,7 +170,7 @@ static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t
 			uint8_t first_byte = first_input_get_result;
 			uint8_t second_byte = second_input_get_result;
 			// Decode lower nibble.
-			HAM_STATUS lower_nibble_status = ham_decode( ht_matrix, first_byte, &lower_nibble );
+			HAM_STATUS lower_nibble_status = ham_code_lookup_decode( hamming_code, first_byte, &lower_nibble );
 
 			if ( lower_nibble_status == HAM_ERR ) {
 				*uncorrectable_errors += 1;
@@ -153,7 +179,7 @@ static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t
 			}
 
 			// Decode upper nibble.
-			HAM_STATUS upper_nibble_status = ham_decode( ht_matrix, second_byte, &upper_nibble );
+			HAM_STATUS upper_nibble_status = ham_code_lookup_decode( hamming_code, second_byte, &upper_nibble );
 
 			if ( upper_nibble_status == HAM_ERR ) {
 				*uncorrectable_errors += 1;
@@ -165,6 +191,7 @@ static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t
 			if ( lower_nibble_status == HAM_ERR || upper_nibble_status == HAM_ERR ) {
 				lower_nibble = 0;
 				upper_nibble = 0;
+				error_map_add( *total_bytes_processed / 2 - 1, 1 );
 			}
 
 			uint8_t reconstructed_byte = ( upper_nibble << 4 ) | lower_nibble;
@@ -182,6 +209,252 @@ static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t
 	return true;
 }
 
+// Description:
+// Decodes a block of code byte pairs, each pair holding the lower nibble's code followed by the upper nibble's code.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode.
+// uint8_t *out - Where to put the decoded bytes. Must hold units bytes.
+// size_t units - The number of code byte pairs to decode.
+// CodecStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void decode_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	ham_code_decode_bytes( hamming_code, in, out, units, &stats->corrected_errors, &stats->uncorrectable_errors );
+}
+
+// Description:
+// Decodes a block of codes with the selected code.
+//
+// Parameters:
+// const uint8_t *in - The codes to decode.
+// uint8_t *out - Where to put the decoded bytes. Must hold units data units.
+// size_t units - The number of code units to decode.
+// CodecStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void decode_units_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	size_t scratch_size = ham_code_scratch_size( hamming_code );
+	uint8_t *scratch_memory = malloc( scratch_size );
+	uint8_t fallback_memory[ HAM_CODE_SCRATCH_SIZE ];
+	Arena scratch;
+
+	// Without memory for a batch, the codes are decoded one at a time instead.
+	if ( scratch_memory ) {
+		arena_init( &scratch, scratch_memory, scratch_size );
+	} else {
+		arena_init( &scratch, fallback_memory, sizeof( fallback_memory ) );
+	}
+
+	ham_code_decode_units( hamming_code, &scratch, in, out, units, &stats->corrected_errors, &stats->uncorrectable_errors );
+	free( scratch_memory );
+}
+
+// Description:
+// Reads the file header of a container and switches to the code it gives, instead of the one given on the command line.
+//
+// Parameters:
+// FrameHeader *header - Where to put the header's fields.
+//
+// Returns:
+// bool - Whether a valid header with a supported code could be read.
+static bool read_frame_header( FrameHeader *header ) {
+	if ( !frame_io_read_header( input_file, header ) ) {
+		return false;
+	}
+
+	HammingCode *code = ham_code_create( header->code_length, header->message_length );
+
+	if ( !code ) {
+		fprintf( stderr, "Error: unsupported code in container or failed to allocate memory.\n" );
+
+		return false;
+	}
+
+	ham_code_delete( &hamming_code );
+	hamming_code = code;
+
+	return true;
+}
+
+// Description:
+// Decodes the input file in large blocks and outputs the decoded data to the output file. When only a range of the data
+// is asked for, only the codes of that range are read, at their offset.
+//
+// Parameters:
+// const IoOptions *options - The I/O options given on the command line.
+// uint64_t offset - The offset in the decoded data to start at, or 0 for the whole file.
+// uint64_t length - The number of decoded bytes to output, or RANGE_IO_TO_END for the whole file.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, decoded, and written to the output file.
+static bool decode_and_write_to_file( const IoOptions *options, uint64_t offset, uint64_t length, CodecStats *stats ) {
+	static const BlockCodec nibble_codec = { 2, 1, false, decode_block };
+	bool range = offset != 0 || length != RANGE_IO_TO_END;
+	FrameHeader header;
+
+	if ( framed && !read_frame_header( &header ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	BlockCodec codec = { ham_code_code_unit( hamming_code ), ham_code_data_unit( hamming_code ), false, decode_units_block };
+
+	if ( is_hamming_8_4( ) ) {
+		codec = nibble_codec;
+	}
+
+	if ( error_map_file_name && !error_map_open( error_map_file_name, &codec, offset - offset % codec.out_unit, &codec ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	if ( framed ) {
+		bool success = range ? frame_io_decode_range( input_file, output_file, &codec, &header, offset, length, stats ) : frame_io_decode( input_file, output_file, &codec, &header, options->threads, stats );
+
+		if ( !success ) {
+			cleanup_memory( );
+
+			return false;
+		}
+
+		return true;
+	}
+
+	if ( is_hamming_8_4( ) && !range && block_io_is_small_input( input_file ) ) {
+		return decode_and_write_to_file_bytewise( &stats->total_bytes_processed, &stats->uncorrectable_errors, &stats->corrected_errors );
+	}
+
+	if ( range ? !range_io_process( input_file, output_file, &codec, offset, length, options->buffer_size, stats ) : !io_engine_process( input_file, output_file, &codec, options, stats ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	return true;
+}
+
+// Description:
+// Checks a block of code byte pairs without decoding them.
+//
+// Parameters:
+// const uint8_t *in - The codes to check.
+// uint8_t *out - Unused, since nothing is decoded.
+// size_t units - The number of code byte pairs to check.
+// CodecStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void verify_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	( void ) out;
+	ham_code_verify_bytes( hamming_code, in, 2 * units, &stats->corrected_errors, &stats->uncorrectable_errors );
+}
+
+// Description:
+// Checks a block of codes with the selected code without decoding them.
+//
+// Parameters:
+// const uint8_t *in - The codes to check.
+// uint8_t *out - Unused, since nothing is decoded.
+// size_t units - The number of code units to check.
+// CodecStats *stats - The statistics to add the corrected and uncorrectable errors to.
+//
+// Returns:
+// Nothing.
+static void verify_units_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	size_t scratch_size = ham_code_scratch_size( hamming_code );
+	uint8_t *scratch_memory = malloc( scratch_size );
+	uint8_t fallback_memory[ HAM_CODE_SCRATCH_SIZE ];
+	Arena scratch;
+	( void ) out;
+
+	// Without memory for a batch, the codes are checked one at a time instead.
+	if ( scratch_memory ) {
+		arena_init( &scratch, scratch_memory, scratch_size );
+	} else {
+		arena_init( &scratch, fallback_memory, sizeof( fallback_memory ) );
+	}
+
+	ham_code_verify_units( hamming_code, &scratch, in, units, &stats->corrected_errors, &stats->uncorrectable_errors );
+	free( scratch_memory );
+}
+
+// Description:
+// Repairs the code byte pairs with correctable errors in place.
+//
+// Parameters:
+// uint8_t *codes - The codes to repair.
+// size_t units - The number of code byte pairs.
+//
+// Returns:
+// size_t - The number of codes that were rewritten.
+static size_t repair_block( uint8_t *codes, size_t units ) {
+	return ham_code_repair_bytes( hamming_code, codes, 2 * units );
+}
+
+// Description:
+// Repairs the codes of the selected code with correctable errors in place.
+//
+// Parameters:
+// uint8_t *codes - The codes to repair.
+// size_t units - The number of code units.
+//
+// Returns:
+// size_t - The number of codes that were repaired.
+static size_t repair_units_block( uint8_t *codes, size_t units ) {
+	size_t scratch_size = ham_code_scratch_size( hamming_code );
+	uint8_t *scratch_memory = malloc( scratch_size );
+	uint8_t fallback_memory[ HAM_CODE_SCRATCH_SIZE ];
+	Arena scratch;
+
+	// Without memory for a batch, the codes are repaired one at a time instead.
+	if ( scratch_memory ) {
+		arena_init( &scratch, scratch_memory, scratch_size );
+	} else {
+		arena_init( &scratch, fallback_memory, sizeof( fallback_memory ) );
+	}
+
+	size_t repaired = ham_code_repair_units( hamming_code, &scratch, codes, units );
+	free( scratch_memory );
+
+	return repaired;
+}
+
+// Description:
+// Checks the input file in large blocks without decoding it, only counting the errors, and optionally repairs it in place.
+//
+// Parameters:
+// const IoOptions *options - The I/O options given on the command line.
+// bool repair - Whether to rewrite the codes with correctable errors in the input file.
+// size_t max_rate - The most bytes to read per second, or 0 for no limit.
+// CodecStats *stats - The statistics to add to.
+//
+// Returns:
+// bool - Whether the data could be read, and repaired if asked to.
+static bool verify_file( const IoOptions *options, bool repair, size_t max_rate, CodecStats *stats ) {
+	static const BlockCodec nibble_codec = { 2, 0, false, verify_block };
+	BlockCodec codec = { ham_code_code_unit( hamming_code ), 0, false, verify_units_block };
+	RepairFunction repair_function = repair_units_block;
+
+	if ( is_hamming_8_4( ) ) {
+		codec = nibble_codec;
+		repair_function = repair_block;
+	}
+
+	if ( !verify_io_process( input_file, &codec, repair ? repair_function : NULL, options->buffer_size, max_rate, stats ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	return true;
+}
+
 // Description:
 // The entry point of the program.
 //
@@ -194,44 +467,163 @@ static bool decode_and_write_to_file( uint64_t *total_bytes_processed, uint64_t
 int main( int argc, char **argv ) {
 	int opt = 0;
 	bool verbose = false;
+	bool verify = false;
+	bool repair = false;
+	size_t max_rate = 0;
+	uint64_t offset = 0;
+	uint64_t length = RANGE_IO_TO_END;
 	char *input_file_name = NULL;
 	char *output_file_name = NULL;
+	uint32_t code_length = 8;
+	uint32_t message_length = 4;
+	IoOptions options;
+	io_engine_default_options( &options );
 
-	while ( ( opt = getopt( argc, argv, OPTIONS ) ) != -1 ) { // Process each option specified.
+	while ( ( opt = getopt_long( argc, argv, OPTIONS, long_options, NULL ) ) != -1 ) { // Process each option specified.
 		switch ( opt ) {
 		case 'h': print_help( *argv ); return 0; // Help.
 		case 'v': verbose = true; break; // Verbose.
+		case 'c': // Code.
+			if ( !ham_code_parse( optarg, &code_length, &message_length ) ) {
+				fprintf( stderr, "Error: invalid code.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'b': // Buffer size.
+			if ( !block_io_parse_size( optarg, &options.buffer_size ) ) {
+				fprintf( stderr, "Error: invalid buffer size.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'j': // Thread count.
+			if ( !parallel_io_parse_threads( optarg, &options.threads ) ) {
+				fprintf( stderr, "Error: invalid thread count.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'm': options.memory_map = true; break; // Memory-map files.
+		case 'p': options.splice = true; break; // Splice into the output pipe.
+		case 'u': options.io_uring = true; break; // Use io_uring.
 		case 'i': input_file_name = optarg; break; // Input file.
 		case 'o': output_file_name = optarg; break; // Output file.
+		case OPTION_VERIFY: verify = true; break; // Only check the input.
+		case OPTION_REPAIR: verify = repair = true; break; // Check the input and repair it in place.
+		case OPTION_FRAMED: framed = true; break; // Read a container.
+		case OPTION_OFFSET: // Start of the range to decode.
+			if ( !block_io_parse_offset( optarg, &offset ) ) {
+				fprintf( stderr, "Error: invalid offset.\n" );
+
+				return 1;
+			}
+
+			break;
+		case OPTION_LENGTH: // Length of the range to decode.
+			if ( !block_io_parse_offset( optarg, &length ) ) {
+				fprintf( stderr, "Error: invalid length.\n" );
+
+				return 1;
+			}
+
+			break;
+		case OPTION_ERROR_MAP: error_map_file_name = optarg; break; // Error map file.
+		case OPTION_BWLIMIT: // Read rate limit.
+			if ( !block_io_parse_size( optarg, &max_rate ) ) {
+				fprintf( stderr, "Error: invalid bandwidth limit.\n" );
+
+				return 1;
+			}
+
+			break;
 		default: print_help( *argv ); return 1; // Invalid flag.
 		}
 	}
 
+	if ( verify && output_file_name ) {
+		fprintf( stderr, "Error: --verify and --repair don't write an outfile.\n" );
+
+		return 1;
+	}
+
+	if ( verify && ( offset != 0 || length != RANGE_IO_TO_END ) ) {
+		fprintf( stderr, "Error: --offset and --length only apply to decoding.\n" );
+
+		return 1;
+	}
+
+	if ( ( offset != 0 || length != RANGE_IO_TO_END ) && ( options.threads > 1 || options.memory_map || options.splice || options.io_uring ) ) {
+		fprintf( stderr, "Error: -j, -m, -p, and -u don't apply to --offset and --length.\n" );
+
+		return 1;
+	}
+
+	if ( verify && error_map_file_name ) {
+		fprintf( stderr, "Error: --error-map only applies to decoding.\n" );
+
+		return 1;
+	}
+
+	if ( verify && framed ) {
+		fprintf( stderr, "Error: --verify and --repair don't read containers.\n" );
+
+		return 1;
+	}
+
+	if ( !verify && max_rate != 0 ) {
+		fprintf( stderr, "Error: --bwlimit only applies to --verify and --repair.\n" );
+
+		return 1;
+	}
+
+	if ( error_map_file_name ) {
+		options.threads = 1; // The error map needs the blocks decoded in order.
+	}
+
+	if ( repair && !input_file_name ) {
+		fprintf( stderr, "Error: --repair needs an infile.\n" );
+
+		return 1;
+	}
+
+	if ( !( hamming_code = ham_code_create( code_length, message_length ) ) ) {
+		fprintf( stderr, "Error: unsupported code or failed to allocate memory.\n" );
+
+		return 1;
+	}
+
 	input_file = stdin;
 	output_file = stdout;
 
-	if ( !process_input_output_files( input_file_name, output_file_name ) ) {
+	if ( !process_input_output_files( input_file_name, output_file_name, options.memory_map, repair ) ) {
+		return 1;
+	}
+
+	CodecStats stats = { 0, 0, 0, 0 };
+
+	if ( verify ? !verify_file( &options, repair, max_rate, &stats ) : !decode_and_write_to_file( &options, offset, length, &stats ) ) {
 		return 1;
 	}
 
-	initialize_h_transpose_matrix( );
-	uint64_t total_bytes_processed = 0;
-	uint64_t uncorrectable_errors = 0;
-	uint64_t corrected_errors = 0;
+	if ( !error_map_close( ) ) {
+		cleanup_memory( );
 
-	if ( !decode_and_write_to_file( &total_bytes_processed, &uncorrectable_errors, &corrected_errors ) ) {
 		return 1;
 	}
 
-	if ( verbose ) {
-		double error_rate = ( double ) uncorrectable_errors / total_bytes_processed;
-		fprintf( stderr, "Total bytes processed: %" PRIu64 "\n", total_bytes_processed );
-		fprintf( stderr, "Uncorrectable errors: %" PRIu64 "\n", uncorrectable_errors );
-		fprintf( stderr, "Corrected errors: %" PRIu64 "\n", corrected_errors );
+	if ( verbose || verify ) {
+		double error_rate = ( double ) stats.uncorrectable_errors / stats.total_bytes_processed;
+		fprintf( stderr, "Total bytes processed: %" PRIu64 "\n", stats.total_bytes_processed );
+		fprintf( stderr, "Uncorrectable errors: %" PRIu64 "\n", stats.uncorrectable_errors );
+		fprintf( stderr, "Corrected errors: %" PRIu64 "\n", stats.corrected_errors );
 		fprintf( stderr, "Error rate: %f\n", error_rate );
 	}
 
 	cleanup_memory( );
 
-	return 0;
+	return stats.checksum_failures > 0 ? 1 : 0; // The data was written, but some of it didn't match its checksum.
 }
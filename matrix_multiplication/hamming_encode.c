@@ -1,5 +1,9 @@
+#include "block_io.h"
 #include "bm.h"
+#include "frame_io.h"
 #include "hamming.h"
+#include "io_engine.h"
+#include "parallel_io.h"
 
 #include <getopt.h>
 #include <stdbool.h>
@@ -8,11 +12,23 @@
 #include <stdlib.h>
 #include <sys/stat.h>
 
-#define OPTIONS "hi:o:" // Valid options for the program.
+#define OPTIONS "hc:b:j:mpui:o:" // Valid options for the program.
+
+// Values getopt_long returns for the options with only a long name.
+enum { OPTION_FRAMED = 256, OPTION_CRC32C };
+
+// Long names of the options.
+static const struct option long_options[] = {
+	{ "framed", no_argument, NULL, OPTION_FRAMED },
+	{ "crc32c", no_argument, NULL, OPTION_CRC32C },
+	{ NULL, 0, NULL, 0 },
+};
 
 static FILE *input_file = NULL;
 static FILE *output_file = NULL;
-static BitMatrix *generator_matrix = NULL;
+static HammingCode *hamming_code = NULL;
+static bool framed = false; // Whether to write a container with a file header and chunk headers instead of raw codes.
+static bool checksum = false; // Whether to follow each chunk of the container with the CRC-32C of its data.
 
 // Description:
 // Prints the help message to stderr.
@@ -24,8 +40,13 @@ static BitMatrix *generator_matrix = NULL;
 // Nothing.
 static void print_help( char *program_path ) {
 	fprintf( stderr,
-	    "SYNOPSIS\n   A Hamming(8, 4) code generator using matrix multiplication with memoization.\n\nUSAGE\n   %s [-h] [-i infile] [-o outfile]\n\nOPTIONS\n   -h             Program usage and "
-	    "help.\n   -i infile      Input file to encode.\n   -o outfile     File to output encoded data to.\n",
+	    "SYNOPSIS\n   An extended Hamming code generator using matrix multiplication with precomputed tables.\n\nUSAGE\n   %s [-h] [-c n,k] [-b size] [-j threads] [-m] [-p] [-u] [--framed] "
+	    "[--crc32c] [-i infile] [-o outfile]\n\nOPTIONS\n   -h             Program usage and help.\n   -c n,k         Extended Hamming(n, k) code to use, such as 8,4, 16,11, 72,64, or 128,120 "
+	    "(default 8,4).\n   -b size        Input buffer size in bytes, optionally suffixed with K, M, or G (default 1M).\n   -j threads     Number of threads to encode with (default 1).\n   "
+	    "-m             Memory-map the input and output files when both are regular files.\n   -p             Splice the output into the output pipe instead of copying it, when it is a pipe whose "
+	    "reader copies the data out.\n   -u             Overlap reading and writing with processing using io_uring, if the kernel supports it.\n   --framed       Write a container with the code, the "
+	    "input length, and a header in front of each chunk of the buffer size, instead of raw codes.\n   --crc32c       Like --framed, but also follow each chunk with the CRC-32C of its data, which "
+	    "the decoder checks.\n   -i infile      Input file to encode.\n   -o outfile     File to output encoded data to.\n",
 	    program_path );
 }
 
@@ -38,8 +59,8 @@ static void print_help( char *program_path ) {
 // Returns:
 // Nothing.
 static void cleanup_memory( ) {
-	if ( generator_matrix ) {
-		bm_delete( &generator_matrix );
+	if ( hamming_code ) {
+		ham_code_delete( &hamming_code );
 	}
 
 	if ( output_file ) {
@@ -53,23 +74,36 @@ static void cleanup_memory( ) {
 	}
 }
 
+// Description:
+// Checks whether the selected code is Hamming(8, 4), which has its own table-driven path.
+//
+// Parameters:
+// Nothing.
+//
+// Returns:
+// bool - Whether the selected code is Hamming(8, 4).
+static bool is_hamming_8_4( ) {
+	return ham_code_length( hamming_code ) == 8 && ham_code_message_length( hamming_code ) == 4;
+}
+
 // Description:
 // Processes the file names inputted by the user.
 //
 // Parameters:
 // char *input_file_name - The input file name given by the user.
 // char *output_file_name - The output file name given by the user.
+// bool memory_map - Whether the output file will be memory-mapped, which needs it opened for reading as well.
 //
 // Returns:
 // bool - Whether processing was successful.
-static bool process_input_output_files( char *input_file_name, char *output_file_name ) {
+static bool process_input_output_files( char *input_file_name, char *output_file_name, bool memory_map ) {
 	if ( input_file_name && !( input_file = fopen( input_file_name, "rb" ) ) ) {
 		fprintf( stderr, "Error: failed to open infile.\n" );
 
 		return false;
 	}
 
-	if ( output_file_name && !( output_file = fopen( output_file_name, "wb" ) ) ) {
+	if ( output_file_name && !( output_file = fopen( output_file_name, memory_map ? "w+b" : "wb" ) ) ) {
 		fprintf( stderr, "Error: failed to open outfile.\n" );
 		cleanup_memory( );
 
@@ -86,37 +120,14 @@ static bool process_input_output_files( char *input_file_name, char *output_file
 }
 
 // Description:
-// Initializes the generator matrix used for generating Hamming codes.
-//
-// Parameters:
-// Nothing.
-//
-// Returns:
-// Nothing.
-static void initialize_generator_matrix( ) {
-	static const uint8_t generator_matrix_array[ 4 ][ 8 ] = { { 1, 0, 0, 0, 0, 1, 1, 1 }, { 0, 1, 0, 0, 1, 0, 1, 1 }, { 0, 0, 1, 0, 1, 1, 0, 1 }, { 0, 0, 0, 1, 1, 1, 1, 0 } };
-	BitMatrix *m = bm_create( 4, 8 );
-
-	for ( uint8_t row = 0; row < 4; row++ ) {
-		for ( uint8_t col = 0; col < 8; col++ ) {
-			if ( generator_matrix_array[ row ][ col ] ) {
-				bm_set_bit( m, row, col );
-			}
-		}
-	}
-
-	generator_matrix = m;
-}
-
-// Description:
-// Encodes input file character-by-character and outputs the code to the output file.
+// Encodes input file character-by-character and outputs the code to the output file. Only used for small inputs.
 //
 // Parameters:
 // Nothing.
 //
 // Returns:
 // bool - Whether the data could be read, encoded, and written to the output file.
-static bool encode_and_write_to_file( ) {
+static bool encode_and_write_to_file_bytewise( ) {
 	uint32_t last_scan = 1;
 
 	while ( last_scan == 1 ) {
@@ -132,8 +143,8 @@ static bool encode_and_write_to_file( ) {
 		if ( input_get_result != EOF ) {
 			uint8_t byte = input_get_result;
 			// Encode lower and upper nibble, then output the encoded result.
-			int lower_nibble_result = fputc( ham_encode( generator_matrix, byte & 0xF ), output_file );
-			int upper_nibble_result = fputc( ham_encode( generator_matrix, byte >> 4 ), output_file );
+			int lower_nibble_result = fputc( ham_code_lookup_encode( hamming_code, byte & 0xF ), output_file );
+			int upper_nibble_result = fputc( ham_code_lookup_encode( hamming_code, byte >> 4 ), output_file );
 
 			if ( lower_nibble_result == EOF || upper_nibble_result == EOF ) {
 				fprintf( stderr, "Error: failed to write to output file.\n" );
@@ -149,6 +160,94 @@ static bool encode_and_write_to_file( ) {
 	return true;
 }
 
+// Description:
+// Encodes a block of bytes, outputting the lower nibble's code followed by the upper nibble's code for each byte.
+//
+// Parameters:
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes. Must hold 2 * units bytes.
+// size_t units - The number of bytes to encode.
+// CodecStats *stats - Unused.
+//
+// Returns:
+// Nothing.
+static void encode_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	( void ) stats;
+	ham_code_encode_bytes( hamming_code, in, out, units );
+}
+
+// Description:
+// Encodes a block of bytes with the selected code.
+//
+// Parameters:
+// const uint8_t *in - The bytes to encode.
+// uint8_t *out - Where to put the codes. Must hold units code units.
+// size_t units - The number of data units to encode.
+// CodecStats *stats - Unused.
+//
+// Returns:
+// Nothing.
+static void encode_units_block( const uint8_t *in, uint8_t *out, size_t units, CodecStats *stats ) {
+	( void ) stats;
+	size_t scratch_size = ham_code_scratch_size( hamming_code );
+	uint8_t *scratch_memory = malloc( scratch_size );
+	uint8_t fallback_memory[ HAM_CODE_SCRATCH_SIZE ];
+	Arena scratch;
+
+	// Without memory for a batch, the codes are encoded one at a time instead.
+	if ( scratch_memory ) {
+		arena_init( &scratch, scratch_memory, scratch_size );
+	} else {
+		arena_init( &scratch, fallback_memory, sizeof( fallback_memory ) );
+	}
+
+	ham_code_encode_units( hamming_code, &scratch, in, out, units );
+	free( scratch_memory );
+}
+
+// Description:
+// Encodes the input file in large blocks and outputs the code to the output file.
+//
+// Parameters:
+// const IoOptions *options - The I/O options given on the command line.
+//
+// Returns:
+// bool - Whether the data could be read, encoded, and written to the output file.
+static bool encode_and_write_to_file( const IoOptions *options ) {
+	static const BlockCodec nibble_codec = { 1, 2, false, encode_block };
+	// Codes other than Hamming(8, 4) pad the last unit with zeros.
+	BlockCodec codec = { ham_code_data_unit( hamming_code ), ham_code_code_unit( hamming_code ), true, encode_units_block };
+	CodecStats stats = { 0, 0, 0, 0 };
+
+	if ( is_hamming_8_4( ) ) {
+		if ( !framed && block_io_is_small_input( input_file ) ) {
+			return encode_and_write_to_file_bytewise( );
+		}
+
+		codec = nibble_codec;
+	}
+
+	if ( framed ) {
+		FrameHeader header = { ham_code_length( hamming_code ), ham_code_message_length( hamming_code ), frame_io_chunk_size( options->buffer_size, codec.in_unit ), checksum ? FRAME_IO_FLAG_CRC32C : 0, 0 };
+
+		if ( !frame_io_encode( input_file, output_file, &codec, &header, options->threads, &stats ) ) {
+			cleanup_memory( );
+
+			return false;
+		}
+
+		return true;
+	}
+
+	if ( !io_engine_process( input_file, output_file, &codec, options, &stats ) ) {
+		cleanup_memory( );
+
+		return false;
+	}
+
+	return true;
+}
+
 // Description:
 // The entry point of the program.
 //
@@ -162,26 +261,63 @@ int main( int argc, char **argv ) {
 	int opt = 0;
 	char *input_file_name = NULL;
 	char *output_file_name = NULL;
+	uint32_t code_length = 8;
+	uint32_t message_length = 4;
+	IoOptions options;
+	io_engine_default_options( &options );
 
-	while ( ( opt = getopt( argc, argv, OPTIONS ) ) != -1 ) { // Process each option specified.
+	while ( ( opt = getopt_long( argc, argv, OPTIONS, long_options, NULL ) ) != -1 ) { // Process each option specified.
 		switch ( opt ) {
 		case 'h': print_help( *argv ); return 0; // Help.
+		case 'c': // Code.
+			if ( !ham_code_parse( optarg, &code_length, &message_length ) ) {
+				fprintf( stderr, "Error: invalid code.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'b': // Buffer size.
+			if ( !block_io_parse_size( optarg, &options.buffer_size ) ) {
+				fprintf( stderr, "Error: invalid buffer size.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'j': // Thread count.
+			if ( !parallel_io_parse_threads( optarg, &options.threads ) ) {
+				fprintf( stderr, "Error: invalid thread count.\n" );
+
+				return 1;
+			}
+
+			break;
+		case 'm': options.memory_map = true; break; // Memory-map files.
+		case 'p': options.splice = true; break; // Splice into the output pipe.
+		case 'u': options.io_uring = true; break; // Use io_uring.
 		case 'i': input_file_name = optarg; break; // Input file.
 		case 'o': output_file_name = optarg; break; // Output file.
+		case OPTION_FRAMED: framed = true; break; // Write a container.
+		case OPTION_CRC32C: framed = checksum = true; break; // Write a container with checksums.
 		default: print_help( *argv ); return 1; // Invalid flag.
 		}
 	}
 
+	if ( !( hamming_code = ham_code_create( code_length, message_length ) ) ) {
+		fprintf( stderr, "Error: unsupported code or failed to allocate memory.\n" );
+
+		return 1;
+	}
+
 	input_file = stdin;
 	output_file = stdout;
 
-	if ( !process_input_output_files( input_file_name, output_file_name ) ) {
+	if ( !process_input_output_files( input_file_name, output_file_name, options.memory_map ) ) {
 		return 1;
 	}
 
-	initialize_generator_matrix( );
-
-	if ( !encode_and_write_to_file( ) ) {
+	if ( !encode_and_write_to_file( &options ) ) {
 		return 1;
 	}
 
@@ -0,0 +1,247 @@
+#include "bm.h"
+#include "hamming.h"
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define OPTIONS "h" // Valid options for the program.
+
+typedef enum TABLE_FORMAT {
+	TABLE_DECIMAL, // Plain numbers.
+	TABLE_MASK, // 0 or a hexadecimal mask.
+	TABLE_STATUS, // HAM_STATUS values by name, other values as plain numbers.
+} TABLE_FORMAT;
+
+// Description:
+// Prints the help message to stderr.
+//
+// Parameters:
+// char *program_path - The path to the program.
+//
+// Returns:
+// Nothing.
+static void print_help( char *program_path ) {
+	fprintf( stderr,
+	    "SYNOPSIS\n   Generates the tables used by the lookup table encoder and decoder from the generator and parity-checker matrices, printing them as C to stdout.\n\nUSAGE\n   %s [-h]\n\nOPTIONS\n "
+	    "  -h             Program usage and help.\n",
+	    program_path );
+}
+
+// Description:
+// Gets the syndrome of a single flipped bit, which is that bit's row of the transpose of the parity-checker matrix.
+//
+// Parameters:
+// BitMatrix *ht - The transpose of the parity-checker matrix.
+// uint32_t bit - The position of the flipped bit.
+// uint32_t check_bits - The number of check bits.
+//
+// Returns:
+// uint32_t - The syndrome.
+static uint32_t bit_syndrome( BitMatrix *ht, uint32_t bit, uint32_t check_bits ) {
+	uint32_t syndrome = 0;
+
+	for ( uint32_t col = 0; col < check_bits; col++ ) {
+		syndrome |= ( uint32_t ) bm_get_bit( ht, bit, col ) << col;
+	}
+
+	return syndrome;
+}
+
+// Description:
+// Gets the name of a HAM_STATUS, or the number itself if it isn't one.
+//
+// Parameters:
+// int32_t value - The value.
+// char *buffer - Where to put the number. Must hold 12 bytes.
+//
+// Returns:
+// const char * - The name or number.
+static const char *status_name( int32_t value, char *buffer ) {
+	switch ( value ) {
+	case HAM_OK: return "HAM_OK";
+	case HAM_ERR: return "HAM_ERR";
+	case HAM_CORRECT: return "HAM_CORRECT";
+	default: snprintf( buffer, 12, "%" PRId32, value ); return buffer;
+	}
+}
+
+// Description:
+// Prints a table as a C array definition.
+//
+// Parameters:
+// const char *declaration - The declaration of the array, such as "static const uint8_t encode_lookup[ 16 ]".
+// const int32_t *values - The values of the array.
+// uint32_t length - The number of values.
+// TABLE_FORMAT format - How to print the values.
+//
+// Returns:
+// Nothing.
+static void print_table( const char *declaration, const int32_t *values, uint32_t length, TABLE_FORMAT format ) {
+	char buffer[ 12 ];
+	printf( "%s = { ", declaration );
+
+	for ( uint32_t i = 0; i < length; i++ ) {
+		switch ( format ) {
+		case TABLE_MASK: printf( values[ i ] ? "0x%02" PRIX32 : "%" PRId32, values[ i ] ); break;
+		case TABLE_STATUS: printf( "%s", status_name( values[ i ], buffer ) ); break;
+		default: printf( "%" PRId32, values[ i ] ); break;
+		}
+
+		printf( "%s", i + 1 < length ? ", " : " };\n\n" );
+	}
+}
+
+// Description:
+// Prints a table of 64-bit masks as a C array definition.
+//
+// Parameters:
+// const char *declaration - The declaration of the array.
+// const uint64_t *values - The values of the array.
+// uint32_t length - The number of values.
+//
+// Returns:
+// Nothing.
+static void print_masks( const char *declaration, const uint64_t *values, uint32_t length ) {
+	printf( "%s = { ", declaration );
+
+	for ( uint32_t i = 0; i < length; i++ ) {
+		printf( "0x%016" PRIX64 "%s", values[ i ], i + 1 < length ? ", " : " };\n\n" );
+	}
+}
+
+// Description:
+// Prints the Hamming(8, 4) tables: the code of each nibble, the syndrome tables used by the block functions, and the
+// status and corrected message of each code.
+//
+// Parameters:
+// HammingCode *code - The Hamming(8, 4) code.
+//
+// Returns:
+// Nothing.
+static void print_8_4_tables( HammingCode *code ) {
+	BitMatrix *ht = ham_code_h_transpose( code );
+	int32_t encode_lookup[ 16 ];
+	int32_t syndrome_lookup[ 16 ];
+	int32_t syndrome_data_flip[ 16 ] = { 0 };
+	int32_t syndrome_correctable[ 16 ] = { 0 };
+	int32_t syndrome_uncorrectable[ 16 ];
+	int32_t correctness[ 256 ];
+	int32_t decode_lookup[ 256 ];
+
+	for ( uint32_t i = 0; i < 16; i++ ) {
+		encode_lookup[ i ] = ham_code_lookup_encode( code, i );
+		syndrome_lookup[ i ] = 0;
+
+		// The syndrome is linear, so the lower nibble's share is the XOR of its bits' syndromes.
+		for ( uint32_t bit = 0; bit < 4; bit++ ) {
+			syndrome_lookup[ i ] ^= ( ( i >> bit ) & 1 ) ? bit_syndrome( ht, bit, 4 ) : 0;
+		}
+
+		syndrome_uncorrectable[ i ] = i == 0 ? 0 : 0xFF;
+	}
+
+	for ( uint32_t bit = 0; bit < 8; bit++ ) {
+		uint32_t syndrome = bit_syndrome( ht, bit, 4 );
+		syndrome_data_flip[ syndrome ] = bit < 4 ? 1 << bit : 0;
+		syndrome_correctable[ syndrome ] = 0xFF;
+		syndrome_uncorrectable[ syndrome ] = 0;
+	}
+
+	for ( uint32_t i = 0; i < 256; i++ ) {
+		uint8_t msg = 0;
+		correctness[ i ] = ham_code_lookup_decode( code, i, &msg );
+		decode_lookup[ i ] = msg;
+	}
+
+	print_table( "static const uint8_t encode_lookup[ 16 ]", encode_lookup, 16, TABLE_DECIMAL );
+	print_table( "static const uint8_t syndrome_lookup[ 16 ]", syndrome_lookup, 16, TABLE_DECIMAL );
+	print_table( "static const uint8_t syndrome_data_flip[ 16 ]", syndrome_data_flip, 16, TABLE_DECIMAL );
+	print_table( "static const uint8_t syndrome_correctable[ 16 ]", syndrome_correctable, 16, TABLE_MASK );
+	print_table( "static const uint8_t syndrome_uncorrectable[ 16 ]", syndrome_uncorrectable, 16, TABLE_MASK );
+	print_table( "static const int8_t correctness[ 256 ]", correctness, 256, TABLE_STATUS );
+	print_table( "static const uint8_t decode_lookup[ 256 ]", decode_lookup, 256, TABLE_DECIMAL );
+}
+
+// Description:
+// Prints the Hamming(72, 64) tables: the data bits checked by each check bit, the flipped bit of each syndrome, and
+// the gf2p8affineqb matrices of each data byte.
+//
+// Parameters:
+// HammingCode *code - The Hamming(72, 64) code.
+//
+// Returns:
+// Nothing.
+static void print_72_64_tables( HammingCode *code ) {
+	BitMatrix *g = ham_code_generator( code );
+	BitMatrix *ht = ham_code_h_transpose( code );
+	uint64_t check_masks[ 8 ] = { 0 };
+	uint64_t check_affine[ 8 ] = { 0 };
+	int32_t syndrome_bit[ 256 ];
+
+	for ( uint32_t check = 0; check < 8; check++ ) {
+		for ( uint32_t bit = 0; bit < 64; bit++ ) {
+			check_masks[ check ] |= ( uint64_t ) bm_get_bit( g, bit, 64 + check ) << bit;
+		}
+	}
+
+	// gf2p8affineqb computes bit i of each result byte as the parity of the byte ANDed with row 7 - i of the matrix.
+	for ( uint32_t byte = 0; byte < 8; byte++ ) {
+		for ( uint32_t check = 0; check < 8; check++ ) {
+			check_affine[ byte ] |= ( ( check_masks[ check ] >> ( 8 * byte ) ) & 0xFF ) << ( 8 * ( 7 - check ) );
+		}
+	}
+
+	for ( uint32_t syndrome = 0; syndrome < 256; syndrome++ ) {
+		syndrome_bit[ syndrome ] = syndrome == 0 ? HAM_OK : HAM_ERR;
+	}
+
+	for ( uint32_t bit = 0; bit < 72; bit++ ) {
+		syndrome_bit[ bit_syndrome( ht, bit, 8 ) ] = bit;
+	}
+
+	print_masks( "static const uint64_t check_masks_72_64[ 8 ]", check_masks, 8 );
+	print_table( "static const int8_t syndrome_bit_72_64[ 256 ]", syndrome_bit, 256, TABLE_STATUS );
+	print_masks( "static const uint64_t check_affine_72_64[ 8 ]", check_affine, 8 );
+}
+
+// Description:
+// The entry point of the program.
+//
+// Parameters:
+// int argc - The argument count.
+// char **argv - An array of argument strings.
+//
+// Returns:
+// int - The exit status of the program (0 = success, otherwise error).
+int main( int argc, char **argv ) {
+	int opt = 0;
+
+	while ( ( opt = getopt( argc, argv, OPTIONS ) ) != -1 ) { // Process each option specified.
+		switch ( opt ) {
+		case 'h': print_help( *argv ); return 0; // Help.
+		default: print_help( *argv ); return 1; // Invalid flag.
+		}
+	}
+
+	HammingCode *nibble_code = ham_code_create( 8, 4 );
+	HammingCode *word_code = ham_code_create( 72, 64 );
+
+	if ( !nibble_code || !word_code ) {
+		fprintf( stderr, "Error: failed to allocate memory.\n" );
+		ham_code_delete( &word_code );
+		ham_code_delete( &nibble_code );
+
+		return 1;
+	}
+
+	print_8_4_tables( nibble_code );
+	print_72_64_tables( word_code );
+	ham_code_delete( &word_code );
+	ham_code_delete( &nibble_code );
+
+	return 0;
+}